@@ -0,0 +1,836 @@
+/**
+ * @file art.c
+ * @brief realize adaptive radix tree's basic oprations.
+ * @author watertiger <darkwkt@gmail.com>
+ * @date 2026-10-19
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "art.h"
+
+#define INIT_SIZE 10
+
+#define ART_IS_LEAF(x) ( (uintptr_t)(x) & 1 )
+#define ART_LEAF(x) ( (art_leaf *)( (uintptr_t)(x) & ~(uintptr_t)1 ) )
+#define ART_TAG(l) ( (art_node *)( (uintptr_t)(l) | 1 ) )
+
+/**
+ * @brief art_byte - get the byte of key used at depth.
+ * @param key the key.
+ * @param key_len the key's length in bytes.
+ * @param depth the depth of tree, 0 for the most significant byte.
+ * @return the byte.
+ */
+static inline unsigned char
+art_byte( art_key key, int key_len, int depth )
+{
+	return (unsigned char)( key >> ( 8 * ( key_len - 1 - depth ) ) );
+}
+
+/**
+ * @brief art_alloc_node - allocate an empty inner node.
+ * @param type the node's type, ART_NODE4 ~ ART_NODE256.
+ * @return pointer to the node, NULL for no memory.
+ */
+static art_node *
+art_alloc_node( int type )
+{
+	art_node *n = NULL;
+
+	switch ( type ) {
+		case ART_NODE4:n = calloc( 1, sizeof(art_node4) );break;
+		case ART_NODE16:n = calloc( 1, sizeof(art_node16) );break;
+		case ART_NODE48:n = calloc( 1, sizeof(art_node48) );break;
+		case ART_NODE256:n = calloc( 1, sizeof(art_node256) );break;
+	}
+	if ( !n ) {
+		printf("No Memory!!\n");
+		return NULL;
+	}
+	n->type = type;
+
+	return n;
+}
+
+/**
+ * @brief art_copy_header - copy children count and prefix to a new node.
+ * @param dst pointer to the new node.
+ * @param src pointer to the old node.
+ * @return none.
+ */
+static void
+art_copy_header( art_node *dst, art_node *src )
+{
+	dst->num = src->num;
+	dst->prefix_len = src->prefix_len;
+	memcpy( dst->prefix, src->prefix, src->prefix_len );
+}
+
+/**
+ * @brief art_find_child - find the child slot of byte c.
+ * @param n pointer to the inner node.
+ * @param c the key byte.
+ * @return pointer to the child slot if found,
+ *	   NULL if not found.
+ *
+ * Node16 用SSE2一次比较16个关键字字节，取掩码中最低位得到下标。
+ */
+static art_node **
+art_find_child( art_node *n, unsigned char c )
+{
+	int i = 0;
+	art_node4 *p4 = NULL;
+	art_node16 *p16 = NULL;
+	art_node48 *p48 = NULL;
+	art_node256 *p256 = NULL;
+#ifdef __SSE2__
+	__m128i cmp;
+	unsigned int mask = 0;
+#endif
+
+	switch ( n->type ) {
+		case ART_NODE4:
+			p4 = (art_node4 *)n;
+			for ( i = 0; i < n->num; i++ )
+				if ( p4->keys[i] == c )
+					return &p4->child[i];
+			break;
+		case ART_NODE16:
+			p16 = (art_node16 *)n;
+#ifdef __SSE2__
+			cmp = _mm_cmpeq_epi8( _mm_set1_epi8( (char)c ),
+					      _mm_loadu_si128( (__m128i *)p16->keys ) );
+			mask = _mm_movemask_epi8( cmp ) & ( ( 1u << n->num ) - 1 );
+			if ( mask )
+				return &p16->child[__builtin_ctz( mask )];
+#else
+			for ( i = 0; i < n->num; i++ )
+				if ( p16->keys[i] == c )
+					return &p16->child[i];
+#endif
+			break;
+		case ART_NODE48:
+			p48 = (art_node48 *)n;
+			if ( p48->index[c] )
+				return &p48->child[p48->index[c] - 1];
+			break;
+		case ART_NODE256:
+			p256 = (art_node256 *)n;
+			if ( p256->child[c] )
+				return &p256->child[c];
+			break;
+	}
+
+	return NULL;
+}
+
+/**
+ * @brief art_add_child - add a child to inner node, grow the node if full.
+ * @param ref pointer to the slot which points to node n.
+ * @param n pointer to the inner node.
+ * @param c the key byte of child.
+ * @param child pointer to the child.
+ * @return 1 for succeed,
+ *	   0 for failure.
+ *
+ * Node4和Node16的关键字字节保持有序，便于有序遍历。
+ */
+static int
+art_add_child( art_node **ref, art_node *n, unsigned char c, art_node *child )
+{
+	int i = 0;
+	art_node4 *p4 = NULL;
+	art_node16 *p16 = NULL;
+	art_node48 *p48 = NULL;
+	art_node256 *p256 = NULL;
+	art_node *pn = NULL;
+
+	switch ( n->type ) {
+		case ART_NODE4:
+			p4 = (art_node4 *)n;
+			if ( n->num < 4 ) {
+				for ( i = 0; i < n->num && p4->keys[i] < c; i++ )
+					;
+				memmove( p4->keys + i + 1, p4->keys + i, n->num - i );
+				memmove( p4->child + i + 1, p4->child + i,
+					 ( n->num - i ) * sizeof(art_node *) );
+				p4->keys[i] = c;
+				p4->child[i] = child;
+				n->num++;
+				return 1;
+			}
+			pn = art_alloc_node( ART_NODE16 );
+			if ( !pn )
+				return 0;
+			art_copy_header( pn, n );
+			memcpy( ((art_node16 *)pn)->keys, p4->keys, 4 );
+			memcpy( ((art_node16 *)pn)->child, p4->child, 4 * sizeof(art_node *) );
+			break;
+		case ART_NODE16:
+			p16 = (art_node16 *)n;
+			if ( n->num < 16 ) {
+				for ( i = 0; i < n->num && p16->keys[i] < c; i++ )
+					;
+				memmove( p16->keys + i + 1, p16->keys + i, n->num - i );
+				memmove( p16->child + i + 1, p16->child + i,
+					 ( n->num - i ) * sizeof(art_node *) );
+				p16->keys[i] = c;
+				p16->child[i] = child;
+				n->num++;
+				return 1;
+			}
+			pn = art_alloc_node( ART_NODE48 );
+			if ( !pn )
+				return 0;
+			art_copy_header( pn, n );
+			for ( i = 0; i < 16; i++ ) {
+				((art_node48 *)pn)->index[p16->keys[i]] = i + 1;
+				((art_node48 *)pn)->child[i] = p16->child[i];
+			}
+			break;
+		case ART_NODE48:
+			p48 = (art_node48 *)n;
+			if ( n->num < 48 ) {
+				for ( i = 0; p48->child[i]; i++ )
+					;
+				p48->index[c] = i + 1;
+				p48->child[i] = child;
+				n->num++;
+				return 1;
+			}
+			pn = art_alloc_node( ART_NODE256 );
+			if ( !pn )
+				return 0;
+			art_copy_header( pn, n );
+			for ( i = 0; i < 256; i++ )
+				if ( p48->index[i] )
+					((art_node256 *)pn)->child[i] = p48->child[p48->index[i] - 1];
+			break;
+		case ART_NODE256:
+			p256 = (art_node256 *)n;
+			p256->child[c] = child;
+			n->num++;
+			return 1;
+	}
+	/* 节点已满，换成更大的节点后再插入 */
+	(*ref) = pn;
+	free( n );
+
+	return art_add_child( ref, pn, c, child );
+}
+
+/**
+ * @brief art_remove_child - remove a child from inner node, shrink the node if sparse.
+ * @param ref pointer to the slot which points to node n.
+ * @param n pointer to the inner node.
+ * @param c the key byte of child.
+ * @param slot pointer to the child slot returned by art_find_child.
+ * @return none.
+ *
+ * Node4只剩一个孩子时与孩子合并（路径压缩），其余节点孩子数较少时
+ * 换成较小的节点，阈值留有余量以免反复增长收缩。
+ */
+static void
+art_remove_child( art_node **ref, art_node *n, unsigned char c, art_node **slot )
+{
+	int i = 0;
+	int pos = 0;
+	art_node4 *p4 = NULL;
+	art_node16 *p16 = NULL;
+	art_node48 *p48 = NULL;
+	art_node256 *p256 = NULL;
+	art_node *pn = NULL;
+	art_node *pc = NULL;
+	unsigned char prefix[ART_MAX_PREFIX];
+	int len = 0;
+
+	switch ( n->type ) {
+		case ART_NODE4:
+			p4 = (art_node4 *)n;
+			pos = slot - p4->child;
+			memmove( p4->keys + pos, p4->keys + pos + 1, n->num - pos - 1 );
+			memmove( p4->child + pos, p4->child + pos + 1,
+				 ( n->num - pos - 1 ) * sizeof(art_node *) );
+			n->num--;
+			if ( 1 == n->num ) {
+				pc = p4->child[0];
+				if ( !ART_IS_LEAF( pc ) ) {
+					len = n->prefix_len;
+					memcpy( prefix, n->prefix, len );
+					prefix[len++] = p4->keys[0];
+					memcpy( prefix + len, pc->prefix, pc->prefix_len );
+					len += pc->prefix_len;
+					memcpy( pc->prefix, prefix, len );
+					pc->prefix_len = len;
+				}
+				(*ref) = pc;
+				free( n );
+			}
+			break;
+		case ART_NODE16:
+			p16 = (art_node16 *)n;
+			pos = slot - p16->child;
+			memmove( p16->keys + pos, p16->keys + pos + 1, n->num - pos - 1 );
+			memmove( p16->child + pos, p16->child + pos + 1,
+				 ( n->num - pos - 1 ) * sizeof(art_node *) );
+			n->num--;
+			if ( 3 == n->num ) {
+				pn = art_alloc_node( ART_NODE4 );
+				if ( !pn )
+					return;
+				art_copy_header( pn, n );
+				memcpy( ((art_node4 *)pn)->keys, p16->keys, 3 );
+				memcpy( ((art_node4 *)pn)->child, p16->child, 3 * sizeof(art_node *) );
+				(*ref) = pn;
+				free( n );
+			}
+			break;
+		case ART_NODE48:
+			p48 = (art_node48 *)n;
+			p48->child[p48->index[c] - 1] = NULL;
+			p48->index[c] = 0;
+			n->num--;
+			if ( 12 == n->num ) {
+				pn = art_alloc_node( ART_NODE16 );
+				if ( !pn )
+					return;
+				art_copy_header( pn, n );
+				for ( i = 0, pos = 0; i < 256; i++ ) {
+					if ( p48->index[i] ) {
+						((art_node16 *)pn)->keys[pos] = i;
+						((art_node16 *)pn)->child[pos++] = p48->child[p48->index[i] - 1];
+					}
+				}
+				(*ref) = pn;
+				free( n );
+			}
+			break;
+		case ART_NODE256:
+			p256 = (art_node256 *)n;
+			p256->child[c] = NULL;
+			n->num--;
+			if ( 37 == n->num ) {
+				pn = art_alloc_node( ART_NODE48 );
+				if ( !pn )
+					return;
+				art_copy_header( pn, n );
+				for ( i = 0, pos = 0; i < 256; i++ ) {
+					if ( p256->child[i] ) {
+						((art_node48 *)pn)->child[pos] = p256->child[i];
+						((art_node48 *)pn)->index[i] = ++pos;
+					}
+				}
+				(*ref) = pn;
+				free( n );
+			}
+			break;
+	}
+
+	return;
+}
+
+/**
+ * @brief art_init - initialize an empty adaptive radix tree.
+ * @param t pointer to the tree.
+ * @param key_len 4 for 32-bit keys, 8 for 64-bit keys.
+ * @return 1 for succeed,
+ *	   0 for failure.
+ */
+int
+art_init( part_tree t, int key_len )
+{
+	if ( 4 != key_len && 8 != key_len ) {
+		printf("Key length must be 4 or 8.\n");
+		return 0;
+	}
+	t->root = NULL;
+	t->key_len = key_len;
+	t->size = 0;
+
+	return 1;
+}
+
+/**
+ * @brief art_free_node - free a subtree recursively.
+ */
+static void
+art_free_node( art_node *n )
+{
+	int i = 0;
+
+	if ( !n )
+		return;
+	if ( ART_IS_LEAF( n ) ) {
+		free( ART_LEAF( n ) );
+		return;
+	}
+	switch ( n->type ) {
+		case ART_NODE4:
+			for ( i = 0; i < n->num; i++ )
+				art_free_node( ((art_node4 *)n)->child[i] );
+			break;
+		case ART_NODE16:
+			for ( i = 0; i < n->num; i++ )
+				art_free_node( ((art_node16 *)n)->child[i] );
+			break;
+		case ART_NODE48:
+			for ( i = 0; i < 48; i++ )
+				art_free_node( ((art_node48 *)n)->child[i] );
+			break;
+		case ART_NODE256:
+			for ( i = 0; i < 256; i++ )
+				art_free_node( ((art_node256 *)n)->child[i] );
+			break;
+	}
+	free( n );
+}
+
+/**
+ * @brief art_destroy - destroy adaptive radix tree, free it's space.
+ * @param t pointer to the tree.
+ * @return 0 for success.
+ */
+int
+art_destroy( part_tree t )
+{
+	art_free_node( t->root );
+	t->root = NULL;
+	t->size = 0;
+
+	return 0;
+}
+
+/**
+ * @brief art_search - searching key in adaptive radix tree.
+ * @param t pointer to the tree.
+ * @param key the key to search.
+ * @return pointer to the leaf if found,
+ *	   NULL pointer if key not found.
+ *
+ * 逐层比较压缩前缀，再用当前字节选择孩子，直到遇到叶子节点。
+ */
+art_leaf *
+art_search( part_tree t, art_key key )
+{
+	art_node *n = t->root;
+	art_node **pc = NULL;
+	int depth = 0;
+	int i = 0;
+
+	for ( ; n; ) {
+		if ( ART_IS_LEAF( n ) )
+			return ( ART_LEAF( n )->key == key ) ? ART_LEAF( n ) : NULL;
+		for ( i = 0; i < n->prefix_len; i++ )
+			if ( n->prefix[i] != art_byte( key, t->key_len, depth + i ) )
+				return NULL;
+		depth += n->prefix_len;
+		pc = art_find_child( n, art_byte( key, t->key_len, depth ) );
+		if ( !pc )
+			return NULL;
+		n = *pc;
+		depth++;
+	}
+
+	return NULL;
+}
+
+/**
+ * @brief art_get - get the value of key in adaptive radix tree.
+ * @param t pointer to the tree.
+ * @param key the key to search.
+ * @param value pointer to store the value found, may be NULL.
+ * @return 1 for found,
+ *	   0 for not found.
+ */
+int
+art_get( part_tree t, art_key key, art_value *value )
+{
+	art_leaf *l = art_search( t, key );
+
+	if ( !l )
+		return 0;
+	if ( value )
+		*value = l->value;
+
+	return 1;
+}
+
+/**
+ * @brief art_insert_rec - insert a leaf into subtree.
+ * @param t pointer to the tree.
+ * @param ref pointer to the slot of subtree.
+ * @param l pointer to the new leaf.
+ * @param depth the depth of subtree.
+ * @return 1 for new leaf inserted,
+ *	   0 for key already exists (value is updated) or failure.
+ */
+static int
+art_insert_rec( part_tree t, art_node **ref, art_leaf *l, int depth )
+{
+	art_node *n = *ref;
+	art_node *pn = NULL;
+	art_node **pc = NULL;
+	art_key okey = 0;
+	int i = 0;
+
+	if ( !n ) {
+		(*ref) = ART_TAG( l );
+		return 1;
+	}
+	if ( ART_IS_LEAF( n ) ) {
+		okey = ART_LEAF( n )->key;
+		if ( okey == l->key ) {
+			ART_LEAF( n )->value = l->value;
+			free( l );
+			return 0;
+		}
+		/* 两个叶子的公共字节作为新Node4的前缀 */
+		pn = art_alloc_node( ART_NODE4 );
+		if ( !pn ) {
+			free( l );
+			return 0;
+		}
+		for ( i = depth; art_byte( okey, t->key_len, i ) == art_byte( l->key, t->key_len, i ); i++ )
+			pn->prefix[i - depth] = art_byte( okey, t->key_len, i );
+		pn->prefix_len = i - depth;
+		art_add_child( &pn, pn, art_byte( okey, t->key_len, i ), n );
+		art_add_child( &pn, pn, art_byte( l->key, t->key_len, i ), ART_TAG( l ) );
+		(*ref) = pn;
+		return 1;
+	}
+	for ( i = 0; i < n->prefix_len; i++ )
+		if ( n->prefix[i] != art_byte( l->key, t->key_len, depth + i ) )
+			break;
+	if ( i < n->prefix_len ) {
+		/* 前缀不匹配，在分歧处分裂出新的Node4 */
+		pn = art_alloc_node( ART_NODE4 );
+		if ( !pn ) {
+			free( l );
+			return 0;
+		}
+		pn->prefix_len = i;
+		memcpy( pn->prefix, n->prefix, i );
+		art_add_child( &pn, pn, n->prefix[i], n );
+		art_add_child( &pn, pn, art_byte( l->key, t->key_len, depth + i ), ART_TAG( l ) );
+		n->prefix_len -= i + 1;
+		memmove( n->prefix, n->prefix + i + 1, n->prefix_len );
+		(*ref) = pn;
+		return 1;
+	}
+	depth += n->prefix_len;
+	pc = art_find_child( n, art_byte( l->key, t->key_len, depth ) );
+	if ( pc )
+		return art_insert_rec( t, pc, l, depth + 1 );
+	if ( !art_add_child( ref, n, art_byte( l->key, t->key_len, depth ), ART_TAG( l ) ) ) {
+		free( l );
+		return 0;
+	}
+
+	return 1;
+}
+
+/**
+ * @brief art_insert - insert a key/value pair into adaptive radix tree.
+ * @param t pointer to the tree.
+ * @param key the key to insert.
+ * @param value the value bound to key.
+ * @return 1 for new key inserted,
+ *	   0 for key already exists (value is updated) or failure.
+ */
+int
+art_insert( part_tree t, art_key key, art_value value )
+{
+	art_leaf *l = NULL;
+	int ret = 0;
+
+	if ( 4 == t->key_len && key > 0xffffffffULL ) {
+		printf("Key %llu out of 32-bit range.\n", key);
+		return 0;
+	}
+	l = ( art_leaf * )malloc( sizeof(art_leaf) );
+	if ( !l ) {
+		printf("No Memory!!\n");
+		return 0;
+	}
+	l->key = key;
+	l->value = value;
+	ret = art_insert_rec( t, &t->root, l, 0 );
+	t->size += ret;
+
+	return ret;
+}
+
+/**
+ * @brief art_delete_rec - delete key from subtree.
+ * @return 1 for succeed,
+ *	   0 for failure.
+ */
+static int
+art_delete_rec( part_tree t, art_node **ref, art_key key, int depth )
+{
+	art_node *n = *ref;
+	art_node **pc = NULL;
+	unsigned char c = 0;
+	int i = 0;
+
+	if ( !n )
+		return 0;
+	if ( ART_IS_LEAF( n ) ) {
+		if ( ART_LEAF( n )->key != key )
+			return 0;
+		free( ART_LEAF( n ) );
+		(*ref) = NULL;
+		return 1;
+	}
+	for ( i = 0; i < n->prefix_len; i++ )
+		if ( n->prefix[i] != art_byte( key, t->key_len, depth + i ) )
+			return 0;
+	depth += n->prefix_len;
+	c = art_byte( key, t->key_len, depth );
+	pc = art_find_child( n, c );
+	if ( !pc )
+		return 0;
+	if ( ART_IS_LEAF( *pc ) ) {
+		if ( ART_LEAF( *pc )->key != key )
+			return 0;
+		free( ART_LEAF( *pc ) );
+		art_remove_child( ref, n, c, pc );
+		return 1;
+	}
+
+	return art_delete_rec( t, pc, key, depth + 1 );
+}
+
+/**
+ * @brief art_delete - delete a key from adaptive radix tree.
+ * @param t pointer to the tree.
+ * @param key the key to delete.
+ * @return 1 for succeed,
+ *	   0 for failure.
+ */
+int
+art_delete( part_tree t, art_key key )
+{
+	int ret = art_delete_rec( t, &t->root, key, 0 );
+
+	t->size -= ret;
+
+	return ret;
+}
+
+/**
+ * @brief art_iter_rec - visit subtree in key order.
+ * @return 0 for finished, otherwise the value returned by callback.
+ */
+static int
+art_iter_rec( art_node *n, art_callback cb, void *ctx )
+{
+	int i = 0;
+	int ret = 0;
+	art_node48 *p48 = NULL;
+
+	if ( !n )
+		return 0;
+	if ( ART_IS_LEAF( n ) )
+		return cb( ctx, ART_LEAF( n )->key, ART_LEAF( n )->value );
+	switch ( n->type ) {
+		case ART_NODE4:
+			for ( i = 0; !ret && i < n->num; i++ )
+				ret = art_iter_rec( ((art_node4 *)n)->child[i], cb, ctx );
+			break;
+		case ART_NODE16:
+			for ( i = 0; !ret && i < n->num; i++ )
+				ret = art_iter_rec( ((art_node16 *)n)->child[i], cb, ctx );
+			break;
+		case ART_NODE48:
+			p48 = (art_node48 *)n;
+			for ( i = 0; !ret && i < 256; i++ )
+				if ( p48->index[i] )
+					ret = art_iter_rec( p48->child[p48->index[i] - 1], cb, ctx );
+			break;
+		case ART_NODE256:
+			for ( i = 0; !ret && i < 256; i++ )
+				ret = art_iter_rec( ((art_node256 *)n)->child[i], cb, ctx );
+			break;
+	}
+
+	return ret;
+}
+
+/**
+ * @brief art_iter - visit all keys of adaptive radix tree in ascending order.
+ * @param t pointer to the tree.
+ * @param cb the callback called for each key, returns non-zero to stop.
+ * @param ctx the context passed to callback.
+ * @return 0 for all keys visited, otherwise the value returned by callback.
+ */
+int
+art_iter( part_tree t, art_callback cb, void *ctx )
+{
+	return art_iter_rec( t->root, cb, ctx );
+}
+
+/**
+ * @brief art_depth_rec - the max number of inner nodes from subtree to a leaf.
+ */
+static int
+art_depth_rec( art_node *n )
+{
+	int i = 0;
+	int d = 0;
+	int max = 0;
+	art_node **child = NULL;
+	int count = 0;
+
+	if ( !n || ART_IS_LEAF( n ) )
+		return 0;
+	switch ( n->type ) {
+		case ART_NODE4:child = ((art_node4 *)n)->child;count = n->num;break;
+		case ART_NODE16:child = ((art_node16 *)n)->child;count = n->num;break;
+		case ART_NODE48:child = ((art_node48 *)n)->child;count = 48;break;
+		case ART_NODE256:child = ((art_node256 *)n)->child;count = 256;break;
+	}
+	for ( i = 0; i < count; i++ ) {
+		d = art_depth_rec( child[i] );
+		if ( d > max )
+			max = d;
+	}
+
+	return max + 1;
+}
+
+/**
+ * @brief art_depth - the max number of inner nodes on a path from root to leaf.
+ * @param t pointer to the tree.
+ * @return the depth, never more than the key length.
+ */
+int
+art_depth( part_tree t )
+{
+	return art_depth_rec( t->root );
+}
+
+/* 比较用的红黑树和平衡二叉树，与prbt、pbbst的算法相同但没有调试输出 */
+#define TREE_PREFIX cmp_rbt
+#define TREE_KEY_TYPE unsigned int
+#define TREE_ENGINE TREE_RBT
+#include "treetmpl.h"
+
+#define TREE_PREFIX cmp_avl
+#define TREE_KEY_TYPE unsigned int
+#define TREE_ENGINE TREE_AVL
+#include "treetmpl.h"
+
+#define BENCH_SIZE ( 1 << 20 )
+
+/**
+ * @brief bench_now - monotonic time in nanoseconds.
+ */
+static double
+bench_now( void )
+{
+	struct timespec ts;
+
+	clock_gettime( CLOCK_MONOTONIC, &ts );
+
+	return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+/**
+ * @brief art_show_key - callback used to show keys in order.
+ */
+static int
+art_show_key( void *ctx, art_key key, art_value value )
+{
+	(void)ctx;
+	printf("%llu(%lld) ", key, (long long)value);
+
+	return 0;
+}
+
+int
+main()
+{
+	int array[INIT_SIZE];
+	int i = 0;
+	int j = 0;
+	unsigned int *keys = NULL;
+	unsigned int tmp = 0;
+	long found = 0;
+	double t0 = 0;
+	art_tree tree;
+	art_tree tree64;
+	pcmp_rbt prbt_root = NULL;
+	pcmp_avl pavl_root = NULL;
+
+	srand( (unsigned int)time(NULL) );
+	art_init( &tree, 4 );
+	for ( i = 0; i < INIT_SIZE; i++ ) {
+		array[i] = rand() % 100;
+		printf("%-4d", array[i]);
+		art_insert( &tree, array[i], array[i] * 10 );
+	}
+	printf("\n");
+	art_iter( &tree, art_show_key, NULL );
+	printf("\n");
+	art_delete( &tree, array[5] );
+	printf("%d %s.\n", array[5], art_search( &tree, array[5] ) ? "found" : "not exists");
+	art_destroy( &tree );
+
+	art_init( &tree64, 8 );
+	art_insert( &tree64, 0x0102030405060708ULL, 1 );
+	art_insert( &tree64, 0x0102030405060709ULL, 2 );
+	art_insert( &tree64, 0xff02030405060708ULL, 3 );
+	art_iter( &tree64, art_show_key, NULL );
+	printf("\ndepth:%d\n", art_depth( &tree64 ) );
+	art_destroy( &tree64 );
+
+	/* 稠密整数关键字的查找性能比较 */
+	keys = ( unsigned int * )malloc( BENCH_SIZE * sizeof(unsigned int) );
+	if ( !keys ) {
+		printf("No Memory!!\n");
+		return 0;
+	}
+	for ( i = 0; i < BENCH_SIZE; i++ )
+		keys[i] = i;
+	for ( i = BENCH_SIZE - 1; i > 0; i-- ) {
+		j = rand() % ( i + 1 );
+		tmp = keys[i];
+		keys[i] = keys[j];
+		keys[j] = tmp;
+	}
+	art_init( &tree, 4 );
+	for ( i = 0; i < BENCH_SIZE; i++ ) {
+		art_insert( &tree, keys[i], i );
+		cmp_rbt_insert( &prbt_root, keys[i] );
+		cmp_avl_insert( &pavl_root, keys[i] );
+	}
+
+	t0 = bench_now();
+	for ( i = 0, found = 0; i < BENCH_SIZE; i++ )
+		found += ( NULL != art_search( &tree, keys[BENCH_SIZE - 1 - i] ) );
+	printf("art: %ld found, %.1f ns/search, depth %d\n",
+	       found, ( bench_now() - t0 ) / BENCH_SIZE, art_depth( &tree ) );
+	t0 = bench_now();
+	for ( i = 0, found = 0; i < BENCH_SIZE; i++ )
+		found += ( NULL != cmp_rbt_search( prbt_root, keys[BENCH_SIZE - 1 - i] ) );
+	printf("rbt: %ld found, %.1f ns/search\n", found, ( bench_now() - t0 ) / BENCH_SIZE );
+	t0 = bench_now();
+	for ( i = 0, found = 0; i < BENCH_SIZE; i++ )
+		found += ( NULL != cmp_avl_search( pavl_root, keys[BENCH_SIZE - 1 - i] ) );
+	printf("avl: %ld found, %.1f ns/search\n", found, ( bench_now() - t0 ) / BENCH_SIZE );
+
+	art_destroy( &tree );
+	cmp_rbt_destroy( &prbt_root );
+	cmp_avl_destroy( &pavl_root );
+	free( keys );
+
+	return 0;
+}
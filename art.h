@@ -0,0 +1,90 @@
+/**
+ * @file art.h
+ * @brief describe adaptive radix tree's defination and basic oprations.
+ * @author watertiger <darkwkt@gmail.com>
+ * @date 2026-10-19
+ */
+#include <stdio.h>
+#include <stdlib.h>
+
+/**
+ * @brief define the adaptive radix tree node and it's basic oprations
+ *
+ * 自适应基数树（Adaptive Radix Tree, ART）按关键字的字节逐层查找，
+ * 每层消耗关键字的一个字节，树高只与关键字长度有关：32位关键字最多4层，
+ * 64位关键字最多8层。
+ * 内部节点根据孩子个数自适应地选择4种结构：
+ *	Node4	最多4个孩子，关键字字节与孩子指针均为有序数组
+ *	Node16	最多16个孩子，用SIMD指令一次比较16个关键字字节
+ *	Node48	最多48个孩子，256项的字节索引指向48个孩子槽
+ *	Node256	最多256个孩子，直接以字节为下标
+ * 路径压缩：只有一个孩子的内部节点链被合并为节点的前缀(prefix)。
+ * 叶子节点保存完整关键字和值域，指针最低位置1以区分内部节点。
+ *
+ * 关键字按大端字节序比较，即按无符号整数的大小排列。
+ */
+#define ART_NODE4	1
+#define ART_NODE16	2
+#define ART_NODE48	3
+#define ART_NODE256	4
+
+#define ART_MAX_PREFIX	8
+
+#ifndef ART_VALUE_TYPE
+#define ART_VALUE_TYPE long long
+#endif
+
+typedef unsigned long long art_key;
+typedef ART_VALUE_TYPE art_value;
+
+typedef struct _art_node {
+	unsigned char type;
+	unsigned char prefix_len;	/* compressed path length */
+	unsigned short num;		/* number of children */
+	unsigned char prefix[ART_MAX_PREFIX];
+}art_node;
+
+typedef struct _art_node4 {
+	art_node n;
+	unsigned char keys[4];
+	art_node *child[4];
+}art_node4;
+
+typedef struct _art_node16 {
+	art_node n;
+	unsigned char keys[16];
+	art_node *child[16];
+}art_node16;
+
+typedef struct _art_node48 {
+	art_node n;
+	unsigned char index[256];	/* 0 for empty, otherwise slot + 1 */
+	art_node *child[48];
+}art_node48;
+
+typedef struct _art_node256 {
+	art_node n;
+	art_node *child[256];
+}art_node256;
+
+typedef struct _art_leaf {
+	art_key key;
+	art_value value;
+}art_leaf;
+
+typedef struct _art_tree {
+	art_node *root;
+	int key_len;	/* 4 for 32-bit keys, 8 for 64-bit keys */
+	long size;
+}art_tree, *part_tree;
+
+typedef int (*art_callback)( void *ctx, art_key key, art_value value );
+
+int art_init( part_tree t, int key_len );
+int art_destroy( part_tree t );
+art_leaf *art_search( part_tree t, art_key key );
+int art_get( part_tree t, art_key key, art_value *value );
+int art_insert( part_tree t, art_key key, art_value value );
+int art_delete( part_tree t, art_key key );
+int art_iter( part_tree t, art_callback cb, void *ctx );
+int art_depth( part_tree t );
@@ -7,11 +7,43 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
+#include <pthread.h>
 
 #include "balancebstree.h"
 
 #define INIT_SIZE 10
 
+ptree_arena bbst_arena = NULL;
+
+/**
+ * @brief bbst_alloc - allocate a node, from bbst_arena if it's set.
+ * @param size the size of node.
+ * @return pointer to the node,
+ *	   NULL pointer if no memory.
+ */
+static void *
+bbst_alloc( size_t size )
+{
+	if ( bbst_arena && size <= bbst_arena->size )
+		return tarena_alloc( bbst_arena );
+
+	return malloc( size );
+}
+
+/**
+ * @brief bbst_free - free a node to where it comes from.
+ * @param p pointer to the node.
+ */
+static void
+bbst_free( void *p )
+{
+	if ( bbst_arena && tarena_owns( bbst_arena, p ) )
+		tarena_free( bbst_arena, p );
+	else
+		free( p );
+}
+
 /**
  * @brief bbst_search1 - searching key in balance binary search tree.
  * @param proot pointer to the root of balance binary search tree.
@@ -70,6 +102,155 @@ bbst_search2( pbbst proot, int key, pbbst *p )
 		return bbst_search2( proot->rc, key, p );
 }
 
+/**
+ * @brief bbst_floor - find the largest node not greater than key.
+ * @param proot pointer to the root of balance binary search tree.
+ * @param key the enum to search.
+ * @return pbbst pointer to the node if found,
+ *	   NULL pointer if all nodes are greater than key.
+ *
+ * 一次非递归下降：当前节点不大于key时记为候选并向右，否则向左。
+ * bbst_ceil、bbst_predecessor、bbst_successor与此类似。
+ */
+pbbst
+bbst_floor( pbbst proot, int key )
+{
+	pbbst pc = NULL;
+
+	for ( ; proot; ) {
+		if ( proot->data <= key ) {
+			pc = proot;
+			proot = proot->rc;
+		} else {
+			proot = proot->lc;
+		}
+	}
+
+	return pc;
+}
+
+/**
+ * @brief bbst_ceil - find the smallest node not less than key.
+ * @param proot pointer to the root of balance binary search tree.
+ * @param key the enum to search.
+ * @return pbbst pointer to the node if found,
+ *	   NULL pointer if all nodes are less than key.
+ */
+pbbst
+bbst_ceil( pbbst proot, int key )
+{
+	pbbst pc = NULL;
+
+	for ( ; proot; ) {
+		if ( proot->data >= key ) {
+			pc = proot;
+			proot = proot->lc;
+		} else {
+			proot = proot->rc;
+		}
+	}
+
+	return pc;
+}
+
+/**
+ * @brief bbst_predecessor - find the largest node less than key.
+ * @param proot pointer to the root of balance binary search tree.
+ * @param key the enum to search, need not exist in the tree.
+ * @return pbbst pointer to the node if found,
+ *	   NULL pointer if no node is less than key.
+ */
+pbbst
+bbst_predecessor( pbbst proot, int key )
+{
+	pbbst pc = NULL;
+
+	for ( ; proot; ) {
+		if ( proot->data < key ) {
+			pc = proot;
+			proot = proot->rc;
+		} else {
+			proot = proot->lc;
+		}
+	}
+
+	return pc;
+}
+
+/**
+ * @brief bbst_successor - find the smallest node greater than key.
+ * @param proot pointer to the root of balance binary search tree.
+ * @param key the enum to search, need not exist in the tree.
+ * @return pbbst pointer to the node if found,
+ *	   NULL pointer if no node is greater than key.
+ */
+pbbst
+bbst_successor( pbbst proot, int key )
+{
+	pbbst pc = NULL;
+
+	for ( ; proot; ) {
+		if ( proot->data > key ) {
+			pc = proot;
+			proot = proot->lc;
+		} else {
+			proot = proot->rc;
+		}
+	}
+
+	return pc;
+}
+
+/**
+ * @brief bbst_nearest - find the k keys nearest to key.
+ * @param proot pointer to the root of balance binary search tree.
+ * @param key the enum to search, need not exist in the tree.
+ * @param k count of keys wanted.
+ * @param keys array of at least k elements, to store keys found, 
+ *	  ordered by distance to key, smaller key first when equal.
+ * @return count of keys stored, less than k if the tree is small.
+ *
+ * 与bst_nearest相同，用左右两个栈分别产生前驱和后继序列，每次取距离
+ * 较近的一边。平衡二叉树的深度不超过1.44log(n)，栈的大小固定为
+ * BBST_MAX_DEPTH。总代价为一次下降加上O(k)。
+ */
+int
+bbst_nearest( pbbst proot, int key, int k, int *keys )
+{
+	pbbst ls[BBST_MAX_DEPTH];
+	pbbst rs[BBST_MAX_DEPTH];
+	pbbst pn = NULL;
+	int lt = 0;
+	int rt = 0;
+	int n = 0;
+
+	for ( pn = proot; pn; ) {
+		if ( pn->data <= key ) {
+			ls[lt++] = pn;
+			pn = pn->rc;
+		} else {
+			rs[rt++] = pn;
+			pn = pn->lc;
+		}
+	}
+	for ( ; n < k && ( lt || rt ); n++ ) {
+		if ( lt && ( !rt || 
+		     (long long)key - ls[lt - 1]->data <= (long long)rs[rt - 1]->data - key ) ) {
+			pn = ls[--lt];
+			keys[n] = pn->data;
+			for ( pn = pn->lc; pn; pn = pn->rc )
+				ls[lt++] = pn;
+		} else {
+			pn = rs[--rt];
+			keys[n] = pn->data;
+			for ( pn = pn->rc; pn; pn = pn->lc )
+				rs[rt++] = pn;
+		}
+	}
+
+	return n;
+}
+
 /**
  * @brief r_rotate - rotate the binary sort tree to the right.
  * @param p pointer to the pointer to the root of balance binary search subtree.
@@ -202,13 +383,14 @@ bbst_insert( pbbst *proot, int e, int *tf )
 	pbbst pe = NULL;
 
 	if ( !(*proot) ) {
-		(*proot) = ( pbbst )malloc( sizeof(bbst_node) );
+		(*proot) = ( pbbst )bbst_alloc( sizeof(bbst_node) );
 		if ( !(*proot) ) {
 			printf("No Memory.\n");
 			return 0;
 		}
 		(*proot)->data = e;
 		(*proot)->bf = EH;
+		(*proot)->dead = 0;
 		(*proot)->lc = NULL;
 		(*proot)->rc = NULL;
 		(*tf) = 1;
@@ -282,47 +464,48 @@ bbst_delete( pbbst *proot, int key, int *sf )
 		return 0;
 	} else {
 		if ( key == (*proot)->data ) {/*被删除节点存在，处理删除操作*/
-			if ( !(*proot)->lc ) {
-				if ( !(*proot)->rc ) { /* 叶子节点 */
-					free(*proot);
-					(*proot) = NULL;
-					*sf = 1;
-				} else { /* 仅存在右子树 */
-					pfind = *proot;
-					*proot = (*proot)->rc;
-					free( pfind );
-					*sf = 1;
-				}	
-			} else {
-				if ( !(*proot)->rc ) { /* 仅存在左子树 */
-					pfind = *proot;
-					*proot = (*proot)->rc;
-					free( pfind );
-					*sf = 1;
-				} else { /* 存在左右子树 */
-					switch ( (*proot)->bf ) {
-						case LH:case EH:
-							pfind = (*proot)->lc;
-							for ( ;pfind->rc; ) {
-								pfind = pfind->rc;
+			if ( !(*proot)->lc || !(*proot)->rc ) { /* 叶子节点或仅有一棵子树 */
+				pfind = *proot;
+				*proot = (*proot)->lc ? (*proot)->lc : (*proot)->rc;
+				bbst_free( pfind );
+				*sf = 1;
+			} else { /* 存在左右子树 */
+				switch ( (*proot)->bf ) {
+					case LH:case EH:
+						pfind = (*proot)->lc;
+						for ( ;pfind->rc; ) {
+							pfind = pfind->rc;
+						}
+						tmpdata = pfind->data;
+						pfind->data = (*proot)->data;
+						(*proot)->data = tmpdata;
+						/* 不能直接释放空间，需要回溯调整树的平衡 */
+						bbst_delete( &(*proot)->lc, key, sf );
+						if ( *sf ) {
+							switch ( (*proot)->bf ) {
+								case LH:(*proot)->bf = EH;
+									*sf = 1;
+									break;
+								case EH:(*proot)->bf = RH;
+									*sf = 0;
+									break;
 							}
-							tmpdata = pfind->data;
-							pfind->data = (*proot)->data;
-							(*proot)->data = tmpdata;
-							/* 不能直接释放空间，需要回溯调整树的平衡 */
-							bbst_delete( &(*proot)->lc, key, sf );
-							break;
-						case RH:
-							pfind = (*proot)->rc;
-							for ( ;pfind->lc; ) 
-								pfind = pfind->lc;
-							tmpdata = pfind->data;
-							pfind->data = (*proot)->data;
-							(*proot)->data = tmpdata;
-							bbst_delete( &(*proot)->rc, key, sf );
-							break;
-					}
-				}	
+						}
+						break;
+					case RH:
+						pfind = (*proot)->rc;
+						for ( ;pfind->lc; ) 
+							pfind = pfind->lc;
+						tmpdata = pfind->data;
+						pfind->data = (*proot)->data;
+						(*proot)->data = tmpdata;
+						bbst_delete( &(*proot)->rc, key, sf );
+						if ( *sf ) {
+							(*proot)->bf = EH;
+							*sf = 1;
+						}
+						break;
+				}
 			}
 		} else if ( key < (*proot)->data ) {
 			if (!bbst_delete( &(*proot)->lc, key, sf) )
@@ -335,8 +518,9 @@ bbst_delete( pbbst *proot, int key, int *sf )
 					case EH:(*proot)->bf = RH;
 						*sf = 0;
 						break;
-					case RH:right_balance( proot );
-						*sf = 0;
+					/* 兄弟子树平衡时旋转后高度不变 */
+					case RH:*sf = ( EH != (*proot)->rc->bf );
+						right_balance( proot );
 						break;
 				}
 			}
@@ -345,8 +529,8 @@ bbst_delete( pbbst *proot, int key, int *sf )
 				return 0;
 			if ( *sf ) {
 				switch ( (*proot)->bf ) {
-					case LH:left_balance( proot );
-						*sf = 0;
+					case LH:*sf = ( EH != (*proot)->lc->bf );
+						left_balance( proot );
 						break;
 					case EH:(*proot)->bf = LH;
 						*sf = 0;
@@ -362,34 +546,1059 @@ bbst_delete( pbbst *proot, int key, int *sf )
 	return 1;
 }
 
+/**
+ * @brief bbst_dump_lc - access functions used by treedump.h.
+ */
+static void *
+bbst_dump_lc( void *n )
+{
+	return ( ( pbbst )n )->lc;
+}
+
+static void *
+bbst_dump_rc( void *n )
+{
+	return ( ( pbbst )n )->rc;
+}
+
+static long long
+bbst_dump_key( void *n )
+{
+	return ( ( pbbst )n )->data;
+}
+
+static int
+bbst_dump_attr( void *n )
+{
+	return ( ( pbbst )n )->bf;
+}
+
+static const tree_dump_ops bbst_dump_ops = {
+	bbst_dump_lc, bbst_dump_rc, bbst_dump_key, bbst_dump_attr, TDUMP_ATTR_BF, sizeof(int)
+};
+
+/**
+ * @brief bbst_dump - dump balance binary search tree without recursion.
+ * @param proot pointer to the root of balance binary search tree.
+ * @param d pointer to the writer initialized by tdump_init.
+ * @return 1 for succeed,
+ *	   0 for failure.
+ */
+int
+bbst_dump( pbbst proot, ptree_dump d )
+{
+	return tdump_tree( d, proot, NULL, &bbst_dump_ops );
+}
+
 /**
  * @brief bbst_show - how all node's information of balance binary search tree.
  * @param proot pointer to the node of balance binary search tree.
  * @param parent pointer to the parent node of node which pointer proot point to
  * @return none.
+ *
+ * 通过treedump.h以文本格式写到标准输出，不再递归调用printf。
  */
 void
 bbst_show( pbbst proot, pbbst parent )
 {
-	if ( proot ) {
-		printf("Current:%-4d(%+2d). ", proot->data, proot->bf);
-		if ( proot->lc )
-			printf("LC:%-4d", proot->lc->data);
-		else
-			printf("LC:$   ");
-		if ( proot->rc )
-			printf("RC:%-4d", proot->rc->data);
-		else
-			printf("RC:$   ");
-		if ( parent )
-			printf("P:%-4d\n", parent->data);
+	char buf[8192];
+	tree_dump d;
+
+	fflush( stdout );
+	tdump_init( &d, STDOUT_FILENO, buf, sizeof(buf), TDUMP_TEXT );
+	tdump_tree( &d, proot, parent, &bbst_dump_ops );
+
+	return;
+}
+
+/**
+ * @brief bbst_destroy - destroy balance binary search tree, free it's space.
+ * @param proot pointer to the pointer to the root of balance binary search tree.
+ * @return 0 for success.
+ *
+ * 仅依赖孩子指针，同样适用于键值平衡二叉排序树。
+ */
+int
+bbst_destroy( pbbst *proot )
+{
+	if ( *proot ) {
+		bbst_destroy( &(*proot)->lc );
+		bbst_destroy( &(*proot)->rc );
+		bbst_free( *proot );
+		(*proot) = NULL;
+	}
+
+	return 0;
+}
+
+/**
+ * @brief bbst_kv_init - initialize an empty key/value balance binary search tree.
+ * @param t pointer to the key/value tree.
+ * @return 1 for succeed.
+ */
+int
+bbst_kv_init( pbbst_kv_tree t )
+{
+	t->root = NULL;
+
+	return 1;
+}
+
+/**
+ * @brief bbst_kv_search1 - searching key in key/value balance binary search tree.
+ * @param t pointer to the key/value tree.
+ * @param key the key to search.
+ * @return pbbst_kv pointer to the node if found,
+ *	   NULL pointer if key not found.
+ */
+pbbst_kv
+bbst_kv_search1( pbbst_kv_tree t, bbst_key key )
+{
+	pbbst pn = t->root;
+
+	for ( ; pn && key != BBST_KV(pn)->key; )
+		pn = ( key < BBST_KV(pn)->key ) ? pn->lc : pn->rc;
+
+	return BBST_KV(pn);
+}
+
+/**
+ * @brief bbst_kv_get - get the value of key in key/value balance binary search tree.
+ * @param t pointer to the key/value tree.
+ * @param key the key to search.
+ * @param value pointer to store the value found, may be NULL.
+ * @return 1 for found,
+ *	   0 for not found.
+ */
+int
+bbst_kv_get( pbbst_kv_tree t, bbst_key key, bbst_value *value )
+{
+	pbbst_kv p = bbst_kv_search1( t, key );
+
+	if ( !p )
+		return 0;
+	if ( value )
+		*value = p->value;
+
+	return 1;
+}
+
+/**
+ * @brief bbst_kv_insert_node - insert a key/value pair under *proot.
+ * @param proot pointer to the pointer to the root of key/value subtree.
+ * @param key the key to insert.
+ * @param value the value bound to key.
+ * @param tf flag to record whether tree is growing taller.
+ * @return 1 for new node inserted,
+ *	   0 for key already exists (value is updated) or failure.
+ *
+ * 与bbst_insert相同，仅比较的是64位关键字。
+ */
+static int
+bbst_kv_insert_node( pbbst *proot, bbst_key key, bbst_value value, int *tf )
+{
+	pbbst_kv pe = NULL;
+
+	if ( !(*proot) ) {
+		pe = ( pbbst_kv )bbst_alloc( sizeof(bbst_kv_node) );
+		if ( !pe ) {
+			printf("No Memory.\n");
+			return 0;
+		}
+		pe->node.data = 0;
+		pe->node.bf = EH;
+		pe->node.dead = 0;
+		pe->node.lc = NULL;
+		pe->node.rc = NULL;
+		pe->key = key;
+		pe->value = value;
+		(*proot) = &pe->node;
+		(*tf) = 1;
+	} else {
+		if ( key == BBST_KV(*proot)->key ) {
+			BBST_KV(*proot)->value = value;
+			*tf = 0;
+			return 0;/*存在，更新值域*/
+		} else if ( key < BBST_KV(*proot)->key ) {
+			if ( !bbst_kv_insert_node( &(*proot)->lc, key, value, tf ) )
+				return 0;
+			if ( *tf ) {
+				switch ( (*proot)->bf ) {
+					case LH:left_balance( proot );
+						*tf = 0;
+						break;
+					case EH:(*proot)->bf = LH;
+						*tf = 1;
+						break;
+					case RH:(*proot)->bf = EH;
+						*tf = 0;
+						break;
+				}
+			}
+		} else {
+			if ( !bbst_kv_insert_node( &(*proot)->rc, key, value, tf ) )
+				return 0;
+			if ( *tf ) {
+				switch ( (*proot)->bf ) {
+					case LH:(*proot)->bf = EH;
+						*tf = 0;
+						break;
+					case EH:(*proot)->bf = RH;
+						*tf = 1;
+						break;
+					case RH:right_balance( proot );
+						*tf = 0;
+						break;
+				}
+			}
+		}
+	}
+
+	return 1;
+}
+
+/**
+ * @brief bbst_kv_delete_node - delete a key under *proot.
+ * @param proot pointer to the pointer to the root of key/value subtree.
+ * @param key the key to delete.
+ * @param sf the shorter flag to record the tree's height changing.
+ * @return 1 for succeed,
+ *	   0 for failure.
+ *
+ * 与bbst_delete相同，左右子树均存在时交换关键字和值域后在子树中删除。
+ */
+static int
+bbst_kv_delete_node( pbbst *proot, bbst_key key, int *sf )
+{
+	pbbst pfind = NULL;
+	bbst_kv_node tmp;
+
+	if ( !(*proot) )
+		return 0;
+	if ( key == BBST_KV(*proot)->key ) {
+		if ( !(*proot)->lc || !(*proot)->rc ) { /* 叶子节点或仅有一棵子树 */
+			pfind = *proot;
+			*proot = (*proot)->lc ? (*proot)->lc : (*proot)->rc;
+			bbst_free( pfind );
+			*sf = 1;
+		} else { /* 存在左右子树 */
+			if ( RH == (*proot)->bf ) {
+				for ( pfind = (*proot)->rc; pfind->lc; )
+					pfind = pfind->lc;
+			} else {
+				for ( pfind = (*proot)->lc; pfind->rc; )
+					pfind = pfind->rc;
+			}
+			tmp.key = BBST_KV(pfind)->key;
+			tmp.value = BBST_KV(pfind)->value;
+			BBST_KV(pfind)->key = BBST_KV(*proot)->key;
+			BBST_KV(pfind)->value = BBST_KV(*proot)->value;
+			BBST_KV(*proot)->key = tmp.key;
+			BBST_KV(*proot)->value = tmp.value;
+			if ( RH == (*proot)->bf ) {
+				bbst_kv_delete_node( &(*proot)->rc, key, sf );
+				if ( *sf ) {
+					(*proot)->bf = EH;
+					*sf = 1;
+				}
+			} else {
+				bbst_kv_delete_node( &(*proot)->lc, key, sf );
+				if ( *sf ) {
+					switch ( (*proot)->bf ) {
+						case LH:(*proot)->bf = EH;
+							*sf = 1;
+							break;
+						case EH:(*proot)->bf = RH;
+							*sf = 0;
+							break;
+					}
+				}
+			}
+		}
+	} else if ( key < BBST_KV(*proot)->key ) {
+		if ( !bbst_kv_delete_node( &(*proot)->lc, key, sf ) )
+			return 0;
+		if ( *sf ) {
+			switch ( (*proot)->bf ) {
+				case LH:(*proot)->bf = EH;
+					*sf = 1;
+					break;
+				case EH:(*proot)->bf = RH;
+					*sf = 0;
+					break;
+				case RH:*sf = ( EH != (*proot)->rc->bf );
+					right_balance( proot );
+					break;
+			}
+		}
+	} else {
+		if ( !bbst_kv_delete_node( &(*proot)->rc, key, sf ) )
+			return 0;
+		if ( *sf ) {
+			switch ( (*proot)->bf ) {
+				case LH:*sf = ( EH != (*proot)->lc->bf );
+					left_balance( proot );
+					break;
+				case EH:(*proot)->bf = LH;
+					*sf = 0;
+					break;
+				case RH:(*proot)->bf = EH;
+					*sf = 1;
+					break;
+			}
+		}
+	}
+
+	return 1;
+}
+
+/**
+ * @brief bbst_kv_insert - insert a key/value pair into balance binary search tree.
+ * @param t pointer to the key/value tree.
+ * @param key the key to insert.
+ * @param value the value bound to key.
+ * @return 1 for new node inserted,
+ *	   0 for key already exists (value is updated) or failure.
+ */
+int
+bbst_kv_insert( pbbst_kv_tree t, bbst_key key, bbst_value value )
+{
+	int tf = 0;
+
+	return bbst_kv_insert_node( &t->root, key, value, &tf );
+}
+
+/**
+ * @brief bbst_kv_delete - delete a key in key/value balance binary search tree.
+ * @param t pointer to the key/value tree.
+ * @param key the key to delete.
+ * @return 1 for succeed,
+ *	   0 for failure.
+ */
+int
+bbst_kv_delete( pbbst_kv_tree t, bbst_key key )
+{
+	int sf = 0;
+
+	return bbst_kv_delete_node( &t->root, key, &sf );
+}
+
+/**
+ * @brief bbst_kv_destroy - destroy key/value balance binary search tree.
+ * @param t pointer to the key/value tree.
+ * @return 0 for success.
+ */
+int
+bbst_kv_destroy( pbbst_kv_tree t )
+{
+	return bbst_destroy( &t->root );
+}
+
+/**
+ * @brief bbst_lazy_init - initialize the lazy deletion balance binary search tree.
+ * @param t pointer to the lazy deletion tree.
+ * @param ratio percent of tombstones which triggers compaction, 
+ *	  0 for BBST_LAZY_RATIO.
+ * @return 1 for succeed,
+ *	   0 for failure.
+ */
+int
+bbst_lazy_init( pbbst_lazy t, int ratio )
+{
+	if ( ratio < 0 || ratio > 100 )
+		return 0;
+	t->root = NULL;
+	t->size = 0;
+	t->dead = 0;
+	t->ratio = ratio ? ratio : BBST_LAZY_RATIO;
+
+	return 1;
+}
+
+/**
+ * @brief bbst_lazy_search - searching key, skip the tombstones.
+ * @param t pointer to the lazy deletion tree.
+ * @param key the enum to search.
+ * @return pbbst pointer to the node if found,
+ *	   NULL pointer if key not found or deleted.
+ *
+ * 非递归查找，找到被标记的节点与未找到相同。
+ */
+pbbst
+bbst_lazy_search( pbbst_lazy t, int key )
+{
+	pbbst pn = t->root;
+
+	for ( ; pn && key != pn->data; )
+		pn = ( key < pn->data ) ? pn->lc : pn->rc;
+
+	return ( pn && !pn->dead ) ? pn : NULL;
+}
+
+/**
+ * @brief bbst_lazy_insert - insert an enum into lazy deletion tree.
+ * @param t pointer to the lazy deletion tree.
+ * @param e the enum to insert.
+ * @return 1 for succeed,
+ *	   0 for failure.
+ *
+ * 关键字存在但被标记时清除标记即可，不需要分配节点和平衡调整。
+ */
+int
+bbst_lazy_insert( pbbst_lazy t, int e )
+{
+	pbbst pn = t->root;
+	int tf = 0;
+
+	for ( ; pn && e != pn->data; )
+		pn = ( e < pn->data ) ? pn->lc : pn->rc;
+	if ( pn ) {
+		if ( !pn->dead )
+			return 0;
+		pn->dead = 0;
+		t->dead--;
+		return 1;
+	}
+	if ( !bbst_insert( &t->root, e, &tf ) )
+		return 0;
+	t->size++;
+
+	return 1;
+}
+
+/**
+ * @brief bbst_lazy_delete - mark an enum as deleted.
+ * @param t pointer to the lazy deletion tree.
+ * @param key the enum to delete.
+ * @return 1 for succeed,
+ *	   0 for failure.
+ *
+ * 墓碑比例超过阈值时调用bbst_compact压缩。
+ */
+int
+bbst_lazy_delete( pbbst_lazy t, int key )
+{
+	pbbst pn = bbst_lazy_search( t, key );
+
+	if ( !pn )
+		return 0;
+	pn->dead = 1;
+	t->dead++;
+	if ( t->dead * 100 > t->size * t->ratio ) {
+		t->size = bbst_compact( &t->root );
+		t->dead = 0;
+	}
+
+	return 1;
+}
+
+/**
+ * @brief bbst_build_vine - rebuild balanced tree from the sorted vine.
+ * @param head pointer to the pointer to the head of vine, linked by rc.
+ * @param n count of nodes to take from the vine.
+ * @param h pointer to store the height of subtree built.
+ * @return pbbst pointer to the root of subtree built.
+ *
+ * 左子树取(n-1)/2个节点，右子树取其余的，右子树不矮于左子树，
+ * 两者高度之差即平衡因子，只可能为EH或RH。递归深度为O(log n)。
+ */
+static pbbst
+bbst_build_vine( pbbst *head, long n, int *h )
+{
+	pbbst pn = NULL;
+	pbbst plc = NULL;
+	int lh = 0;
+	int rh = 0;
+
+	if ( n <= 0 ) {
+		*h = 0;
+		return NULL;
+	}
+	plc = bbst_build_vine( head, ( n - 1 ) / 2, &lh );
+	pn = *head;
+	*head = pn->rc;
+	pn->lc = plc;
+	pn->rc = bbst_build_vine( head, n - 1 - ( n - 1 ) / 2, &rh );
+	pn->bf = lh - rh;
+	*h = ( lh > rh ? lh : rh ) + 1;
+
+	return pn;
+}
+
+/**
+ * @brief bbst_vine - flatten tree into the sorted vine without recursion.
+ * @param pn pointer to the root of balance binary search tree.
+ * @param n pointer to store the count of nodes in the vine.
+ * @return pbbst pointer to the head of vine, linked by rc.
+ *
+ * 与bst_destroy相同：有左孩子时右旋，没有左孩子时当前节点即为中序的
+ * 下一个，墓碑节点直接释放，其余节点通过rc链接成链表。
+ */
+static pbbst
+bbst_vine( pbbst pn, long *n )
+{
+	pbbst ptmp = NULL;
+	pbbst head = NULL;
+	pbbst *tail = &head;
+
+	*n = 0;
+	for ( ; pn; ) {
+		if ( pn->lc ) {
+			ptmp = pn->lc;
+			pn->lc = ptmp->rc;
+			ptmp->rc = pn;
+			pn = ptmp;
+		} else {
+			ptmp = pn->rc;
+			if ( pn->dead ) {
+				bbst_free( pn );
+			} else {
+				*tail = pn;
+				tail = &pn->rc;
+				(*n)++;
+			}
+			pn = ptmp;
+		}
+	}
+	*tail = NULL;
+
+	return head;
+}
+
+/**
+ * @brief bbst_compact - free the tombstones and rebuild the tree in O(n).
+ * @param proot pointer to the pointer to the root of balance binary search tree.
+ * @return the count of nodes left.
+ *
+ * bbst_vine拉直后由bbst_build_vine按中序重建，全程不分配内存，
+ * 不使用辅助数组。
+ */
+long
+bbst_compact( pbbst *proot )
+{
+	pbbst head = NULL;
+	long n = 0;
+	int h = 0;
+
+	head = bbst_vine( *proot, &n );
+	(*proot) = bbst_build_vine( &head, n, &h );
+
+	return n;
+}
+
+/**
+ * @brief bbst_merge - merge two balance binary search trees in O(n+m).
+ * @param proot pointer to the pointer to the root of tree to merge into.
+ * @param pother pointer to the pointer to the root of tree to merge from,
+ *	  it's NULL after merging.
+ * @return the count of nodes in the merged tree.
+ *
+ * 两棵树分别拉直成有序链表，像归并排序一样合并两个链表，关键字相同时
+ * 保留proot中的节点并释放另一个，最后从合并后的链表重建平衡树。
+ * 复用原有节点，不分配内存。逐个插入需要O(m log(n+m))。
+ */
+long
+bbst_merge( pbbst *proot, pbbst *pother )
+{
+	pbbst pa = NULL;
+	pbbst pb = NULL;
+	pbbst ptmp = NULL;
+	pbbst head = NULL;
+	pbbst *tail = &head;
+	long na = 0;
+	long nb = 0;
+	long n = 0;
+	int h = 0;
+
+	pa = bbst_vine( *proot, &na );
+	pb = bbst_vine( *pother, &nb );
+	for ( ; pa && pb; n++ ) {
+		if ( pb->data < pa->data ) {
+			*tail = pb;
+			pb = pb->rc;
+			nb--;
+		} else {
+			if ( pb->data == pa->data ) {
+				ptmp = pb;
+				pb = pb->rc;
+				nb--;
+				bbst_free( ptmp );
+			}
+			*tail = pa;
+			pa = pa->rc;
+			na--;
+		}
+		tail = &(*tail)->rc;
+	}
+	*tail = pa ? pa : pb;
+	n += na + nb;
+	(*proot) = bbst_build_vine( &head, n, &h );
+	(*pother) = NULL;
+
+	return n;
+}
+
+/**
+ * @brief bbst_height - height of subtree by following the taller child.
+ */
+static int
+bbst_height( pbbst pn )
+{
+	int h = 0;
+
+	for ( ; pn; h++ )
+		pn = ( RH == pn->bf ) ? pn->rc : pn->lc;
+
+	return h;
+}
+
+/**
+ * @brief bbst_join - join two trees and a middle node into one AVL tree.
+ * @param pl the left tree, all keys less than pk.
+ * @param pk the middle node.
+ * @param pr the right tree, all keys greater than pk.
+ * @param hl height of the left tree.
+ * @param hr height of the right tree.
+ * @param h pointer to store the height of the tree joined.
+ * @return pbbst pointer to the root of the tree joined.
+ *
+ * 两棵树高度相差不超过1时pk直接作为根。否则（设左树较高）沿左树的
+ * 右链下降到高度不超过hr+1的子树c，以pk为根接上c和右树，代替c的位置，
+ * 这个位置的高度加1，再像插入一样向上修改平衡因子并在需要时旋转。
+ * 代价为O(|hl-hr|)。
+ */
+static pbbst
+bbst_join( pbbst pl, pbbst pk, pbbst pr, int hl, int hr, int *h )
+{
+	pbbst *link[BBST_MAX_DEPTH];
+	pbbst *pp = NULL;
+	pbbst root = NULL;
+	int top = 0;
+	int hc = 0;
+	int tf = 1;
+
+	if ( hl - hr <= 1 && hr - hl <= 1 ) {
+		pk->lc = pl;
+		pk->rc = pr;
+		pk->bf = hl - hr;
+		*h = ( hl > hr ? hl : hr ) + 1;
+		return pk;
+	}
+	if ( hl > hr ) {
+		root = pl;
+		for ( pp = &root, hc = hl; hc > hr + 1; pp = &(*pp)->rc ) {
+			link[top++] = pp;
+			hc -= ( LH == (*pp)->bf ) ? 2 : 1;
+		}
+		pk->lc = *pp;
+		pk->rc = pr;
+		pk->bf = hc - hr;
+		(*pp) = pk;
+		/* 右子树长高，LH变为EH，EH变为RH，RH需要旋转 */
+		for ( ; top && tf; ) {
+			pp = link[--top];
+			switch ( (*pp)->bf ) {
+				case LH:(*pp)->bf = EH;
+					tf = 0;
+					break;
+				case EH:(*pp)->bf = RH;
+					break;
+				case RH:tf = ( EH == (*pp)->rc->bf );
+					right_balance( pp );
+					break;
+			}
+		}
+		*h = hl + tf;
+	} else {
+		root = pr;
+		for ( pp = &root, hc = hr; hc > hl + 1; pp = &(*pp)->lc ) {
+			link[top++] = pp;
+			hc -= ( RH == (*pp)->bf ) ? 2 : 1;
+		}
+		pk->lc = pl;
+		pk->rc = *pp;
+		pk->bf = hl - hc;
+		(*pp) = pk;
+		for ( ; top && tf; ) {
+			pp = link[--top];
+			switch ( (*pp)->bf ) {
+				case RH:(*pp)->bf = EH;
+					tf = 0;
+					break;
+				case EH:(*pp)->bf = LH;
+					break;
+				case LH:tf = ( EH == (*pp)->lc->bf );
+					left_balance( pp );
+					break;
+			}
+		}
+		*h = hr + tf;
+	}
+
+	return root;
+}
+
+/**
+ * @brief define the shared state of bbst_insert_batch.
+ *
+ * 树上面depth层的节点为枢轴，其下的子树（包括空子树）为槽，
+ * 槽j中的关键字都在piv[j-1]与piv[j]之间，各槽互不相交。
+ */
+typedef struct _bbst_batch {
+	pbbst piv[BBST_BATCH_THREADS];
+	pbbst sub[BBST_BATCH_THREADS + 1];
+	long start[BBST_BATCH_THREADS + 2];	/* 槽的关键字在keys中的范围 */
+	long added[BBST_BATCH_THREADS + 1];
+	int npiv;
+	int threads;
+	int *keys;
+	int *tmp;
+}bbst_batch;
+
+typedef struct _bbst_batch_arg {
+	bbst_batch *bb;
+	int id;
+}bbst_batch_arg;
+
+/**
+ * @brief bbst_batch_split - take the top levels as pivots, the rest as slots.
+ */
+static void
+bbst_batch_split( bbst_batch *bb, pbbst pn, int depth, int maxdepth )
+{
+	if ( !pn || depth == maxdepth ) {
+		bb->sub[bb->npiv] = pn;
+		return;
+	}
+	bbst_batch_split( bb, pn->lc, depth + 1, maxdepth );
+	bb->piv[bb->npiv++] = pn;
+	bbst_batch_split( bb, pn->rc, depth + 1, maxdepth );
+}
+
+/**
+ * @brief bbst_batch_slot - find the slot of key, -1 if key is a pivot.
+ */
+static int
+bbst_batch_slot( const bbst_batch *bb, int key )
+{
+	int lo = 0;
+	int hi = bb->npiv;
+	int mid = 0;
+
+	for ( ; lo < hi; ) {
+		mid = ( lo + hi ) / 2;
+		if ( key == bb->piv[mid]->data )
+			return -1;
+		if ( key < bb->piv[mid]->data )
+			hi = mid;
 		else
-			printf("P:$   \n");
-		bbst_show( proot->lc, proot );
-		bbst_show( proot->rc, proot );
+			lo = mid + 1;
 	}
 
-	return;
+	return lo;
+}
+
+/**
+ * @brief bbst_radix_sort - sort keys by 4 passes of 8 bits, result in a.
+ */
+static void
+bbst_radix_sort( int *a, int *tmp, long n )
+{
+	long cnt[256];
+	long sum = 0;
+	long c = 0;
+	long i = 0;
+	int shift = 0;
+	int *src = a;
+	int *dst = tmp;
+	int *t = NULL;
+
+	for ( shift = 0; shift < 32; shift += 8 ) {
+		memset( cnt, 0, sizeof(cnt) );
+		for ( i = 0; i < n; i++ )
+			cnt[( ( (unsigned int)src[i] ^ 0x80000000U ) >> shift ) & 0xff]++;
+		for ( i = 0, sum = 0; i < 256; i++ ) {
+			c = cnt[i];
+			cnt[i] = sum;
+			sum += c;
+		}
+		for ( i = 0; i < n; i++ )
+			dst[cnt[( ( (unsigned int)src[i] ^ 0x80000000U ) >> shift ) & 0xff]++] = src[i];
+		t = src;
+		src = dst;
+		dst = t;
+	}
+}
+
+/**
+ * @brief bbst_batch_worker - sort and insert the keys of slots id, id+threads, ...
+ *
+ * 有序插入时相邻关键字的查找路径大部分重合，缓存命中率高。
+ */
+static void *
+bbst_batch_worker( void *arg )
+{
+	bbst_batch_arg *pa = ( bbst_batch_arg * )arg;
+	bbst_batch *bb = pa->bb;
+	long lo = 0;
+	long hi = 0;
+	long i = 0;
+	int j = 0;
+	int tf = 0;
+
+	for ( j = pa->id; j <= bb->npiv; j += bb->threads ) {
+		lo = bb->start[j];
+		hi = bb->start[j + 1];
+		bbst_radix_sort( bb->keys + lo, bb->tmp + lo, hi - lo );
+		for ( i = lo; i < hi; i++ ) {
+			if ( i > lo && bb->keys[i] == bb->keys[i - 1] )
+				continue;
+			bb->added[j] += bbst_insert( &bb->sub[j], bb->keys[i], &tf );
+		}
+	}
+
+	return NULL;
+}
+
+/**
+ * @brief bbst_batch_join - join slots lo..hi and the pivots between them.
+ * @param h pointer to store the height of the tree joined.
+ *
+ * 取中间的枢轴，两边递归地接好后用bbst_join接上，递归深度为O(log threads)。
+ */
+static pbbst
+bbst_batch_join( bbst_batch *bb, int lo, int hi, int *h )
+{
+	pbbst pl = NULL;
+	pbbst pr = NULL;
+	int mid = lo + ( hi - lo ) / 2;
+	int hl = 0;
+	int hr = 0;
+
+	if ( lo == hi ) {
+		*h = bbst_height( bb->sub[lo] );
+		return bb->sub[lo];
+	}
+	pl = bbst_batch_join( bb, lo, mid, &hl );
+	pr = bbst_batch_join( bb, mid + 1, hi, &hr );
+
+	return bbst_join( pl, bb->piv[mid], pr, hl, hr, h );
+}
+
+/**
+ * @brief bbst_insert_batch - insert many keys with several threads.
+ * @param proot pointer to the pointer to the root of balance binary search tree.
+ * @param keys the keys to insert, unsorted and may have duplicates.
+ * @param n count of keys.
+ * @param threads count of threads to use, at most BBST_BATCH_THREADS.
+ * @return count of keys inserted, not counting those already in the tree.
+ *
+ * 1.取树的上面ceil(log2(threads))层节点作为枢轴（最多threads-1个），
+ *   按枢轴把关键字分到各槽，等于枢轴的关键字已经存在，直接丢弃。
+ * 2.各线程对自己的槽排序、去重，用bbst_insert插入槽中的子树，
+ *   子树互不相交，不需要加锁。
+ * 3.各子树的高度可能变化很大，上面几层不能只改平衡因子，用bbst_join
+ *   从枢轴和子树重新接成AVL树。
+ */
+long
+bbst_insert_batch( pbbst *proot, const int *keys, long n, int threads )
+{
+	bbst_batch *bb = NULL;
+	pthread_t tid[BBST_BATCH_THREADS];
+	bbst_batch_arg args[BBST_BATCH_THREADS];
+	int created[BBST_BATCH_THREADS];
+	long *pos = NULL;
+	long added = 0;
+	long i = 0;
+	int depth = 0;
+	int h = 0;
+	int j = 0;
+
+	if ( n <= 0 )
+		return 0;
+	bb = ( bbst_batch * )calloc( 1, sizeof(bbst_batch) );
+	if ( bb ) {
+		bb->keys = ( int * )malloc( n * sizeof(int) );
+		bb->tmp = ( int * )malloc( n * sizeof(int) );
+	}
+	if ( !bb || !bb->keys || !bb->tmp ) {
+		printf("No Memory.\n");
+		if ( bb ) {
+			free( bb->keys );
+			free( bb->tmp );
+		}
+		free( bb );
+		return 0;
+	}
+	/* 内存池不加锁；关键字太少时多线程得不偿失 */
+	threads = threads < BBST_BATCH_THREADS ? threads : BBST_BATCH_THREADS;
+	threads = threads < n / 4096 + 1 ? threads : (int)( n / 4096 + 1 );
+	bb->threads = ( threads > 0 && !bbst_arena ) ? threads : 1;
+	for ( depth = 0; ( 1 << depth ) < bb->threads; )
+		depth++;
+	bbst_batch_split( bb, *proot, 0, depth );
+
+	/* 按槽分配，pos借用added暂存写入位置 */
+	pos = bb->added;
+	for ( i = 0; i < n; i++ ) {
+		j = bbst_batch_slot( bb, keys[i] );
+		if ( j >= 0 )
+			bb->start[j + 1]++;
+	}
+	for ( j = 0; j <= bb->npiv; j++ ) {
+		bb->start[j + 1] += bb->start[j];
+		pos[j] = bb->start[j];
+	}
+	for ( i = 0; i < n; i++ ) {
+		j = bbst_batch_slot( bb, keys[i] );
+		if ( j >= 0 )
+			bb->keys[pos[j]++] = keys[i];
+	}
+	memset( bb->added, 0, sizeof(bb->added) );
+
+	for ( j = 0; j < bb->threads; j++ ) {
+		args[j].bb = bb;
+		args[j].id = j;
+		created[j] = j && !pthread_create( &tid[j], NULL, bbst_batch_worker, &args[j] );
+	}
+	for ( j = 0; j < bb->threads; j++ ) {
+		if ( !created[j] )
+			bbst_batch_worker( &args[j] );
+	}
+	for ( j = 1; j < bb->threads; j++ ) {
+		if ( created[j] )
+			pthread_join( tid[j], NULL );
+	}
+
+	(*proot) = bbst_batch_join( bb, 0, bb->npiv, &h );
+	for ( j = 0; j <= bb->npiv; j++ )
+		added += bb->added[j];
+	free( bb->keys );
+	free( bb->tmp );
+	free( bb );
+
+	return added;
+}
+
+/**
+ * @brief bbst_lazy_destroy - destroy the lazy deletion tree.
+ * @param t pointer to the lazy deletion tree.
+ * @return 0 for success.
+ */
+int
+bbst_lazy_destroy( pbbst_lazy t )
+{
+	bbst_destroy( &t->root );
+	t->size = 0;
+	t->dead = 0;
+
+	return 0;
+}
+
+/* 以下为演示和性能测试，作为库与其他模块一起编译时定义BBST_NO_MAIN去掉 */
+#ifndef BBST_NO_MAIN
+
+#define BURST_KEYS	( 1 << 20 )
+
+/**
+ * @brief burst_bench - delete half of the keys in a burst, eager and lazy.
+ */
+static void
+burst_bench( void )
+{
+	int *keys = ( int * )malloc( BURST_KEYS * sizeof(int) );
+	pbbst proot = NULL;
+	bbst_lazy lt;
+	struct timespec t0;
+	struct timespec t1;
+	double eager = 0;
+	double lazy = 0;
+	int tf = 0;
+	int i = 0;
+	int j = 0;
+	int tmp = 0;
+
+	if ( !keys ) {
+		printf("No Memory.\n");
+		return;
+	}
+	bbst_lazy_init( &lt, 0 );
+	for ( i = 0; i < BURST_KEYS; i++ )
+		keys[i] = i;
+	for ( i = BURST_KEYS - 1; i > 0; i-- ) {
+		j = rand() % ( i + 1 );
+		tmp = keys[i];
+		keys[i] = keys[j];
+		keys[j] = tmp;
+	}
+	for ( i = 0; i < BURST_KEYS; i++ ) {
+		bbst_insert( &proot, keys[i], &tf );
+		bbst_lazy_insert( &lt, keys[i] );
+	}
+	clock_gettime( CLOCK_MONOTONIC, &t0 );
+	for ( i = 0; i < BURST_KEYS / 2; i++ )
+		bbst_delete( &proot, keys[i], &tf );
+	clock_gettime( CLOCK_MONOTONIC, &t1 );
+	eager = ( t1.tv_sec - t0.tv_sec ) + ( t1.tv_nsec - t0.tv_nsec ) / 1e9;
+	clock_gettime( CLOCK_MONOTONIC, &t0 );
+	for ( i = 0; i < BURST_KEYS / 2; i++ )
+		bbst_lazy_delete( &lt, keys[i] );
+	clock_gettime( CLOCK_MONOTONIC, &t1 );
+	lazy = ( t1.tv_sec - t0.tv_sec ) + ( t1.tv_nsec - t0.tv_nsec ) / 1e9;
+	printf("burst delete %d keys: eager %.1f ns/op, lazy %.1f ns/op, %ld nodes left.\n",
+		BURST_KEYS / 2, eager * 1e9 / ( BURST_KEYS / 2 ), lazy * 1e9 / ( BURST_KEYS / 2 ), lt.size);
+	bbst_lazy_destroy( &lt );
+	bbst_destroy( &proot );
+	free( keys );
+}
+
+#define BATCH_KEYS	( 1 << 20 )
+
+/**
+ * @brief batch_bench - insert a batch into a tree, one by one and by bbst_insert_batch.
+ */
+static void
+batch_bench( void )
+{
+	int *keys = ( int * )malloc( 2 * BATCH_KEYS * sizeof(int) );
+	pbbst proot = NULL;
+	struct timespec t0;
+	struct timespec t1;
+	double sec = 0;
+	long n = 0;
+	int tf = 0;
+	int i = 0;
+	int t = 0;
+
+	if ( !keys ) {
+		printf("No Memory.\n");
+		return;
+	}
+	for ( i = 0; i < 2 * BATCH_KEYS; i++ )
+		keys[i] = rand();
+	/* 前一半建树，后一半作为批量插入的关键字 */
+	for ( t = 0; t <= 4; t = t ? t * 2 : 1 ) {
+		for ( i = 0; i < BATCH_KEYS; i++ )
+			bbst_insert( &proot, keys[i], &tf );
+		n = 0;
+		clock_gettime( CLOCK_MONOTONIC, &t0 );
+		if ( t ) {
+			n = bbst_insert_batch( &proot, keys + BATCH_KEYS, BATCH_KEYS, t );
+		} else {
+			for ( i = 0; i < BATCH_KEYS; i++ )
+				n += bbst_insert( &proot, keys[BATCH_KEYS + i], &tf );
+		}
+		clock_gettime( CLOCK_MONOTONIC, &t1 );
+		sec = ( t1.tv_sec - t0.tv_sec ) + ( t1.tv_nsec - t0.tv_nsec ) / 1e9;
+		if ( t )
+			printf("batch of %d keys, bbst_insert_batch %d: %.1f ms, %ld inserted.\n",
+				BATCH_KEYS, t, sec * 1e3, n);
+		else
+			printf("batch of %d keys, bbst_insert:       %.1f ms, %ld inserted.\n",
+				BATCH_KEYS, sec * 1e3, n);
+		bbst_destroy( &proot );
+	}
+	free( keys );
 }
 
 int
@@ -401,6 +1610,12 @@ main()
 	int shorter_flag = 0;
 	pbbst proot = NULL; /* 此处一定要显式置NULL，否则调用会出错，因为是根 */
 	pbbst pfind = NULL;
+	pbbst pother = NULL;
+	bbst_kv_tree kv;
+	bbst_value value = 0;
+	bbst_lazy lt;
+	int nearest[5];
+	int n = 0;
 
 	srand( (unsigned int)time(NULL) );
 	for ( i = 0; i < INIT_SIZE; i++ ) {
@@ -429,6 +1644,61 @@ main()
 	bbst_delete( &proot, array[5], &shorter_flag );
 	bbst_show( proot, NULL );	
 
+	/* 键值平衡二叉搜索树 */
+	bbst_kv_init( &kv );
+	for ( i = 0; i < INIT_SIZE; i++ ) {
+		bbst_kv_insert( &kv, (bbst_key)array[i] << 32, array[i] * 10 );
+	}
+	if ( bbst_kv_get( &kv, (bbst_key)array[5] << 32, &value ) )
+		printf("Key found. value is %lld.\n", (long long)value);
+	bbst_kv_delete( &kv, (bbst_key)array[5] << 32 );
+	if ( !bbst_kv_get( &kv, (bbst_key)array[5] << 32, &value ) )
+		printf("Key not exists.\n");
+	bbst_kv_destroy( &kv );
+	bbst_destroy( &proot );
+
+	/* 延迟删除 */
+	bbst_lazy_init( &lt, 0 );
+	for ( i = 0; i < INIT_SIZE; i++ )
+		bbst_lazy_insert( &lt, array[i] );
+	for ( i = 0; i < INIT_SIZE / 2; i++ )
+		bbst_lazy_delete( &lt, array[i] );
+	if ( !bbst_lazy_search( &lt, array[0] ) )
+		printf("Node %d deleted, %ld nodes, %ld tombstones.\n", array[0], lt.size, lt.dead);
+	bbst_show( lt.root, NULL );
+	bbst_lazy_destroy( &lt );
+	burst_bench();
+
+	/* 合并两棵树 */
+	for ( i = 0; i < INIT_SIZE; i++ ) {
+		bbst_insert( &proot, array[i], &taller_flag );
+		bbst_insert( &pother, array[i] + 50, &taller_flag );
+	}
+	printf("%ld nodes after merging.\n", bbst_merge( &proot, &pother ));
+	bbst_show( proot, NULL );
+
+	/* 邻近查询 */
+	pfind = bbst_ceil( proot, 60 );
+	if ( pfind )
+		printf("ceil(60) = %d.\n", pfind->data);
+	pfind = bbst_predecessor( proot, 60 );
+	if ( pfind )
+		printf("predecessor(60) = %d.\n", pfind->data);
+	n = bbst_nearest( proot, 60, 5, nearest );
+	printf("5 keys nearest to 60:");
+	for ( i = 0; i < n; i++ )
+		printf(" %d", nearest[i]);
+	printf("\n");
+
+	/* 批量插入 */
+	for ( i = 0; i < INIT_SIZE; i++ )
+		array[i] += 100;
+	printf("%ld keys inserted by batch.\n", bbst_insert_batch( &proot, array, INIT_SIZE, 2 ));
+	bbst_show( proot, NULL );
+	bbst_destroy( &proot );
+	batch_bench();
 
 	return 0;
 }
+
+#endif
@@ -7,6 +7,9 @@
 #include <stdio.h>
 #include <stdlib.h>
 
+#include "treedump.h"
+#include "treealloc.h"
+
 /**
  * @brief define the balanced binary search tree node and it's basic oprations
  *
@@ -24,9 +27,12 @@
 #define EH  0
 #define RH -1
 
+#define BBST_MAX_DEPTH	64	/* 平衡二叉树深度的上界 */
+
 typedef struct _balance_binary_search_tree {
 	int data;
-	int bf;
+	signed int bf : 2;	/* 只取LH、EH、RH */
+	unsigned int dead : 1;	/* 墓碑标记，只由bbst_lazy_*使用，占用bf剩余的位，节点不变大 */
 	struct _balance_binary_search_tree *lc, *rc;/* left and right child pointer */
 }bbst_node, *pbbst;
 
@@ -34,6 +40,95 @@ pbbst bbst_search1( pbbst proot, int key );
 int bbst_search2( pbbst proot, int key, pbbst *p );
 int bbst_insert( pbbst *proot, int e, int *tf );
 int bbst_delete( pbbst *proot, int key, int *sf );
+pbbst bbst_floor( pbbst proot, int key );
+pbbst bbst_ceil( pbbst proot, int key );
+pbbst bbst_predecessor( pbbst proot, int key );
+pbbst bbst_successor( pbbst proot, int key );
+int bbst_nearest( pbbst proot, int key, int k, int *keys );
 int bbst_destroy( pbbst *proot );
 void bbst_show( pbbst proot, pbbst parent );
+int bbst_dump( pbbst proot, ptree_dump d );
+
+/* 不为NULL时节点从该内存池分配（见treealloc.h），一棵树的节点全部释放
+ * 之前不能更换 */
+extern ptree_arena bbst_arena;
+long bbst_merge( pbbst *proot, pbbst *pother );
+
+/**
+ * 批量插入：按树上面几层的节点（枢轴）把关键字分到互不相交的子树中，
+ * 各子树由不同的线程排序、去重后插入，最后用AVL的join操作重新接上
+ * 上面几层。bbst_arena不为NULL时内存池不能并发使用，只用一个线程。
+ * 编译时需要 -pthread。
+ */
+#define BBST_BATCH_THREADS	64	/* 最多使用的线程数 */
+
+long bbst_insert_batch( pbbst *proot, const int *keys, long n, int threads );
+
+
+/**
+ * @brief define the key/value balanced binary search tree node.
+ *
+ * 带有64位关键字和值域的平衡二叉排序树节点。bbst_node作为第一个成员，
+ * 旋转及left_balance/right_balance等平衡处理直接复用，孩子指针仍为
+ * pbbst类型，通过BBST_KV宏取得所在的键值节点。
+ * 键值树的树根包装为bbst_kv_tree，与整数关键字的pbbst类型不同，两种树
+ * 混用（节点大小不同）时编译器报错。
+ * node.data在键值节点中不使用，这是复用平衡处理的代价；它与bf、dead
+ * 共占指针之前的8字节，去掉后也只是对齐填充，bbst_kv_node仍为40字节。
+ * 值域类型默认为 long long，可以在包含本头文件之前定义 BBST_VALUE_TYPE
+ * 为任意定长类型（包括结构体）。
+ */
+#ifndef BBST_VALUE_TYPE
+#define BBST_VALUE_TYPE long long
+#endif
+
+typedef long long bbst_key;
+typedef BBST_VALUE_TYPE bbst_value;
+
+typedef struct _balance_binary_search_tree_kv {
+	bbst_node node;	/* must be the first member */
+	bbst_key key;
+	bbst_value value;
+}bbst_kv_node, *pbbst_kv;
+
+#define BBST_KV(p) ((pbbst_kv)(p))
+
+typedef struct _balance_binary_search_tree_kv_tree {
+	pbbst root;	/* 所有节点都是bbst_kv_node */
+}bbst_kv_tree, *pbbst_kv_tree;
+
+int bbst_kv_init( pbbst_kv_tree t );
+pbbst_kv bbst_kv_search1( pbbst_kv_tree t, bbst_key key );
+int bbst_kv_get( pbbst_kv_tree t, bbst_key key, bbst_value *value );
+int bbst_kv_insert( pbbst_kv_tree t, bbst_key key, bbst_value value );
+int bbst_kv_delete( pbbst_kv_tree t, bbst_key key );
+int bbst_kv_destroy( pbbst_kv_tree t );
+
+/**
+ * @brief define the balanced binary search tree with lazy deletion.
+ *
+ * 延迟删除（墓碑）模式的平衡二叉树：
+ *	删除只把节点标记为dead，不做旋转；查找跳过被标记的节点；插入一个
+ *	已被标记的关键字时直接清除标记。
+ *	墓碑数占节点总数的比例超过ratio（百分比）时做一次压缩：非递归地
+ *	把树拉直成按中序链接的链表，同时释放墓碑节点，再从链表以O(n)时间
+ *	重建完全平衡的树。大批量删除的代价由逐个删除时的回溯平衡调整变为
+ *	标记加上均摊O(1)的压缩。
+ *
+ * 树中的节点必须只通过bbst_lazy_*修改，否则size与dead计数不再准确。
+ */
+#define BBST_LAZY_RATIO	25
+
+typedef struct _balance_binary_search_tree_lazy {
+	pbbst root;
+	long size;	/* 树中节点个数，含墓碑 */
+	long dead;	/* 墓碑个数 */
+	int ratio;	/* 压缩阈值，百分比 */
+}bbst_lazy, *pbbst_lazy;
 
+int bbst_lazy_init( pbbst_lazy t, int ratio );
+pbbst bbst_lazy_search( pbbst_lazy t, int key );
+int bbst_lazy_insert( pbbst_lazy t, int e );
+int bbst_lazy_delete( pbbst_lazy t, int key );
+long bbst_compact( pbbst *proot );
+int bbst_lazy_destroy( pbbst_lazy t );
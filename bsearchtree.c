@@ -7,11 +7,50 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
 
 #include "bsearchtree.h"
 
 #define INIT_SIZE 10
 
+ptree_arena bst_arena = NULL;
+
+/**
+ * @brief bst_alloc - allocate a node, from bst_arena if it's set.
+ * @param size the size of node.
+ * @return pointer to the node,
+ *	   NULL pointer if no memory.
+ */
+static void *
+bst_alloc( size_t size )
+{
+	if ( bst_arena && size <= bst_arena->size )
+		return tarena_alloc( bst_arena );
+
+	return malloc( size );
+}
+
+/**
+ * @brief bst_free - free a node to where it comes from.
+ * @param p pointer to the node.
+ */
+static void
+bst_free( void *p )
+{
+	if ( bst_arena && tarena_owns( bst_arena, p ) )
+		tarena_free( bst_arena, p );
+	else
+		free( p );
+}
+
+int bst_hit_sample = 0;
+static unsigned int bst_hit_count = 0;
+int bst_rebalance_factor = 3;
+
+static void bst_rebalance_path( pbst *proot, int key, int depth );
+
 /**
  * @brief bst_search1 - searching key in binary search tree.
  * @param proot pointer to the root of binary search tree.
@@ -25,16 +64,21 @@
  *	 3.若x小于b的根节点的数据域之值，则搜索左子树；否则：
  *	 4.查找右子树。 
  *
+ * bst_hit_sample不为0时，每bst_hit_sample次查找成功给找到的节点计数
+ * 一次，供bst_rebuild_weighted使用；其余查找只多一次计数器递增。
  */
 pbst
 bst_search1( pbst proot, int key )
 {
-	if ( !proot || ( key == proot->data) )
-		return proot;
-	if ( key < proot->data )
-		return bst_search1( proot->lc, key );
-	else 
-		return bst_search1( proot->rc, key );
+	for ( ; proot && key != proot->data; )
+		proot = ( key < proot->data ) ? proot->lc : proot->rc;
+	if ( proot && bst_hit_sample && ++bst_hit_count >= (unsigned int)bst_hit_sample ) {
+		bst_hit_count = 0;
+		if ( proot->hits < BST_HITS_MAX )
+			proot->hits++;
+	}
+
+	return proot;
 }
 
 /**
@@ -54,20 +98,19 @@ bst_search1( pbst proot, int key )
  *	 2.若x等于b的根节点的数据域之值，则查找成功；否则：
  *	 3.若x小于b的根节点的数据域之值，则搜索左子树；否则：
  *	 4.查找右子树。 
+ * 不使用递归，退化成链表的树也不会栈溢出。
  */
 int
 bst_search2( pbst proot, int key, pbst *p )
 {
-	if ( !proot ) 
-		return 0;
+	for ( ; proot; ) {
+		*p = proot;
+		if ( key == proot->data )
+			return 1;
+		proot = ( key < proot->data ) ? proot->lc : proot->rc;
+	}
 
-	*p = proot;
-	if ( key == proot->data )
-		return 1;
-	if ( key < proot-> data )
-		return bst_search2( proot->lc, key, p );
-	else 
-		return bst_search2( proot->rc, key, p );
+	return 0;
 }
 
 /**
@@ -81,34 +124,36 @@ bst_search2( pbst proot, int key, pbst *p )
  * 判断被插结点是其父亲结点的左、右儿子。将被插结点作为叶子结点插入。
  * 若二叉树为空。则首先单独生成根结点。
  * 注意：新插入的结点总是叶子结点。
+ *
+ * bst_rebalance_factor不为0且新节点的深度超过BST_REBALANCE_DEPTH时，
+ * 检查新节点的祖先，重建其中过深的子树，见bst_rebalance_path。
  */
 int
 bst_insert( pbst *proot, int e )
 {
-	pbst p = NULL;
+	pbst *pl = proot;
 	pbst pe = NULL;
+	int depth = 0;
 
-	if ( bst_search2( *proot, e, &p ) ) {
-		return 0;
-	} else {
-		pe = ( pbst )malloc( sizeof( bst_node ) );
-		if ( !pe ) {
-			printf("No Memory!!\n");
+	for ( ; *pl; depth++ ) {
+		if ( e == (*pl)->data )
 			return 0;
-		}
-		pe->data = e;
-		pe->lc = NULL;
-		pe->rc = NULL;
-		
-		if ( !p )
-			(*proot) = pe;
-		else if ( e < p->data )
-			p->lc = pe;
-		else
-			p->rc = pe;
-
-		return 1;
+		pl = ( e < (*pl)->data ) ? &(*pl)->lc : &(*pl)->rc;
 	}
+	pe = ( pbst )bst_alloc( sizeof( bst_node ) );
+	if ( !pe ) {
+		printf("No Memory!!\n");
+		return 0;
+	}
+	pe->data = e;
+	pe->hits = 0;
+	pe->lc = NULL;
+	pe->rc = NULL;
+	(*pl) = pe;
+	if ( bst_rebalance_factor && depth > BST_REBALANCE_DEPTH )
+		bst_rebalance_path( proot, e, depth );
+
+	return 1;
 }
 
 /**
@@ -134,19 +179,16 @@ int delete_node( pbst *p )
 	pbst s = NULL;
 
 	if ( !(*p)->rc ) {
-		printf("rc null.\n");
 		q = *p;
 		(*p) = (*p)->lc;
 		if ( q )
-			free( q );
+			bst_free( q );
 	} else if ( !(*p)->lc ) {
-		printf("lc null.\n");
 		q = *p;
 		(*p) = (*p)->rc;
 		if ( q )
-			free( q );
+			bst_free( q );
 	} else {
-		printf("lc and rc exist.\n");
 		q = *p;
 		s = (*p)->lc;
 		for ( ; s->rc ; ) {
@@ -154,11 +196,12 @@ int delete_node( pbst *p )
 			s = s->rc;
 		}
 		(*p)->data = s->data;
+		(*p)->hits = s->hits;	/* 访问计数随关键字一起移动 */
 		if ( q != (*p) )
 			q->rc = s->lc;
 		else
 			q->lc = s->lc;
-		free( s );
+		bst_free( s );
 		s = NULL;
 	}
 
@@ -170,18 +213,632 @@ int delete_node( pbst *p )
  * @param key the enum to delete.
  * @return 1 for succeed,
  *	   0 for failure.
+ *
+ * 不使用递归，沿孩子指针的地址下降，找到后由delete_node修改该指针。
  */
 int
 bst_delete( pbst *proot, int key )
 {
+	for ( ; *proot && key != (*proot)->data; )
+		proot = ( key < (*proot)->data ) ? &(*proot)->lc : &(*proot)->rc;
 	if ( !(*proot) )
 		return 0;
-	if ( key == (*proot)->data )
-		return delete_node( proot );
-	else if ( key < (*proot)->data )
-		return bst_delete( &(*proot)->lc, key );
-	else
-		return bst_delete( &(*proot)->rc, key );
+
+	return delete_node( proot );
+}
+
+/**
+ * @brief bst_destroy - destroy binary search tree, free it's space.
+ * @param proot pointer to the pointer to the root of binary search tree.
+ * @return 0 for success.
+ *
+ * 不使用递归：有左孩子时右旋，使左子树逐步变为右链，没有左孩子时释放
+ * 当前节点并转到右孩子，退化成链表的树也不会栈溢出。
+ */
+int
+bst_destroy( pbst *proot )
+{
+	pbst pn = *proot;
+	pbst ptmp = NULL;
+
+	for ( ; pn; ) {
+		if ( pn->lc ) {
+			ptmp = pn->lc;
+			pn->lc = ptmp->rc;
+			ptmp->rc = pn;
+			pn = ptmp;
+		} else {
+			ptmp = pn->rc;
+			bst_free( pn );
+			pn = ptmp;
+		}
+	}
+	(*proot) = NULL;
+
+	return 0;
+}
+
+/**
+ * @brief bst_floor - find the largest node not greater than key.
+ * @param proot pointer to the root of binary search tree.
+ * @param key the enum to search.
+ * @return pbst pointer to the node if found,
+ *	   NULL pointer if all nodes are greater than key.
+ *
+ * 一次非递归下降：当前节点不大于key时记为候选并向右，否则向左。
+ * bst_ceil、bst_predecessor、bst_successor与此类似。
+ */
+pbst
+bst_floor( pbst proot, int key )
+{
+	pbst pc = NULL;
+
+	for ( ; proot; ) {
+		if ( proot->data <= key ) {
+			pc = proot;
+			proot = proot->rc;
+		} else {
+			proot = proot->lc;
+		}
+	}
+
+	return pc;
+}
+
+/**
+ * @brief bst_ceil - find the smallest node not less than key.
+ * @param proot pointer to the root of binary search tree.
+ * @param key the enum to search.
+ * @return pbst pointer to the node if found,
+ *	   NULL pointer if all nodes are less than key.
+ */
+pbst
+bst_ceil( pbst proot, int key )
+{
+	pbst pc = NULL;
+
+	for ( ; proot; ) {
+		if ( proot->data >= key ) {
+			pc = proot;
+			proot = proot->lc;
+		} else {
+			proot = proot->rc;
+		}
+	}
+
+	return pc;
+}
+
+/**
+ * @brief bst_predecessor - find the largest node less than key.
+ * @param proot pointer to the root of binary search tree.
+ * @param key the enum to search, need not exist in the tree.
+ * @return pbst pointer to the node if found,
+ *	   NULL pointer if no node is less than key.
+ */
+pbst
+bst_predecessor( pbst proot, int key )
+{
+	pbst pc = NULL;
+
+	for ( ; proot; ) {
+		if ( proot->data < key ) {
+			pc = proot;
+			proot = proot->rc;
+		} else {
+			proot = proot->lc;
+		}
+	}
+
+	return pc;
+}
+
+/**
+ * @brief bst_successor - find the smallest node greater than key.
+ * @param proot pointer to the root of binary search tree.
+ * @param key the enum to search, need not exist in the tree.
+ * @return pbst pointer to the node if found,
+ *	   NULL pointer if no node is greater than key.
+ */
+pbst
+bst_successor( pbst proot, int key )
+{
+	pbst pc = NULL;
+
+	for ( ; proot; ) {
+		if ( proot->data > key ) {
+			pc = proot;
+			proot = proot->lc;
+		} else {
+			proot = proot->rc;
+		}
+	}
+
+	return pc;
+}
+
+/**
+ * @brief define the stack used by bst_nearest.
+ *
+ * 二叉排序树的深度没有上界，先使用栈上的数组，满了再从堆上分配。
+ */
+#define BST_STACK_INIT	64
+
+typedef struct _bst_stack {
+	pbst *s;
+	int top;
+	int cap;
+	pbst local[BST_STACK_INIT];
+}bst_stack;
+
+static int
+bst_stack_push( bst_stack *st, pbst p )
+{
+	pbst *ps = NULL;
+
+	if ( st->top == st->cap ) {
+		ps = ( pbst * )malloc( 2 * st->cap * sizeof(pbst) );
+		if ( !ps ) {
+			printf("No Memory!!\n");
+			return 0;
+		}
+		memcpy( ps, st->s, st->top * sizeof(pbst) );
+		if ( st->s != st->local )
+			free( st->s );
+		st->s = ps;
+		st->cap *= 2;
+	}
+	st->s[st->top++] = p;
+
+	return 1;
+}
+
+/**
+ * @brief bst_nearest - find the k keys nearest to key.
+ * @param proot pointer to the root of binary search tree.
+ * @param key the enum to search, need not exist in the tree.
+ * @param k count of keys wanted.
+ * @param keys array of at least k elements, to store keys found, 
+ *	  ordered by distance to key, smaller key first when equal.
+ * @return count of keys stored, less than k if the tree is small,
+ *	   -1 for failure.
+ *
+ * 下降时把不大于key的节点压入左栈并向右，大于key的节点压入右栈并向左，
+ * 两个栈顶分别是floor和successor。之后像归并一样每次取距离较近的一边：
+ * 左栈弹出节点后压入其左子树的最右路径，即得到下一个前驱；右栈对称。
+ * 每个节点最多入栈一次，总代价为一次下降加上O(k)。
+ */
+int
+bst_nearest( pbst proot, int key, int k, int *keys )
+{
+	bst_stack ls;
+	bst_stack rs;
+	pbst pn = NULL;
+	int n = 0;
+	int ok = 1;
+
+	ls.s = ls.local;
+	ls.top = 0;
+	ls.cap = BST_STACK_INIT;
+	rs.s = rs.local;
+	rs.top = 0;
+	rs.cap = BST_STACK_INIT;
+	for ( pn = proot; pn && ok; ) {
+		if ( pn->data <= key ) {
+			ok = bst_stack_push( &ls, pn );
+			pn = pn->rc;
+		} else {
+			ok = bst_stack_push( &rs, pn );
+			pn = pn->lc;
+		}
+	}
+	for ( ; ok && n < k && ( ls.top || rs.top ); n++ ) {
+		if ( ls.top && ( !rs.top || 
+		     (long long)key - ls.s[ls.top - 1]->data <= (long long)rs.s[rs.top - 1]->data - key ) ) {
+			pn = ls.s[--ls.top];
+			keys[n] = pn->data;
+			for ( pn = pn->lc; pn && ok; pn = pn->rc )
+				ok = bst_stack_push( &ls, pn );
+		} else {
+			pn = rs.s[--rs.top];
+			keys[n] = pn->data;
+			for ( pn = pn->rc; pn && ok; pn = pn->lc )
+				ok = bst_stack_push( &rs, pn );
+		}
+	}
+	if ( ls.s != ls.local )
+		free( ls.s );
+	if ( rs.s != rs.local )
+		free( rs.s );
+
+	return ok ? n : -1;
+}
+
+/**
+ * @brief bst_count - count nodes of subtree, stop at cap.
+ * @param proot pointer to the root of subtree.
+ * @param cap the most nodes to count.
+ * @return count of nodes, cap if there are more than cap nodes
+ *	   or no memory.
+ */
+static long
+bst_count( pbst proot, long cap )
+{
+	bst_stack st;
+	pbst pn = NULL;
+	long n = 0;
+	int ok = 1;
+
+	st.s = st.local;
+	st.top = 0;
+	st.cap = BST_STACK_INIT;
+	if ( proot )
+		ok = bst_stack_push( &st, proot );
+	for ( ; ok && st.top && n < cap; n++ ) {
+		pn = st.s[--st.top];
+		if ( pn->lc )
+			ok = bst_stack_push( &st, pn->lc );
+		if ( ok && pn->rc )
+			ok = bst_stack_push( &st, pn->rc );
+	}
+	if ( st.s != st.local )
+		free( st.s );
+
+	return ( ok && n < cap ) ? n : cap;
+}
+
+/**
+ * @brief bst_rebalance_path - rebuild the lowest too deep subtree above key.
+ * @param proot pointer to the pointer to the root of binary search tree.
+ * @param key the enum just inserted.
+ * @param depth depth of the node of key, the root is 0.
+ *
+ * 树中不保存节点个数，无法直接比较深度与c*log2(n)，因此像替罪羊树一样
+ * 检查子树：从新节点向上逐个计算祖先u的子树大小size(u)（加上另一侧
+ * 兄弟子树的节点数），找到第一个满足 h(u) > c*log2(size(u)) 的祖先，
+ * h(u)为新节点在u之下的深度，用bst_rebalance把u重建为完全平衡的子树。
+ * 若整棵树的深度超过c*log2(n)，根一定满足条件，所以总能找到；最低的
+ * 一个通常很小，重建的均摊代价为O(log n)。
+ * 只检查最近的BST_REBALANCE_DEPTH个祖先。size(u)达到 2^(H/c+1)
+ * （H为能检查的最大高度）后更高的祖先都不可能满足条件，停止计数，
+ * 所以一次检查最多数 2^(H/c+1) 个节点。
+ */
+static void
+bst_rebalance_path( pbst *proot, int key, int depth )
+{
+	pbst *link[BST_REBALANCE_DEPTH];
+	pbst *pl = proot;
+	pbst pn = NULL;
+	long size = 1;
+	long limit = 0;
+	int hmax = depth < BST_REBALANCE_DEPTH ? depth : BST_REBALANCE_DEPTH;
+	int h = 0;
+	int lg = 0;
+	int i = 0;
+
+	/* 只保留最近的BST_REBALANCE_DEPTH个祖先 */
+	for ( i = 0; (*pl)->data != key; i++ ) {
+		link[i % BST_REBALANCE_DEPTH] = pl;
+		pl = ( key < (*pl)->data ) ? &(*pl)->lc : &(*pl)->rc;
+	}
+	limit = 1L << ( hmax / bst_rebalance_factor + 1 );
+	for ( h = 1; h <= hmax; h++ ) {
+		pl = link[( depth - h ) % BST_REBALANCE_DEPTH];
+		pn = ( key < (*pl)->data ) ? (*pl)->rc : (*pl)->lc;
+		size += 1 + bst_count( pn, limit - size );
+		if ( size >= limit )
+			return;
+		for ( lg = 0; size >> ( lg + 1 ); lg++ )
+			;
+		if ( h > bst_rebalance_factor * lg ) {
+			bst_rebalance( pl );
+			return;
+		}
+	}
+}
+
+/**
+ * @brief bst_vine_next - take the next node in order, flattening on the way.
+ * @param pn pointer to the pointer to the rest of tree, updated each call.
+ * @return pbst pointer to the smallest node of the rest of tree,
+ *	   NULL pointer if the tree is empty.
+ *
+ * 与bst_destroy相同，有左孩子时右旋，使左子树逐步变为右链，没有左孩子
+ * 时当前节点即为中序的下一个。不使用递归和栈，退化的树也不会溢出。
+ */
+static pbst
+bst_vine_next( pbst *pn )
+{
+	pbst p = *pn;
+	pbst ptmp = NULL;
+
+	if ( !p )
+		return NULL;
+	for ( ; p->lc; ) {
+		ptmp = p->lc;
+		p->lc = ptmp->rc;
+		ptmp->rc = p;
+		p = ptmp;
+	}
+	(*pn) = p->rc;
+
+	return p;
+}
+
+/**
+ * @brief bst_build_vine - rebuild balanced tree from the sorted vine.
+ * @param head pointer to the pointer to the head of vine, linked by rc.
+ * @param n count of nodes to take from the vine.
+ * @return pbst pointer to the root of subtree built.
+ *
+ * 左子树取(n-1)/2个节点，右子树取其余的，递归深度为O(log n)。
+ */
+static pbst
+bst_build_vine( pbst *head, long n )
+{
+	pbst pn = NULL;
+	pbst plc = NULL;
+
+	if ( n <= 0 )
+		return NULL;
+	plc = bst_build_vine( head, ( n - 1 ) / 2 );
+	pn = *head;
+	*head = pn->rc;
+	pn->lc = plc;
+	pn->rc = bst_build_vine( head, n - 1 - ( n - 1 ) / 2 );
+
+	return pn;
+}
+
+/**
+ * @brief bst_build_weighted - build subtree whose root splits the weight evenly.
+ * @param nodes nodes in order.
+ * @param pre prefix sums of weight, pre[i] is the weight of nodes[0..i-1].
+ * @param lo the first node of subtree.
+ * @param hi one past the last node of subtree.
+ * @return pbst pointer to the root of subtree built.
+ *
+ * Mehlhorn的二分法：取使左右子树权重之差最小的节点为根，二分查找
+ * 前缀和得到。权重为w的节点深度不超过log2(W/w)+1（W为总权重），
+ * 递归深度因此也是O(log W)。
+ */
+static pbst
+bst_build_weighted( pbst *nodes, unsigned long long *pre, long lo, long hi )
+{
+	unsigned long long half = 0;
+	long long d0 = 0;
+	long long d1 = 0;
+	long l = lo;
+	long h = hi - 1;
+	long m = 0;
+	pbst pn = NULL;
+
+	if ( lo >= hi )
+		return NULL;
+	/* 找到第一个满足 pre[m+1] - pre[lo] >= 总权重一半 的m */
+	half = pre[lo] + ( pre[hi] - pre[lo] ) / 2;
+	for ( ; l < h; ) {
+		m = l + ( h - l ) / 2;
+		if ( pre[m + 1] >= half )
+			h = m;
+		else
+			l = m + 1;
+	}
+	/* l或l-1中左右权重之差更小的一个 */
+	d1 = llabs( (long long)( pre[l] - pre[lo] ) - (long long)( pre[hi] - pre[l + 1] ) );
+	if ( l > lo ) {
+		d0 = llabs( (long long)( pre[l - 1] - pre[lo] ) - (long long)( pre[hi] - pre[l] ) );
+		if ( d0 < d1 )
+			l--;
+	}
+	pn = nodes[l];
+	pn->lc = bst_build_weighted( nodes, pre, lo, l );
+	pn->rc = bst_build_weighted( nodes, pre, l + 1, hi );
+
+	return pn;
+}
+
+/**
+ * @brief bst_rebuild_weighted - rebuild tree by access counters.
+ * @param proot pointer to the pointer to the root of binary search tree.
+ * @return 1 for succeed,
+ *	   0 for failure.
+ *
+ * 把树拉直成有序链表，以 hits+1 为每个节点的权重（没有被抽样到的
+ * 关键字也保留最小的权重），按权重二分重建为近似最优的二叉排序树：
+ * 期望查找长度不超过最优树的 H+2（H为访问分布的熵）。
+ * 重建后计数减半，分布变化时旧的热点逐渐被遗忘。
+ * 辅助数组分配失败时按节点个数重建为平衡的树并返回0。
+ */
+int
+bst_rebuild_weighted( pbst *proot )
+{
+	pbst head = NULL;
+	pbst *tail = &head;
+	pbst pn = NULL;
+	pbst *nodes = NULL;
+	unsigned long long *pre = NULL;
+	long n = 0;
+	long i = 0;
+
+	for ( ; ( pn = bst_vine_next( proot ) ); n++ ) {
+		*tail = pn;
+		tail = &pn->rc;
+	}
+	*tail = NULL;
+	nodes = ( pbst * )malloc( ( n ? n : 1 ) * sizeof(pbst) );
+	pre = ( unsigned long long * )malloc( ( n + 1 ) * sizeof(unsigned long long) );
+	if ( !nodes || !pre ) {
+		printf("No Memory!!\n");
+		free( nodes );
+		free( pre );
+		(*proot) = bst_build_vine( &head, n );
+		return 0;
+	}
+	pre[0] = 0;
+	for ( i = 0, pn = head; pn; pn = pn->rc, i++ ) {
+		nodes[i] = pn;
+		pre[i + 1] = pre[i] + pn->hits + 1;
+		pn->hits >>= 1;
+	}
+	(*proot) = bst_build_weighted( nodes, pre, 0, n );
+	free( nodes );
+	free( pre );
+
+	return 1;
+}
+
+/**
+ * @brief bst_compress - rotate left every other node of the vine.
+ * @param head the pseudo root whose rc is the vine.
+ * @param count count of rotations.
+ */
+static void
+bst_compress( pbst head, long count )
+{
+	pbst pn = head;
+	pbst pc = NULL;
+	long i = 0;
+
+	for ( i = 0; i < count; i++ ) {
+		pc = pn->rc;
+		pn->rc = pc->rc;
+		pn = pn->rc;
+		pc->rc = pn->lc;
+		pn->lc = pc;
+	}
+}
+
+/**
+ * @brief bst_rebalance - rebuild tree into a perfectly balanced one.
+ * @param proot pointer to the pointer to the root of binary search tree,
+ *	  or to a child pointer for rebuilding a subtree.
+ * @return the count of nodes.
+ *
+ * Day-Stout-Warren算法，O(n)时间，O(1)额外空间，不分配内存也不递归：
+ *	1.有左孩子时右旋，把树拉直成沿rc连接的有序链表（vine）。
+ *	2.设m为不超过n的最大的2^k-1，先对链表做n-m次左旋，得到最底层的
+ *	  叶子，再对剩下的链表依次做m/2、m/4、……次左旋，每一轮链表的长度
+ *	  减半，最后得到除最底层外都是满的树，高度为floor(log2(n))+1。
+ * 排好序的关键字逐个插入会使树退化成链表，插入完成后调用一次即可。
+ */
+long
+bst_rebalance( pbst *proot )
+{
+	bst_node head;
+	pbst tail = &head;
+	pbst rest = *proot;
+	pbst ptmp = NULL;
+	long n = 0;
+	long m = 0;
+
+	head.rc = rest;
+	for ( ; rest; ) {
+		if ( rest->lc ) {
+			ptmp = rest->lc;
+			rest->lc = ptmp->rc;
+			ptmp->rc = rest;
+			rest = ptmp;
+			tail->rc = ptmp;
+		} else {
+			tail = rest;
+			rest = rest->rc;
+			n++;
+		}
+	}
+	for ( m = 1; m <= n; m = 2 * m + 1 )
+		;
+	m /= 2;
+	bst_compress( &head, n - m );
+	for ( ; m > 1; ) {
+		m /= 2;
+		bst_compress( &head, m );
+	}
+	(*proot) = head.rc;
+
+	return n;
+}
+
+/**
+ * @brief bst_merge - merge two binary search trees in O(n+m).
+ * @param proot pointer to the pointer to the root of tree to merge into.
+ * @param pother pointer to the pointer to the root of tree to merge from,
+ *	  it's NULL after merging.
+ * @return the count of nodes in the merged tree.
+ *
+ * 两棵树一边拉直一边按中序取出节点，像归并排序一样接成一个有序链表，
+ * 关键字相同时保留proot中的节点并释放另一个，最后从链表重建平衡的树。复用原有节点，
+ * 不分配内存；逐个插入需要O(m log(n+m))，且得到的树形状很差。
+ */
+long
+bst_merge( pbst *proot, pbst *pother )
+{
+	pbst pa = NULL;
+	pbst pb = NULL;
+	pbst ptmp = NULL;
+	pbst head = NULL;
+	pbst *tail = &head;
+	long n = 0;
+
+	pa = bst_vine_next( proot );
+	pb = bst_vine_next( pother );
+	for ( ; pa || pb; n++ ) {
+		if ( !pa || ( pb && pb->data < pa->data ) ) {
+			*tail = pb;
+			pb = bst_vine_next( pother );
+		} else {
+			if ( pb && pb->data == pa->data ) {
+				ptmp = pb;
+				pb = bst_vine_next( pother );
+				bst_free( ptmp );
+			}
+			*tail = pa;
+			pa = bst_vine_next( proot );
+		}
+		tail = &(*tail)->rc;
+	}
+	*tail = NULL;
+	(*proot) = bst_build_vine( &head, n );
+
+	return n;
+}
+
+/**
+ * @brief bst_dump_lc - access functions used by treedump.h.
+ */
+static void *
+bst_dump_lc( void *n )
+{
+	return ( ( pbst )n )->lc;
+}
+
+static void *
+bst_dump_rc( void *n )
+{
+	return ( ( pbst )n )->rc;
+}
+
+static long long
+bst_dump_key( void *n )
+{
+	return ( ( pbst )n )->data;
+}
+
+static const tree_dump_ops bst_dump_ops = {
+	bst_dump_lc, bst_dump_rc, bst_dump_key, NULL, TDUMP_ATTR_NONE, sizeof(int)
+};
+
+/**
+ * @brief bst_dump - dump binary search tree without recursion.
+ * @param proot pointer to the root of binary search tree.
+ * @param d pointer to the writer initialized by tdump_init.
+ * @return 1 for succeed,
+ *	   0 for failure.
+ */
+int
+bst_dump( pbst proot, ptree_dump d )
+{
+	return tdump_tree( d, proot, NULL, &bst_dump_ops );
 }
 
 /**
@@ -189,31 +846,416 @@ bst_delete( pbst *proot, int key )
  * @param proot pointer to the node of binary search tree.
  * @param parent pointer to the parent node of node which pointer proot point to
  * @return none.
+ *
+ * 通过treedump.h以文本格式写到标准输出，不再递归调用printf。
  */
 void
 bst_show( pbst proot, pbst parent )
 {
-	if ( proot ) {
-		printf("Current:%-4d", proot->data);
-		if ( proot->lc )
-			printf("LC:%-4d", proot->lc->data);
-		else
-			printf("LC:$   ");
-		if ( proot->rc )
-			printf("RC:%-4d", proot->rc->data);
-		else
-			printf("RC:$   ");
-		if ( parent )
-			printf("P:%-4d\n", parent->data);
-		else
-			printf("P:$   \n");
-		bst_show( proot->lc, proot );
-		bst_show( proot->rc, proot );
-	}
+	char buf[8192];
+	tree_dump d;
+
+	fflush( stdout );
+	tdump_init( &d, STDOUT_FILENO, buf, sizeof(buf), TDUMP_TEXT );
+	tdump_tree( &d, proot, parent, &bst_dump_ops );
 
 	return;
 }
 
+/**
+ * @brief bst_kv_search1 - searching key in key/value binary search tree.
+ * @param proot pointer to the root of key/value binary search tree.
+ * @param key the key to search.
+ * @return pbst_kv pointer to the node if found,
+ *	   NULL pointer if key not found.
+ *
+ * 非递归查找，找到后可以直接通过节点的值域取得数据。
+ */
+pbst_kv
+bst_kv_search1( pbst_kv proot, bst_key key )
+{
+	for ( ; proot && key != proot->key; )
+		proot = ( key < proot->key ) ? proot->lc : proot->rc;
+
+	return proot;
+}
+
+/**
+ * @brief bst_kv_get - get the value of key in key/value binary search tree.
+ * @param proot pointer to the root of key/value binary search tree.
+ * @param key the key to search.
+ * @param value pointer to store the value found, may be NULL.
+ * @return 1 for found,
+ *	   0 for not found.
+ */
+int
+bst_kv_get( pbst_kv proot, bst_key key, bst_value *value )
+{
+	pbst_kv p = bst_kv_search1( proot, key );
+
+	if ( !p )
+		return 0;
+	if ( value )
+		*value = p->value;
+
+	return 1;
+}
+
+/**
+ * @brief bst_kv_insert - insert a key/value pair into binary search tree.
+ * @param proot pointer to the pointer to the root of key/value binary search tree.
+ * @param key the key to insert.
+ * @param value the value bound to key.
+ * @return 1 for new node inserted,
+ *	   0 for key already exists (value is updated) or failure.
+ */
+int
+bst_kv_insert( pbst_kv *proot, bst_key key, bst_value value )
+{
+	pbst_kv *pp = proot;
+	pbst_kv pe = NULL;
+
+	for ( ; *pp; ) {
+		if ( key == (*pp)->key ) {
+			(*pp)->value = value;
+			return 0;
+		}
+		pp = ( key < (*pp)->key ) ? &(*pp)->lc : &(*pp)->rc;
+	}
+	pe = ( pbst_kv )bst_alloc( sizeof( bst_kv_node ) );
+	if ( !pe ) {
+		printf("No Memory!!\n");
+		return 0;
+	}
+	pe->key = key;
+	pe->value = value;
+	pe->lc = NULL;
+	pe->rc = NULL;
+	(*pp) = pe;
+
+	return 1;
+}
+
+/**
+ * @brief bst_kv_delete - delete a key from key/value binary search tree.
+ * @param proot pointer to the pointer to the root of key/value binary search tree.
+ * @param key the key to delete.
+ * @return 1 for succeed,
+ *	   0 for failure.
+ *
+ * 与delete_node相同，左右子树均存在时用直接前驱替换被删节点。
+ */
+int
+bst_kv_delete( pbst_kv *proot, bst_key key )
+{
+	pbst_kv *pp = proot;
+	pbst_kv *ps = NULL;
+	pbst_kv q = NULL;
+
+	for ( ; *pp && key != (*pp)->key; )
+		pp = ( key < (*pp)->key ) ? &(*pp)->lc : &(*pp)->rc;
+	if ( !(*pp) )
+		return 0;
+
+	q = *pp;
+	if ( !q->rc ) {
+		(*pp) = q->lc;
+	} else if ( !q->lc ) {
+		(*pp) = q->rc;
+	} else {
+		ps = &q->lc;
+		for ( ; (*ps)->rc; )
+			ps = &(*ps)->rc;
+		q->key = (*ps)->key;
+		q->value = (*ps)->value;
+		q = *ps;
+		(*ps) = q->lc;
+	}
+	bst_free( q );
+
+	return 1;
+}
+
+/**
+ * @brief bst_kv_destroy - destroy key/value binary search tree, free it's space.
+ * @param proot pointer to the pointer to the root of key/value binary search tree.
+ * @return 0 for success.
+ */
+int
+bst_kv_destroy( pbst_kv *proot )
+{
+	if ( *proot ) {
+		bst_kv_destroy( &(*proot)->lc );
+		bst_kv_destroy( &(*proot)->rc );
+		bst_free( *proot );
+		(*proot) = NULL;
+	}
+
+	return 0;
+}
+
+#define DUMP_KEYS	( 1 << 20 )
+
+/**
+ * @brief dump_bench - dump a large tree to /dev/null in every format.
+ */
+static void
+dump_bench( void )
+{
+	static char buf[1 << 20];
+	const char *names[4] = { "text", "dot", "json", "binary" };
+	tree_dump d;
+	pbst proot = NULL;
+	struct timespec t0;
+	struct timespec t1;
+	double sec = 0;
+	int fd = open( "/dev/null", O_WRONLY );
+	int i = 0;
+	int fmt = 0;
+
+	if ( fd < 0 )
+		return;
+	for ( i = 0; i < DUMP_KEYS; i++ )
+		bst_insert( &proot, rand() );
+	for ( fmt = TDUMP_TEXT; fmt <= TDUMP_BIN; fmt++ ) {
+		clock_gettime( CLOCK_MONOTONIC, &t0 );
+		tdump_init( &d, fd, buf, sizeof(buf), fmt );
+		bst_dump( proot, &d );
+		clock_gettime( CLOCK_MONOTONIC, &t1 );
+		sec = ( t1.tv_sec - t0.tv_sec ) + ( t1.tv_nsec - t0.tv_nsec ) / 1e9;
+		printf("%-6s %ld nodes, %.1f ns/node\n", names[fmt], d.count, sec * 1e9 / d.count);
+	}
+	close( fd );
+	bst_destroy( &proot );
+}
+
+#define MERGE_KEYS	( 1 << 19 )
+
+/**
+ * @brief merge_build - build two trees of random keys from seed.
+ */
+static void
+merge_build( pbst *pa, pbst *pb, unsigned int seed )
+{
+	int i = 0;
+
+	srand( seed );
+	for ( i = 0; i < MERGE_KEYS; i++ ) {
+		bst_insert( pa, rand() );
+		bst_insert( pb, rand() );
+	}
+}
+
+/**
+ * @brief lookup_ms - time looking up every key of the trees built from seed.
+ */
+static double
+lookup_ms( pbst proot, unsigned int seed )
+{
+	struct timespec t0;
+	struct timespec t1;
+	long hit = 0;
+	int i = 0;
+
+	srand( seed );
+	clock_gettime( CLOCK_MONOTONIC, &t0 );
+	for ( i = 0; i < 2 * MERGE_KEYS; i++ )
+		hit += ( bst_search1( proot, rand() ) != NULL );
+	clock_gettime( CLOCK_MONOTONIC, &t1 );
+	if ( hit != 2 * MERGE_KEYS )
+		printf("%ld keys missing.\n", 2 * MERGE_KEYS - hit);
+
+	return ( t1.tv_sec - t0.tv_sec ) * 1e3 + ( t1.tv_nsec - t0.tv_nsec ) / 1e6;
+}
+
+/**
+ * @brief merge_bench - merge two large trees, by insertion and by bst_merge.
+ */
+static void
+merge_bench( void )
+{
+	unsigned int seed = (unsigned int)time(NULL);
+	pbst pa = NULL;
+	pbst pb = NULL;
+	pbst pn = NULL;
+	pbst *stack = ( pbst * )malloc( MERGE_KEYS * sizeof(pbst) );
+	struct timespec t0;
+	struct timespec t1;
+	double ins = 0;
+	double mrg = 0;
+	double ins_look = 0;
+	long n = 0;
+	int top = 0;
+
+	if ( !stack ) {
+		printf("No Memory!!\n");
+		return;
+	}
+	/* 逐个插入，中序遍历pb */
+	merge_build( &pa, &pb, seed );
+	clock_gettime( CLOCK_MONOTONIC, &t0 );
+	for ( pn = pb; pn || top; ) {
+		if ( pn ) {
+			stack[top++] = pn;
+			pn = pn->lc;
+		} else {
+			pn = stack[--top];
+			bst_insert( &pa, pn->data );
+			pn = pn->rc;
+		}
+	}
+	clock_gettime( CLOCK_MONOTONIC, &t1 );
+	ins = ( t1.tv_sec - t0.tv_sec ) + ( t1.tv_nsec - t0.tv_nsec ) / 1e9;
+	ins_look = lookup_ms( pa, seed );
+	bst_destroy( &pa );
+	bst_destroy( &pb );
+
+	merge_build( &pa, &pb, seed );
+	clock_gettime( CLOCK_MONOTONIC, &t0 );
+	n = bst_merge( &pa, &pb );
+	clock_gettime( CLOCK_MONOTONIC, &t1 );
+	mrg = ( t1.tv_sec - t0.tv_sec ) + ( t1.tv_nsec - t0.tv_nsec ) / 1e9;
+	printf("merge %d + %d keys: insert %.1f ms, bst_merge %.1f ms, %ld nodes.\n",
+		MERGE_KEYS, MERGE_KEYS, ins * 1e3, mrg * 1e3, n);
+	printf("lookups: %.1f ms after insert, %.1f ms after bst_merge.\n",
+		ins_look, lookup_ms( pa, seed ));
+	bst_destroy( &pa );
+	free( stack );
+}
+
+#define SKEW_KEYS	( 1 << 20 )
+#define SKEW_GETS	( 1 << 22 )
+
+/**
+ * @brief skew_run - time skewed lookups and measure their average depth.
+ */
+static void
+skew_run( pbst proot, const int *query, const char *name )
+{
+	struct timespec t0;
+	struct timespec t1;
+	double sec = 0;
+	long depth = 0;
+	long hit = 0;
+	pbst pn = NULL;
+	int i = 0;
+
+	for ( i = 0; i < SKEW_GETS; i++ ) {
+		for ( pn = proot; pn && pn->data != query[i]; depth++ )
+			pn = ( query[i] < pn->data ) ? pn->lc : pn->rc;
+	}
+	clock_gettime( CLOCK_MONOTONIC, &t0 );
+	for ( i = 0; i < SKEW_GETS; i++ )
+		hit += ( bst_search1( proot, query[i] ) != NULL );
+	clock_gettime( CLOCK_MONOTONIC, &t1 );
+	sec = ( t1.tv_sec - t0.tv_sec ) + ( t1.tv_nsec - t0.tv_nsec ) / 1e9;
+	printf("%-9s average depth %.2f, %.1f ns/get%s.\n", name, (double)depth / SKEW_GETS,
+		sec * 1e9 / SKEW_GETS, hit == SKEW_GETS ? "" : ", keys missing");
+}
+
+/**
+ * @brief skew_bench - lookups whose rank follows a power law, P(rank >= r) ~ 1/r.
+ */
+static void
+skew_bench( void )
+{
+	int *keys = ( int * )malloc( SKEW_KEYS * sizeof(int) );
+	int *query = ( int * )malloc( SKEW_GETS * sizeof(int) );
+	pbst proot = NULL;
+	pbst pempty = NULL;
+	long rank = 0;
+	int i = 0;
+
+	if ( !keys || !query ) {
+		printf("No Memory!!\n");
+		free( keys );
+		free( query );
+		return;
+	}
+	for ( i = 0; i < SKEW_KEYS; i++ ) {
+		keys[i] = rand();
+		bst_insert( &proot, keys[i] );
+	}
+	for ( i = 0; i < SKEW_GETS; i++ ) {
+		rank = (long)( ( RAND_MAX + 1.0 ) / ( rand() + 1.0 ) ) - 1;
+		rank = rank < SKEW_KEYS ? rank : SKEW_KEYS - 1;
+		/* 热点关键字与插入顺序无关 */
+		query[i] = keys[( ( rank + 1 ) * 2654435761L ) & ( SKEW_KEYS - 1 )];
+	}
+	skew_run( proot, query, "random" );
+	bst_merge( &proot, &pempty );
+	skew_run( proot, query, "balanced" );
+	bst_hit_sample = 16;
+	skew_run( proot, query, "sampling" );
+	bst_hit_sample = 0;
+	bst_rebuild_weighted( &proot );
+	skew_run( proot, query, "weighted" );
+	bst_destroy( &proot );
+	free( keys );
+	free( query );
+}
+
+#define SORTED_KEYS	( 1 << 14 )
+
+/**
+ * @brief sorted_run - insert sorted keys and measure the average depth.
+ */
+static void
+sorted_run( pbst *proot, const char *name )
+{
+	struct timespec t0;
+	struct timespec t1;
+	double sec = 0;
+	long depth = 0;
+	pbst pn = NULL;
+	int i = 0;
+
+	clock_gettime( CLOCK_MONOTONIC, &t0 );
+	for ( i = 0; i < SORTED_KEYS; i++ )
+		bst_insert( proot, i );
+	clock_gettime( CLOCK_MONOTONIC, &t1 );
+	sec = ( t1.tv_sec - t0.tv_sec ) + ( t1.tv_nsec - t0.tv_nsec ) / 1e9;
+	for ( i = 0; i < SORTED_KEYS; i++ ) {
+		for ( pn = *proot; pn && pn->data != i; depth++ )
+			pn = ( i < pn->data ) ? pn->lc : pn->rc;
+	}
+	printf("%-10s insert %.1f ms, average depth %.2f.\n", name, sec * 1e3,
+		(double)depth / SORTED_KEYS);
+}
+
+/**
+ * @brief sorted_bench - sorted ingest with and without rebalancing.
+ */
+static void
+sorted_bench( void )
+{
+	struct timespec t0;
+	struct timespec t1;
+	pbst proot = NULL;
+	pbst pn = NULL;
+	long depth = 0;
+	int factor = bst_rebalance_factor;
+	int i = 0;
+
+	printf("%d sorted keys:\n", SORTED_KEYS);
+	bst_rebalance_factor = 0;
+	sorted_run( &proot, "no rebuild" );
+	clock_gettime( CLOCK_MONOTONIC, &t0 );
+	bst_rebalance( &proot );
+	clock_gettime( CLOCK_MONOTONIC, &t1 );
+	for ( i = 0; i < SORTED_KEYS; i++ ) {
+		for ( pn = proot; pn && pn->data != i; depth++ )
+			pn = ( i < pn->data ) ? pn->lc : pn->rc;
+	}
+	printf("%-10s %.2f ms, average depth %.2f.\n", "dsw",
+		( ( t1.tv_sec - t0.tv_sec ) + ( t1.tv_nsec - t0.tv_nsec ) / 1e9 ) * 1e3,
+		(double)depth / SORTED_KEYS);
+	bst_destroy( &proot );
+	bst_rebalance_factor = factor;
+	sorted_run( &proot, "automatic" );
+	bst_destroy( &proot );
+}
+
 int
 main()
 {
@@ -224,6 +1266,12 @@ main()
 	pbst proot = NULL; /* 此处一定要显式置NULL，否则调用会出错，因为是根 */
 	pbst proot1 = NULL;
 	pbst pfind = NULL;
+	pbst_kv pkv = NULL;
+	bst_value value = 0;
+	char dbuf[4096];
+	tree_dump d;
+	int nearest[5];
+	int n = 0;
 
 	srand( (unsigned int)time(NULL) );
 	for ( i = 0; i < INIT_SIZE; i++ ) {
@@ -259,10 +1307,66 @@ main()
 	}
 	bst_show( proot1, NULL );
 	printf("\n");
-	/* 删除新节点 */
+	/* 删除新节点，52有两个孩子，由前驱47替换，47的访问计数应保留 */
+	bst_hit_sample = 1;
+	for ( i = 0; i < 3; i++ )
+		bst_search1( proot1, 47 );
+	bst_hit_sample = 0;
 	bst_delete( &proot1, 52 );
 	bst_show( proot1, NULL );
 	printf("\n");
+	pfind = bst_search1( proot1, 47 );
+	if ( pfind && pfind->hits == 3 )
+		printf("Hits of 47 kept after deleting 52.\n");
+	else
+		printf("Hits of 47 lost after deleting 52!!\n");
+
+	/* 键值二叉搜索树 */
+	for ( i = 0; i < 12; i++ ) {
+		bst_kv_insert( &pkv, (bst_key)array1[i] << 32, array1[i] * 10 );
+	}
+	if ( bst_kv_get( pkv, (bst_key)43 << 32, &value ) )
+		printf("Key found. value is %lld.\n", (long long)value);
+	bst_kv_delete( &pkv, (bst_key)52 << 32 );
+	if ( !bst_kv_get( pkv, (bst_key)52 << 32, &value ) )
+		printf("Key not exists.\n");
+	bst_kv_destroy( &pkv );
+
+	/* 导出到用户提供的缓冲区 */
+	tdump_init( &d, -1, dbuf, sizeof(dbuf), TDUMP_DOT );
+	if ( bst_dump( proot1, &d ) )
+		fwrite( dbuf, 1, d.len, stdout );
+	tdump_init( &d, -1, dbuf, sizeof(dbuf), TDUMP_JSON );
+	if ( bst_dump( proot1, &d ) )
+		fwrite( dbuf, 1, d.len, stdout );
+	bst_destroy( &proot );
+	bst_destroy( &proot1 );
+	dump_bench();
+
+	/* 合并两棵树 */
+	for ( i = 0; i < INIT_SIZE; i++ ) {
+		bst_insert( &proot, array[i] );
+		bst_insert( &proot1, array[i] + 50 );
+	}
+	printf("%ld nodes after merging.\n", bst_merge( &proot, &proot1 ));
+	bst_show( proot, NULL );
+
+	/* 邻近查询 */
+	pfind = bst_floor( proot, 60 );
+	if ( pfind )
+		printf("floor(60) = %d.\n", pfind->data);
+	pfind = bst_successor( proot, 60 );
+	if ( pfind )
+		printf("successor(60) = %d.\n", pfind->data);
+	n = bst_nearest( proot, 60, 5, nearest );
+	printf("5 keys nearest to 60:");
+	for ( i = 0; i < n; i++ )
+		printf(" %d", nearest[i]);
+	printf("\n");
+	bst_destroy( &proot );
+	merge_bench();
+	skew_bench();
+	sorted_bench();
 
 	return 0;
 }
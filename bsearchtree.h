@@ -7,6 +7,9 @@
 #include <stdio.h>
 #include <stdlib.h>
 
+#include "treedump.h"
+#include "treealloc.h"
+
 /**
  * @brief define the binary search tree node and it's basic oprations
  *
@@ -17,8 +20,12 @@
  *	3. 它的左、右子树也分别为二叉排序树。
  *  
  */
+#define BST_HITS_MAX	0xffffffffU
+#define BST_REBALANCE_DEPTH	48	/* 插入深度超过该值时才检查是否需要重建 */
+
 typedef struct _binary_search_tree {
 	int data;
+	unsigned int hits;	/* 抽样得到的访问次数 */
 	struct _binary_search_tree *lc, *rc;/* left and right child pointer */
 }bst_node, *pbst;
 
@@ -26,3 +33,47 @@ pbst bst_search1( pbst proot, int key );
 int bst_search2( pbst proot, int key, pbst *p);
 int bst_insert( pbst *proot, int e );
 int bst_delete( pbst *proot, int key);
+pbst bst_floor( pbst proot, int key );
+pbst bst_ceil( pbst proot, int key );
+pbst bst_predecessor( pbst proot, int key );
+pbst bst_successor( pbst proot, int key );
+int bst_nearest( pbst proot, int key, int k, int *keys );
+int bst_destroy( pbst *proot );
+int bst_dump( pbst proot, ptree_dump d );
+
+/* 不为NULL时节点从该内存池分配（见treealloc.h），一棵树的节点全部释放
+ * 之前不能更换 */
+extern ptree_arena bst_arena;
+long bst_merge( pbst *proot, pbst *pother );
+int bst_rebuild_weighted( pbst *proot );
+long bst_rebalance( pbst *proot );
+
+extern int bst_hit_sample;	/* 访问计数的抽样间隔，0表示不计数 */
+extern int bst_rebalance_factor;	/* 自动重建的系数c，0表示不自动重建 */
+
+/**
+ * @brief define the key/value binary search tree node.
+ *
+ * 带有64位关键字和值域的二叉排序树节点，查找时直接返回值域，
+ * 不必再借助另一个关键字到值的映射结构。
+ * 值域类型默认为 long long，可以在包含本头文件之前定义 BST_VALUE_TYPE
+ * 为任意定长类型（包括结构体）。
+ */
+#ifndef BST_VALUE_TYPE
+#define BST_VALUE_TYPE long long
+#endif
+
+typedef long long bst_key;
+typedef BST_VALUE_TYPE bst_value;
+
+typedef struct _binary_search_tree_kv {
+	bst_key key;
+	bst_value value;
+	struct _binary_search_tree_kv *lc, *rc;/* left and right child pointer */
+}bst_kv_node, *pbst_kv;
+
+pbst_kv bst_kv_search1( pbst_kv proot, bst_key key );
+int bst_kv_get( pbst_kv proot, bst_key key, bst_value *value );
+int bst_kv_insert( pbst_kv *proot, bst_key key, bst_value value );
+int bst_kv_delete( pbst_kv *proot, bst_key key );
+int bst_kv_destroy( pbst_kv *proot );
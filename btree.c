@@ -7,6 +7,8 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <limits.h>
+#include <time.h>
 
 #include "btree.h"
 
@@ -294,6 +296,637 @@ levelorder_tranverse_nonrecursive( pbtree proot, pbtree_queue q)
 }
 
 
+/**
+ * @brief ibtree_init - use the level order string as an implicit binary tree.
+ * @param t pointer to the implicit binary tree.
+ * @param p pointer to input string, the same as create_btree_by_level.
+ * @return 1 for succeed,
+ *	   0 for failure.
+ *
+ * 只记录字符串的地址和长度，树的生存期内字符串不能释放或修改。
+ */
+int
+ibtree_init( pibtree t, char *p )
+{
+	if ( !p )
+		return 0;
+	t->data = p;
+	t->n = strlen( p );
+
+	return 1;
+}
+
+/**
+ * @brief ibtree_exists - check whether node i is in the implicit binary tree.
+ * @param t pointer to the implicit binary tree.
+ * @param i index of node, the root is 1.
+ * @return 1 for yes,
+ *	   0 for no.
+ *
+ * 节点i及其所有祖先都不为'$'时才在树中，与create_btree_by_level一致：
+ * 空子树下面的位置即使有字符也被忽略。
+ */
+int
+ibtree_exists( pibtree t, int i )
+{
+	for ( ; i >= 1; i = IBT_PARENT(i) ) {
+		if ( i > t->n || '$' == t->data[i - 1] )
+			return 0;
+	}
+
+	return 1;
+}
+
+/**
+ * @brief ibtree_preorder - visit implicit tree's node by D-L-R order.
+ * @param t pointer to the implicit binary tree.
+ * @param i index of the subtree's root, 1 for the whole tree.
+ * @return none.
+ *
+ * 调用者保证i的双亲在树中，所以只需检查i本身。递归深度不超过
+ * log2(n)+1，不会栈溢出。中序、后序与此相同。
+ */
+void
+ibtree_preorder( pibtree t, int i )
+{
+	if ( i <= t->n && '$' != t->data[i - 1] ) {
+		printf("%c  ", t->data[i - 1]);
+		ibtree_preorder( t, IBT_LC(i) );
+		ibtree_preorder( t, IBT_RC(i) );
+	} else {
+		printf("$  ");
+	}
+
+	return;
+}
+
+/**
+ * @brief ibtree_inorder - visit implicit tree's node by L-D-R order.
+ * @param t pointer to the implicit binary tree.
+ * @param i index of the subtree's root, 1 for the whole tree.
+ * @return none.
+ */
+void
+ibtree_inorder( pibtree t, int i )
+{
+	if ( i <= t->n && '$' != t->data[i - 1] ) {
+		ibtree_inorder( t, IBT_LC(i) );
+		printf("%c  ", t->data[i - 1]);
+		ibtree_inorder( t, IBT_RC(i) );
+	} else {
+		printf("$  ");
+	}
+
+	return;
+}
+
+/**
+ * @brief ibtree_postorder - visit implicit tree's node by L-R-D order.
+ * @param t pointer to the implicit binary tree.
+ * @param i index of the subtree's root, 1 for the whole tree.
+ * @return none.
+ */
+void
+ibtree_postorder( pibtree t, int i )
+{
+	if ( i <= t->n && '$' != t->data[i - 1] ) {
+		ibtree_postorder( t, IBT_LC(i) );
+		ibtree_postorder( t, IBT_RC(i) );
+		printf("%c  ", t->data[i - 1]);
+	} else {
+		printf("$  ");
+	}
+
+	return;
+}
+
+/**
+ * @brief ibtree_levelorder - visit implicit tree's node by level order.
+ * @param t pointer to the implicit binary tree.
+ * @return none.
+ *
+ * 按层次的访问顺序就是下标的递增顺序，顺序扫描数组即可，不需要队列。
+ * 与levelorder_tranverse_nonrecursive的输出相同：根和树中每个节点的
+ * 两个孩子各输出一项，空子树输出'$'。
+ * 双亲的下标总比孩子小，扫描时用in[i]记下节点i是否在树中，孩子只看
+ * 双亲的记录，不再逐个沿祖先上溯，总代价O(n)。
+ */
+void
+ibtree_levelorder( pibtree t )
+{
+	unsigned char *in = NULL;
+	int i = 0;
+
+	in = ( unsigned char * )calloc( t->n + 1, sizeof(unsigned char) );
+	if ( !in ) {
+		printf("No memory.\n");
+		return;
+	}
+	for ( i = 1; i <= 2 * t->n + 1; i++ ) {
+		if ( 1 != i && !in[IBT_PARENT(i)] )
+			continue;
+		if ( i <= t->n && '$' != t->data[i - 1] ) {
+			in[i] = 1;
+			printf("%c  ", t->data[i - 1]);
+		} else {
+			printf("$  ");
+		}
+	}
+	free( in );
+
+	return;
+}
+
+/**
+ * 简洁二叉树的内部操作，位k在bits[k/64]的第k%64位。
+ * E(k)表示前k位的超额，1记+1，0记-1；E(0)为0，E(m)为-1，其余不小于0。
+ */
+static inline int
+sbtree_popcount( unsigned long long x )
+{
+#ifdef __GNUC__
+	return __builtin_popcountll( x );
+#else
+	int c = 0;
+
+	for ( ; x; x &= x - 1 )
+		c++;
+
+	return c;
+#endif
+}
+
+static inline unsigned int *
+sbtree_rankdir( psbtree t )
+{
+	return ( unsigned int * )( t->bits + t->words );
+}
+
+static inline int *
+sbtree_rmm( psbtree t )
+{
+	return ( int * )( sbtree_rankdir( t ) + t->words + 1 );
+}
+
+static inline char *
+sbtree_chars( psbtree t )
+{
+	return ( char * )( sbtree_rmm( t ) + 2 * t->leaves );
+}
+
+static inline int
+sbtree_bit( psbtree t, int k )
+{
+	return ( t->bits[k >> 6] >> ( k & 63 ) ) & 1;
+}
+
+/* 前k位中1的个数 */
+static inline int
+sbtree_rank1( psbtree t, int k )
+{
+	int r = sbtree_rankdir( t )[k >> 6];
+
+	if ( k & 63 )
+		r += sbtree_popcount( t->bits[k >> 6] & ( ( 1ULL << ( k & 63 ) ) - 1 ) );
+
+	return r;
+}
+
+static inline int
+sbtree_excess( psbtree t, int k )
+{
+	return 2 * sbtree_rank1( t, k ) - k;
+}
+
+/**
+ * @brief sbtree_alloc - allocate a succinct tree of n nodes in one block.
+ */
+static psbtree
+sbtree_alloc( int n )
+{
+	psbtree t = NULL;
+	int m = 2 * n + 1;
+	int words = ( m + 63 ) / 64;
+	int leaves = 0;
+
+	if ( words > SBT_SCAN_WORDS ) {
+		for ( leaves = 1; leaves < words; )
+			leaves *= 2;
+	}
+	t = ( psbtree )calloc( 1, sizeof(sbtree) + words * sizeof(unsigned long long)
+		+ ( words + 1 ) * sizeof(unsigned int) + 2 * leaves * sizeof(int) + n );
+	if ( !t ) {
+		printf("No memory.\n");
+		return NULL;
+	}
+	t->n = n;
+	t->m = m;
+	t->words = words;
+	t->leaves = leaves;
+
+	return t;
+}
+
+/**
+ * @brief sbtree_index - build rank directory and rmM tree after bits are set.
+ *
+ * 叶子w记录E(64w+1)到E(64w+64)中的最小值，超出m的位置不计。
+ */
+static void
+sbtree_index( psbtree t )
+{
+	unsigned int *rank = sbtree_rankdir( t );
+	int *rmm = sbtree_rmm( t );
+	unsigned int r = 0;
+	int e = 0;
+	int i = 0;
+
+	for ( i = 0; i < t->words; i++ ) {
+		rank[i] = r;
+		r += sbtree_popcount( t->bits[i] );
+	}
+	rank[t->words] = r;
+	if ( !t->leaves )
+		return;
+	for ( i = 0; i < 2 * t->leaves; i++ )
+		rmm[i] = INT_MAX;
+	for ( i = 0; i < t->m; i++ ) {
+		e += sbtree_bit( t, i ) ? 1 : -1;
+		if ( e < rmm[t->leaves + ( i >> 6 )] )
+			rmm[t->leaves + ( i >> 6 )] = e;
+	}
+	for ( i = t->leaves - 1; i >= 1; i-- )
+		rmm[i] = rmm[2 * i] < rmm[2 * i + 1] ? rmm[2 * i] : rmm[2 * i + 1];
+
+	return;
+}
+
+/**
+ * @brief sbtree_close - find the last position of the subtree at p.
+ * @return the smallest j >= p with E(j+1) = E(p) - 1.
+ *
+ * 先在p所在的字内逐位向后扫描（小树一直扫描到底）；不在字内时，沿rmm向上找到右边第一个
+ * 最小超额不大于目标的兄弟，再向下找到最左的这样的叶子，在叶子内扫描。
+ */
+static int
+sbtree_close( psbtree t, int p )
+{
+	int *rmm = sbtree_rmm( t );
+	int target = sbtree_excess( t, p ) - 1;
+	int e = target + 1;
+	int k = p;
+	int i = 0;
+
+	do {
+		e += sbtree_bit( t, k ) ? 1 : -1;
+		k++;
+		if ( e <= target )
+			return k - 1;
+	} while ( ( k & 63 ) || !t->leaves );
+
+	for ( i = t->leaves + ( k >> 6 ) - 1; i > 1; i >>= 1 ) {
+		if ( !( i & 1 ) && rmm[i + 1] <= target )
+			break;
+	}
+	if ( i <= 1 )
+		return -1;
+	for ( i++; i < t->leaves; ) {
+		i = 2 * i;
+		if ( rmm[i] > target )
+			i++;
+	}
+	k = ( i - t->leaves ) * 64;
+	e = sbtree_excess( t, k );
+	for ( ;; ) {
+		e += sbtree_bit( t, k ) ? 1 : -1;
+		k++;
+		if ( e <= target )
+			return k - 1;
+	}
+}
+
+/**
+ * @brief sbtree_open - find the parent of a right child at p.
+ * @return the largest k < p with E(k) = E(p).
+ *
+ * p的前一位为0时，p之前紧挨着的是双亲的左子树，左子树内的超额都大于
+ * E(p)，向前第一个超额等于E(p)的位置就是双亲。与sbtree_close对称。
+ */
+static int
+sbtree_open( psbtree t, int p )
+{
+	int *rmm = sbtree_rmm( t );
+	int target = sbtree_excess( t, p );
+	int e = target;
+	int k = p;
+	int i = 0;
+
+	do {
+		k--;
+		e -= sbtree_bit( t, k ) ? 1 : -1;
+		if ( e <= target )
+			return k;
+	} while ( k && ( ( k & 63 ) || !t->leaves ) );
+	if ( 0 == k )
+		return -1;
+
+	i = t->leaves + ( k >> 6 ) - 1;
+	if ( rmm[i] > target ) {
+		for ( ; i > 1; i >>= 1 ) {
+			if ( ( i & 1 ) && rmm[i - 1] <= target )
+				break;
+		}
+		if ( i <= 1 )
+			return target >= 0 ? 0 : -1;
+		for ( i--; i < t->leaves; ) {
+			i = 2 * i + 1;
+			if ( rmm[i] > target )
+				i--;
+		}
+	}
+	k = ( i - t->leaves + 1 ) * 64;
+	if ( k > t->m )
+		k = t->m;
+	e = sbtree_excess( t, k );
+	for ( ; e > target; k-- )
+		e -= sbtree_bit( t, k - 1 ) ? 1 : -1;
+
+	return k;
+}
+
+/**
+ * @brief sbtree_from_preorder - creating succinct binary tree by input.
+ * @param p pointer to input string, the same as create_btree_by_preorder.
+ * @return psbtree pointer to the succinct tree,
+ *	   NULL if the string is not a complete tree or no memory.
+ *
+ * 先扫描一遍求出编码的长度，不经过链式树。
+ */
+psbtree
+sbtree_from_preorder( char *p )
+{
+	psbtree t = NULL;
+	char *data = NULL;
+	int e = 0;
+	int m = 0;
+	int i = 0;
+	int j = 0;
+
+	for ( m = 0; e >= 0; m++ ) {
+		if ( !p[m] )
+			return NULL;
+		e += '$' == p[m] ? -1 : 1;
+	}
+	t = sbtree_alloc( ( m - 1 ) / 2 );
+	if ( !t )
+		return NULL;
+	data = sbtree_chars( t );
+	for ( i = 0; i < m; i++ ) {
+		if ( '$' != p[i] ) {
+			t->bits[i >> 6] |= 1ULL << ( i & 63 );
+			data[j++] = p[i];
+		}
+	}
+	sbtree_index( t );
+
+	return t;
+}
+
+static int
+sbtree_count( pbtree proot )
+{
+	if ( !proot )
+		return 0;
+
+	return 1 + sbtree_count( proot->lc ) + sbtree_count( proot->rc );
+}
+
+static void
+sbtree_pack( psbtree t, pbtree proot, int *k, int *j )
+{
+	if ( proot ) {
+		t->bits[*k >> 6] |= 1ULL << ( *k & 63 );
+		sbtree_chars( t )[(*j)++] = proot->data;
+		(*k)++;
+		sbtree_pack( t, proot->lc, k, j );
+		sbtree_pack( t, proot->rc, k, j );
+	} else {
+		(*k)++;
+	}
+
+	return;
+}
+
+/**
+ * @brief sbtree_from_btree - convert binary tree to succinct binary tree.
+ * @param proot pointer to the root of binary tree.
+ * @return psbtree pointer to the succinct tree, NULL if no memory.
+ */
+psbtree
+sbtree_from_btree( pbtree proot )
+{
+	psbtree t = sbtree_alloc( sbtree_count( proot ) );
+	int k = 0;
+	int j = 0;
+
+	if ( !t )
+		return NULL;
+	sbtree_pack( t, proot, &k, &j );
+	sbtree_index( t );
+
+	return t;
+}
+
+static pbtree
+sbtree_unpack( psbtree t, int *k, int *j )
+{
+	pbtree proot = NULL;
+
+	if ( !sbtree_bit( t, (*k)++ ) )
+		return NULL;
+	proot = ( pbtree )malloc( sizeof(btree_node) );
+	if ( !proot ) {
+		printf("No memory.\n");
+		return proot;
+	}
+	proot->data = sbtree_chars( t )[(*j)++];
+	proot->lc = sbtree_unpack( t, k, j );
+	proot->rc = sbtree_unpack( t, k, j );
+
+	return proot;
+}
+
+/**
+ * @brief sbtree_to_btree - convert succinct binary tree to binary tree.
+ * @param t pointer to the succinct tree.
+ * @return pbtree pointer to head of binary tree.
+ */
+pbtree
+sbtree_to_btree( psbtree t )
+{
+	int k = 0;
+	int j = 0;
+
+	return sbtree_unpack( t, &k, &j );
+}
+
+/**
+ * @brief sbtree_destroy - destroy succinct binary tree, free it's space.
+ * @param t pointer to the pointer to the succinct tree.
+ * @return none.
+ */
+void
+sbtree_destroy( psbtree *t )
+{
+	free( *t );
+	*t = NULL;
+
+	return;
+}
+
+/**
+ * @brief sbtree_bytes - get the memory used by the succinct tree.
+ */
+long
+sbtree_bytes( psbtree t )
+{
+	return (long)( sbtree_chars( t ) + t->n - ( char * )t );
+}
+
+/**
+ * @brief sbtree_root - get the root of the succinct tree.
+ * @return position of the root, -1 for empty tree.
+ */
+int
+sbtree_root( psbtree t )
+{
+	return t->n ? 0 : -1;
+}
+
+/**
+ * @brief sbtree_lc - get the left child of node p.
+ * @return position of the left child, -1 for empty subtree.
+ */
+int
+sbtree_lc( psbtree t, int p )
+{
+	return sbtree_bit( t, p + 1 ) ? p + 1 : -1;
+}
+
+/**
+ * @brief sbtree_rc - get the right child of node p.
+ * @return position of the right child, -1 for empty subtree.
+ */
+int
+sbtree_rc( psbtree t, int p )
+{
+	int q = sbtree_close( t, p + 1 ) + 1;
+
+	return sbtree_bit( t, q ) ? q : -1;
+}
+
+/**
+ * @brief sbtree_parent - get the parent of node p.
+ * @return position of the parent, -1 for root.
+ */
+int
+sbtree_parent( psbtree t, int p )
+{
+	if ( p <= 0 )
+		return -1;
+	if ( sbtree_bit( t, p - 1 ) )
+		return p - 1;
+
+	return sbtree_open( t, p );
+}
+
+/**
+ * @brief sbtree_size - count the nodes of the subtree at p.
+ *
+ * k个节点的子树编码为k个1和k+1个0。
+ */
+int
+sbtree_size( psbtree t, int p )
+{
+	if ( p < 0 )
+		return 0;
+
+	return ( sbtree_close( t, p ) - p ) / 2;
+}
+
+/**
+ * @brief sbtree_data - get the char of node p.
+ */
+char
+sbtree_data( psbtree t, int p )
+{
+	return sbtree_chars( t )[sbtree_rank1( t, p )];
+}
+
+/**
+ * @brief sbtree_rank - get the preorder index of node p, the root is 0.
+ */
+int
+sbtree_rank( psbtree t, int p )
+{
+	return sbtree_rank1( t, p );
+}
+
+/**
+ * @brief sbtree_select - get the position of the k-th node in preorder.
+ * @return position of the node, -1 if k is out of range.
+ *
+ * 在rank上二分找到所在的字，再在字内逐个去掉低位的1。
+ */
+int
+sbtree_select( psbtree t, int k )
+{
+	unsigned int *rank = sbtree_rankdir( t );
+	unsigned long long x = 0;
+	int lo = 0;
+	int hi = t->words - 1;
+	int mid = 0;
+
+	if ( k < 0 || k >= t->n )
+		return -1;
+	while ( lo < hi ) {
+		mid = ( lo + hi + 1 ) / 2;
+		if ( (int)rank[mid] <= k )
+			lo = mid;
+		else
+			hi = mid - 1;
+	}
+	x = t->bits[lo];
+	for ( k -= rank[lo]; k > 0; k-- )
+		x &= x - 1;
+
+	return lo * 64 + sbtree_popcount( ( x & -x ) - 1 );
+}
+
+/**
+ * @brief sbtree_preorder_tranverse - visit succinct tree's node by D-L-R order.
+ * @param t pointer to the succinct tree.
+ * @return none.
+ *
+ * 编码本身就是先序，顺序扫描位向量即可，输出与preorder_tranverse相同。
+ */
+void
+sbtree_preorder_tranverse( psbtree t )
+{
+	char *data = sbtree_chars( t );
+	int i = 0;
+	int j = 0;
+
+	for ( i = 0; i < t->m; i++ ) {
+		if ( sbtree_bit( t, i ) )
+			printf("%c  ", data[j++]);
+		else
+			printf("$  ");
+	}
+
+	return;
+}
+
 /**
  * the tree's level relationship, "$" stands for empty subtree.
  *			A
@@ -309,11 +942,72 @@ levelorder_tranverse_nonrecursive( pbtree proot, pbtree_queue q)
  *		      $   $
  */
 
+#define INIT_SIZE 10
+#define SMALL_TREES ( 1 << 16 )
+#define SMALL_NODES 32
+
+/**
+ * @brief random_preorder - write a random tree of n nodes in preorder.
+ */
+static void
+random_preorder( char *buf, int *pos, int n )
+{
+	int l = 0;
+
+	if ( !n ) {
+		buf[(*pos)++] = '$';
+		return;
+	}
+	buf[(*pos)++] = 'A' + rand() % 26;
+	l = rand() % n;
+	random_preorder( buf, pos, l );
+	random_preorder( buf, pos, n - 1 - l );
+
+	return;
+}
+
+/**
+ * @brief small_trees - compare the memory of many small trees.
+ */
+static void
+small_trees( void )
+{
+	char buf[2 * SMALL_NODES + 2];
+	psbtree t = NULL;
+	long linked = 0;
+	long succinct = 0;
+	int pos = 0;
+	int i = 0;
+
+	for ( i = 0; i < SMALL_TREES; i++ ) {
+		pos = 0;
+		random_preorder( buf, &pos, SMALL_NODES );
+		buf[pos] = '\0';
+		t = sbtree_from_preorder( buf );
+		if ( !t )
+			return;
+		linked += t->n * (long)sizeof(btree_node);
+		succinct += sbtree_bytes( t );
+		sbtree_destroy( &t );
+	}
+	printf("%d trees of %d nodes: linked %ld bytes, succinct %ld bytes.\n",
+		SMALL_TREES, SMALL_NODES, linked, succinct);
+
+	return;
+}
+
 int
 main()
 {
 	char *s = "ABC$$DE$G$$F$$$";
+	char *pre = s;
+	psbtree stree = NULL;
+	int p = 0;
+	char level[] = "AB$CD$$$$EF$$$$$$$G";
 	pbtree proot = NULL;
+	ibtree itree;
+	int count = 0;
+	int i = 0;
 	btree_queue queue_recursive;
 	btree_queue queue_nonrecursive;
 
@@ -335,6 +1029,56 @@ main()
 	btree_queue_init( &queue_nonrecursive );
 	levelorder_tranverse_nonrecursive( proot, &queue_nonrecursive);
 	printf("\n");
+	destroy_btree( &proot );
+
+	/* 先序序列直接建成简洁树，逐个节点查看双亲、孩子和子树大小 */
+	stree = sbtree_from_preorder( pre );
+	if ( !stree )
+		return 1;
+	sbtree_preorder_tranverse( stree );
+	printf("\n");
+	for ( i = 0; i < stree->n; i++ ) {
+		p = sbtree_select( stree, i );
+		printf("%c: parent %c, lc %c, rc %c, size %d\n", sbtree_data( stree, p ),
+			sbtree_parent( stree, p ) < 0 ? '$' : sbtree_data( stree, sbtree_parent( stree, p ) ),
+			sbtree_lc( stree, p ) < 0 ? '$' : sbtree_data( stree, sbtree_lc( stree, p ) ),
+			sbtree_rc( stree, p ) < 0 ? '$' : sbtree_data( stree, sbtree_rc( stree, p ) ),
+			sbtree_size( stree, p ));
+	}
+	proot = sbtree_to_btree( stree );
+	preorder_tranverse( proot );
+	printf("\n");
+	destroy_btree( &proot );
+	sbtree_destroy( &stree );
+
+	/* 同一棵树的层次序列，分别建成链式树和隐式树 */
+	proot = create_btree_by_level( level, 1 );
+	btree_queue_init( &queue_nonrecursive );
+	levelorder_tranverse_nonrecursive( proot, &queue_nonrecursive);
+	printf("\n");
+	ibtree_init( &itree, level );
+	ibtree_levelorder( &itree );
+	printf("\n");
+	ibtree_preorder( &itree, 1 );
+	printf("\n");
+	ibtree_inorder( &itree, 1 );
+	printf("\n");
+	ibtree_postorder( &itree, 1 );
+	printf("\n");
+	for ( i = 1; i <= itree.n; i++ )
+		count += ibtree_exists( &itree, i );
+	printf("linked: %d nodes of %d bytes, implicit: %d bytes.\n",
+		count, (int)sizeof(btree_node), itree.n);
+	stree = sbtree_from_btree( proot );
+	if ( stree ) {
+		sbtree_preorder_tranverse( stree );
+		printf("\nsuccinct: %ld bytes.\n", sbtree_bytes( stree ));
+		sbtree_destroy( &stree );
+	}
+	destroy_btree( &proot );
+
+	srand( (unsigned int)time(NULL) );
+	small_trees();
 
 	return 0;
 }
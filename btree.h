@@ -44,3 +44,77 @@ pbtree btree_queue_delete( pbtree_queue q);
 
 void levelorder_tranverse_recursive( pbtree proot, pbtree_queue q);
 void levelorder_tranverse_nonrecursive( pbtree proot, pbtree_queue q);
+
+/**
+ * @brief define the implicit binary tree and it's basic oprations
+ *
+ * 隐式二叉树：直接以create_btree_by_level使用的按层次排列的字符数组
+ * 作为树本身，下标从1开始，下标为i的节点存放在data[i-1]，左孩子为2i，
+ * 右孩子为2i+1，双亲为i/2，'$'表示空子树。
+ * 不需要孩子指针，不分配内存（btree_node每个1字节的字符要占24字节），
+ * 各种遍历都只做下标运算，按层次遍历就是顺序扫描数组，不需要队列。
+ * 适合完全或接近完全的二叉树；树越稀疏，数组中占位的'$'越多。
+ */
+#define IBT_LC(i)	( 2 * (i) )
+#define IBT_RC(i)	( 2 * (i) + 1 )
+#define IBT_PARENT(i)	( (i) / 2 )
+
+typedef struct _implicit_binary_tree {
+	char *data;	/* 按层次排列的节点，不复制 */
+	int n;		/* 数组长度 */
+}ibtree, *pibtree;
+
+int ibtree_init( pibtree t, char *p );
+int ibtree_exists( pibtree t, int i );
+void ibtree_preorder( pibtree t, int i );
+void ibtree_inorder( pibtree t, int i );
+void ibtree_postorder( pibtree t, int i );
+void ibtree_levelorder( pibtree t );
+
+/**
+ * @brief define the succinct binary tree and it's basic oprations
+ *
+ * 简洁二叉树：与create_btree_by_preorder的输入一样按先序编码树的形状，
+ * 节点记为1，空子树记为0，n个节点共2n+1位，节点的字符按先序紧凑存放。
+ * 以位的下标作为节点的句柄，-1表示空：
+ *	左孩子	紧跟在节点之后
+ *	子树	从节点开始，到超额（1记+1，0记-1）第一次降为-1为止
+ *	右孩子	紧跟在左子树之后
+ *	双亲	前一位为1时就是它，否则向前找超额与自身相同的第一个位置
+ * rank为每字的累计1的个数，rmm为以字为叶子的区间最小超额树（rmM树），
+ * 前后搜索在字内逐位扫描，跨字时由rmm直接找到目标所在的字，
+ * 跨字的搜索为O(log(n/64))步；不超过SBT_SCAN_WORDS个字的小树不建rmm，
+ * 直接逐位扫描，各种操作都是常数时间。
+ * 头部、位向量、目录和字符放在同一次分配的内存中，每个节点约占
+ * 1字节字符加5位，而btree_node每个要占24字节，还有malloc的开销。
+ */
+#define SBT_SCAN_WORDS 4
+
+typedef struct _succinct_btree {
+	int n;			/* 节点数 */
+	int m;			/* 位数，2n+1 */
+	int words;		/* 位向量的字数 */
+	int leaves;		/* rmm的叶子数，2的幂，小树为0 */
+	unsigned long long bits[];
+	/*
+	 * 紧接着位向量依次存放：
+	 * unsigned int rank[words+1]	rank[w]为前w个字中1的个数
+	 * int rmm[2*leaves]		rmm[leaves+w]为第w个字内的最小超额
+	 * char data[n]			先序排列的字符
+	 */
+}sbtree, *psbtree;
+
+psbtree sbtree_from_preorder( char *p );
+psbtree sbtree_from_btree( pbtree proot );
+pbtree sbtree_to_btree( psbtree t );
+void sbtree_destroy( psbtree *t );
+long sbtree_bytes( psbtree t );
+int sbtree_root( psbtree t );
+int sbtree_lc( psbtree t, int p );
+int sbtree_rc( psbtree t, int p );
+int sbtree_parent( psbtree t, int p );
+int sbtree_size( psbtree t, int p );
+char sbtree_data( psbtree t, int p );
+int sbtree_rank( psbtree t, int p );
+int sbtree_select( psbtree t, int k );
+void sbtree_preorder_tranverse( psbtree t );
@@ -0,0 +1,713 @@
+/**
+ * @file cbbstree.c
+ * @brief realize concurrent balance binary search tree's basic oprations.
+ * @author watertiger <darkwkt@gmail.com>
+ * @date 2026-10-19
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include <sched.h>
+
+#include "cbbstree.h"
+
+#define INIT_SIZE 10
+
+#define CBBST_LOAD(x) __atomic_load_n( &(x), __ATOMIC_ACQUIRE )
+#define CBBST_STORE(x, v) __atomic_store_n( &(x), (v), __ATOMIC_RELEASE )
+#define CBBST_CHILD(n, dir) ( *( (dir) ? &(n)->rc : &(n)->lc ) )
+
+/**
+ * @brief cbbst_read_lock - read node's version for optimistic access.
+ * @param n pointer to the node.
+ * @param restart set to 1 if node is locked or obsolete.
+ * @return the version.
+ */
+static inline unsigned long long
+cbbst_read_lock( pcbbst n, int *restart )
+{
+	unsigned long long v = CBBST_LOAD( n->version );
+
+	if ( v & ( CBBST_LOCKED | CBBST_OBSOLETE ) )
+		*restart = 1;
+
+	return v;
+}
+
+/**
+ * @brief cbbst_validate - check node's version is not changed since read.
+ * @return 1 for unchanged,
+ *	   0 for changed.
+ */
+static inline int
+cbbst_validate( pcbbst n, unsigned long long v )
+{
+	__atomic_thread_fence( __ATOMIC_ACQUIRE );
+
+	return __atomic_load_n( &n->version, __ATOMIC_RELAXED ) == v;
+}
+
+/**
+ * @brief cbbst_upgrade - lock node only if it's version is still v.
+ * @return 1 for locked,
+ *	   0 for version changed.
+ */
+static inline int
+cbbst_upgrade( pcbbst n, unsigned long long v )
+{
+	return __atomic_compare_exchange_n( &n->version, &v, v | CBBST_LOCKED, 0,
+					    __ATOMIC_ACQUIRE, __ATOMIC_RELAXED );
+}
+
+/**
+ * @brief cbbst_backoff - wait a while before retrying a lock.
+ * @param spins pointer to the count of pause in this round, doubled each time.
+ *
+ * pause告诉处理器这是自旋等待，减少流水线清空和对持锁核心的干扰；
+ * 等待较久时持锁线程可能已被换出，让出处理器。
+ */
+static inline void
+cbbst_backoff( int *spins )
+{
+	int i = 0;
+
+	if ( *spins > CBBST_SPIN_MAX ) {
+		sched_yield();
+		return;
+	}
+	for ( i = 0; i < *spins; i++ ) {
+#if defined(__x86_64__) || defined(__i386__)
+		__builtin_ia32_pause();
+#elif defined(__aarch64__)
+		__asm__ __volatile__( "yield" );
+#else
+		__atomic_thread_fence( __ATOMIC_SEQ_CST );
+#endif
+	}
+	*spins *= 2;
+}
+
+/**
+ * @brief cbbst_lock - lock node, wait if it's locked by other writer.
+ * @return 1 for locked,
+ *	   0 for node is obsolete (not locked).
+ */
+static inline int
+cbbst_lock( pcbbst n )
+{
+	unsigned long long v = 0;
+	int spins = 1;
+
+	for ( ; ; ) {
+		v = __atomic_load_n( &n->version, __ATOMIC_RELAXED );
+		if ( v & CBBST_OBSOLETE )
+			return 0;
+		if ( !( v & CBBST_LOCKED ) && cbbst_upgrade( n, v ) )
+			return 1;
+		cbbst_backoff( &spins );
+	}
+}
+
+/**
+ * @brief cbbst_unlock - unlock node and bump it's version.
+ *
+ * 节点的链接或present被修改过，必须增加版本号使读者重新开始。
+ */
+static inline void
+cbbst_unlock( pcbbst n )
+{
+	CBBST_STORE( n->version, ( CBBST_LOAD( n->version ) & ~CBBST_LOCKED ) + CBBST_VSTEP );
+}
+
+/**
+ * @brief cbbst_unlock_unchanged - unlock node without bumping it's version.
+ *
+ * 只修改了高度或什么也没改，读者不读取高度，不必使读者重新开始。
+ */
+static inline void
+cbbst_unlock_unchanged( pcbbst n )
+{
+	CBBST_STORE( n->version, CBBST_LOAD( n->version ) & ~CBBST_LOCKED );
+}
+
+/**
+ * @brief cbbst_unlock_obsolete - unlock a node which is unlinked from tree.
+ */
+static inline void
+cbbst_unlock_obsolete( pcbbst n )
+{
+	CBBST_STORE( n->version, ( ( CBBST_LOAD( n->version ) & ~CBBST_LOCKED ) | CBBST_OBSOLETE ) + CBBST_VSTEP );
+}
+
+/**
+ * @brief cbbst_h - height of subtree, 0 for empty.
+ */
+static inline int
+cbbst_h( pcbbst n )
+{
+	return n ? __atomic_load_n( &n->height, __ATOMIC_RELAXED ) : 0;
+}
+
+/**
+ * @brief cbbst_update_height - recompute height of a locked node.
+ * @return the new height.
+ */
+static inline int
+cbbst_update_height( pcbbst n )
+{
+	int hl = cbbst_h( n->lc );
+	int hr = cbbst_h( n->rc );
+	int h = ( hl > hr ? hl : hr ) + 1;
+
+	__atomic_store_n( &n->height, h, __ATOMIC_RELAXED );
+
+	return h;
+}
+
+/**
+ * @brief cbbst_free_node - free function used by epoch reclamation.
+ */
+static void
+cbbst_free_node( void *p )
+{
+	free( p );
+}
+
+/**
+ * @brief cbbst_init - initialize an empty concurrent balance binary search tree.
+ * @param t pointer to the tree.
+ * @return 1 for succeed.
+ */
+int
+cbbst_init( pcbbst_tree t )
+{
+	memset( &t->holder, 0, sizeof(t->holder) );
+	epoch_init( &t->ed );
+
+	return 1;
+}
+
+/**
+ * @brief cbbst_thread_init - register current thread before accessing the tree.
+ * @param t pointer to the tree.
+ * @param r pointer to the thread's epoch record.
+ * @return 1 for succeed,
+ *	   0 for failure.
+ */
+int
+cbbst_thread_init( pcbbst_tree t, pepoch_record r )
+{
+	return epoch_register( &t->ed, r );
+}
+
+/**
+ * @brief cbbst_thread_exit - unregister current thread, free it's retired nodes.
+ * @param r pointer to the thread's epoch record.
+ * @return none.
+ */
+void
+cbbst_thread_exit( pepoch_record r )
+{
+	epoch_unregister( r );
+}
+
+/**
+ * @brief cbbst_search - searching key in concurrent balance binary search tree.
+ * @param t pointer to the tree.
+ * @param r pointer to the thread's epoch record.
+ * @param key the enum to search.
+ * @return 1 for found,
+ *	   0 for not found.
+ *
+ * 读者只读取版本号并校验，版本变化时从根重新开始，不加锁。
+ */
+int
+cbbst_search( pcbbst_tree t, pepoch_record r, int key )
+{
+	pcbbst p = NULL;
+	pcbbst n = NULL;
+	unsigned long long vp = 0;
+	unsigned long long vn = 0;
+	int restart = 0;
+	int present = 0;
+
+	epoch_enter( r );
+restart:
+	restart = 0;
+	p = &t->holder;
+	vp = cbbst_read_lock( p, &restart );
+	if ( restart )
+		goto restart;
+	n = CBBST_LOAD( p->rc );
+	for ( ; n; ) {
+		vn = cbbst_read_lock( n, &restart );
+		if ( restart || !cbbst_validate( p, vp ) )
+			goto restart;
+		if ( key == n->data ) {
+			present = CBBST_LOAD( n->present );
+			if ( !cbbst_validate( n, vn ) )
+				goto restart;
+			epoch_exit( r );
+			return present;
+		}
+		p = n;
+		vp = vn;
+		n = CBBST_LOAD( CBBST_CHILD( n, n->data < key ) );
+	}
+	if ( !cbbst_validate( p, vp ) )
+		goto restart;
+	epoch_exit( r );
+
+	return 0;
+}
+
+/**
+ * @brief cbbst_fix - rebalance node under it's parent after node's subtree changed.
+ * @param rec pointer to the thread's epoch record.
+ * @param parent pointer to the parent recorded on the search path.
+ * @param pn pointer to the node.
+ * @return 1 for node's height may be changed, continue with parent,
+ *	   0 for stopping.
+ *
+ * 依次锁住双亲、当前节点，以及旋转涉及的孩子和孙子节点：
+ *	1、当前节点为路由节点且孩子不足两个，直接摘除；
+ *	2、左右子树高度差超过1，做LL/LR或RR/RL旋转，与left_balance、
+ *	   right_balance的四种情形相同；
+ *	3、否则只更新高度，高度不变时停止。
+ * 双亲已不再指向当前节点时，说明路径已被其他写者改变，放弃调整。
+ */
+static int
+cbbst_fix( pepoch_record rec, pcbbst parent, pcbbst pn )
+{
+	pcbbst l = NULL;
+	pcbbst r = NULL;
+	pcbbst c = NULL;	/* 较高的孩子 */
+	pcbbst g = NULL;	/* 双旋时的孙子 */
+	pcbbst top = NULL;	/* 旋转后的子树根 */
+	int dir = 0;
+	int cdir = 0;
+	int hl = 0;
+	int hr = 0;
+	int oldh = 0;
+
+	if ( !cbbst_lock( parent ) )
+		return 0;
+	if ( parent->rc == pn ) {
+		dir = 1;
+	} else if ( parent->lc != pn ) {
+		cbbst_unlock_unchanged( parent );
+		return 0;
+	}
+	if ( !cbbst_lock( pn ) ) {
+		cbbst_unlock_unchanged( parent );
+		return 0;
+	}
+	l = pn->lc;
+	r = pn->rc;
+	if ( !pn->present && ( !l || !r ) ) {
+		CBBST_STORE( CBBST_CHILD( parent, dir ), l ? l : r );
+		cbbst_unlock_obsolete( pn );
+		cbbst_unlock( parent );
+		epoch_retire( rec, pn, cbbst_free_node );
+		return 1;
+	}
+	hl = cbbst_h( l );
+	hr = cbbst_h( r );
+	if ( hl - hr <= 1 && hr - hl <= 1 ) {
+		oldh = pn->height;
+		if ( cbbst_update_height( pn ) == oldh ) {
+			cbbst_unlock_unchanged( pn );
+			cbbst_unlock_unchanged( parent );
+			return 0;
+		}
+		cbbst_unlock_unchanged( pn );
+		cbbst_unlock_unchanged( parent );
+		return 1;
+	}
+
+	/* cdir为较高孩子的方向，旋转方向与之相反 */
+	cdir = ( hr > hl );
+	c = cdir ? r : l;
+	cbbst_lock( c );	/* c由已加锁的pn指向，不可能被废弃 */
+	g = CBBST_CHILD( c, !cdir );
+	if ( cbbst_h( g ) > cbbst_h( CBBST_CHILD( c, cdir ) ) ) {
+		/* LR型或RL型，双旋 */
+		cbbst_lock( g );
+		CBBST_STORE( CBBST_CHILD( c, !cdir ), CBBST_CHILD( g, cdir ) );
+		CBBST_STORE( CBBST_CHILD( pn, cdir ), CBBST_CHILD( g, !cdir ) );
+		CBBST_STORE( CBBST_CHILD( g, cdir ), c );
+		CBBST_STORE( CBBST_CHILD( g, !cdir ), pn );
+		cbbst_update_height( c );
+		cbbst_update_height( pn );
+		cbbst_update_height( g );
+		top = g;
+	} else {
+		/* LL型或RR型，单旋 */
+		g = NULL;
+		CBBST_STORE( CBBST_CHILD( pn, cdir ), CBBST_CHILD( c, !cdir ) );
+		CBBST_STORE( CBBST_CHILD( c, !cdir ), pn );
+		cbbst_update_height( pn );
+		cbbst_update_height( c );
+		top = c;
+	}
+	CBBST_STORE( CBBST_CHILD( parent, dir ), top );
+	if ( g )
+		cbbst_unlock( g );
+	cbbst_unlock( c );
+	cbbst_unlock( pn );
+	cbbst_unlock( parent );
+
+	return 1;
+}
+
+/**
+ * @brief cbbst_rebalance - rebalance along the recorded search path bottom-up.
+ * @param r pointer to the thread's epoch record.
+ * @param path the nodes from holder to the parent of changed position.
+ * @param depth the number of nodes in path.
+ * @return none.
+ */
+static void
+cbbst_rebalance( pepoch_record r, pcbbst *path, int depth )
+{
+	int i = 0;
+
+	for ( i = depth - 1; i > 0; i-- ) {
+		if ( !cbbst_fix( r, path[i - 1], path[i] ) )
+			break;
+	}
+
+	return;
+}
+
+/**
+ * @brief cbbst_insert - insert an enum into concurrent balance binary search tree.
+ * @param t pointer to the tree.
+ * @param r pointer to the thread's epoch record.
+ * @param e the enum to insert.
+ * @return 1 for succeed,
+ *	   0 for failure.
+ *
+ * 乐观地查找插入位置并记录路径，只锁住插入位置的双亲，版本变化则重新开始。
+ * 找到的是路由节点时，重新置为存在即可。新节点在查找前分配，重新开始时复用。
+ */
+int
+cbbst_insert( pcbbst_tree t, pepoch_record r, int e )
+{
+	pcbbst path[CBBST_MAX_DEPTH];
+	pcbbst p = NULL;
+	pcbbst n = NULL;
+	pcbbst pe = NULL;
+	unsigned long long vp = 0;
+	unsigned long long vn = 0;
+	int depth = 0;
+	int dir = 1;
+	int restart = 0;
+
+	pe = ( pcbbst )malloc( sizeof( cbbst_node ) );
+	if ( !pe ) {
+		printf("No Memory!!\n");
+		return 0;
+	}
+	pe->data = e;
+	pe->height = 1;
+	pe->present = 1;
+	pe->version = 0;
+	pe->lc = NULL;
+	pe->rc = NULL;
+
+	epoch_enter( r );
+restart:
+	restart = 0;
+	depth = 0;
+	dir = 1;
+	p = &t->holder;
+	vp = cbbst_read_lock( p, &restart );
+	if ( restart )
+		goto restart;
+	path[depth++] = p;
+	n = CBBST_LOAD( p->rc );
+	for ( ; n; ) {
+		vn = cbbst_read_lock( n, &restart );
+		if ( restart || !cbbst_validate( p, vp ) )
+			goto restart;
+		if ( e == n->data ) {
+			if ( CBBST_LOAD( n->present ) ) {
+				if ( !cbbst_validate( n, vn ) )
+					goto restart;
+				epoch_exit( r );
+				free( pe );
+				return 0;
+			}
+			if ( !cbbst_upgrade( n, vn ) )
+				goto restart;
+			CBBST_STORE( n->present, 1 );
+			cbbst_unlock( n );
+			epoch_exit( r );
+			free( pe );
+			return 1;
+		}
+		dir = ( n->data < e );
+		if ( depth < CBBST_MAX_DEPTH )
+			path[depth++] = n;
+		p = n;
+		vp = vn;
+		n = CBBST_LOAD( CBBST_CHILD( n, dir ) );
+	}
+	if ( !cbbst_upgrade( p, vp ) )
+		goto restart;
+	CBBST_STORE( CBBST_CHILD( p, dir ), pe );
+	cbbst_unlock( p );
+	if ( path[depth - 1] == p )
+		cbbst_rebalance( r, path, depth );
+	epoch_exit( r );
+
+	return 1;
+}
+
+/**
+ * @brief cbbst_delete - delete an enum from concurrent balance binary search tree.
+ * @param t pointer to the tree.
+ * @param r pointer to the thread's epoch record.
+ * @param key the enum to delete.
+ * @return 1 for succeed,
+ *	   0 for failure.
+ *
+ * 被删节点左右子树都存在时置为路由节点，否则锁住双亲和被删节点后摘除，
+ * 并从双亲开始调整平衡。
+ */
+int
+cbbst_delete( pcbbst_tree t, pepoch_record r, int key )
+{
+	pcbbst path[CBBST_MAX_DEPTH];
+	pcbbst p = NULL;
+	pcbbst n = NULL;
+	pcbbst l = NULL;
+	pcbbst rc = NULL;
+	unsigned long long vp = 0;
+	unsigned long long vn = 0;
+	int depth = 0;
+	int dir = 1;
+	int restart = 0;
+
+	epoch_enter( r );
+restart:
+	restart = 0;
+	depth = 0;
+	dir = 1;
+	p = &t->holder;
+	vp = cbbst_read_lock( p, &restart );
+	if ( restart )
+		goto restart;
+	path[depth++] = p;
+	n = CBBST_LOAD( p->rc );
+	for ( ; n && key != n->data; ) {
+		vn = cbbst_read_lock( n, &restart );
+		if ( restart || !cbbst_validate( p, vp ) )
+			goto restart;
+		dir = ( n->data < key );
+		if ( depth < CBBST_MAX_DEPTH )
+			path[depth++] = n;
+		p = n;
+		vp = vn;
+		n = CBBST_LOAD( CBBST_CHILD( n, dir ) );
+	}
+	if ( !n ) {
+		if ( !cbbst_validate( p, vp ) )
+			goto restart;
+		epoch_exit( r );
+		return 0;
+	}
+	vn = cbbst_read_lock( n, &restart );
+	if ( restart || !cbbst_validate( p, vp ) )
+		goto restart;
+	if ( !CBBST_LOAD( n->present ) ) {
+		if ( !cbbst_validate( n, vn ) )
+			goto restart;
+		epoch_exit( r );
+		return 0;
+	}
+	l = CBBST_LOAD( n->lc );
+	rc = CBBST_LOAD( n->rc );
+	if ( l && rc ) {
+		if ( !cbbst_upgrade( n, vn ) )
+			goto restart;
+		CBBST_STORE( n->present, 0 );
+		cbbst_unlock( n );
+		epoch_exit( r );
+		return 1;
+	}
+	if ( !cbbst_upgrade( p, vp ) )
+		goto restart;
+	if ( !cbbst_upgrade( n, vn ) ) {
+		cbbst_unlock_unchanged( p );
+		goto restart;
+	}
+	CBBST_STORE( CBBST_CHILD( p, dir ), l ? l : rc );
+	cbbst_unlock_obsolete( n );
+	cbbst_unlock( p );
+	epoch_retire( r, n, cbbst_free_node );
+	if ( path[depth - 1] == p )
+		cbbst_rebalance( r, path, depth );
+	epoch_exit( r );
+
+	return 1;
+}
+
+/**
+ * @brief cbbst_free - free a subtree recursively.
+ */
+static void
+cbbst_free( pcbbst n )
+{
+	if ( n ) {
+		cbbst_free( n->lc );
+		cbbst_free( n->rc );
+		free( n );
+	}
+}
+
+/**
+ * @brief cbbst_destroy - destroy the tree, free all nodes.
+ * @param t pointer to the tree.
+ * @return 0 for success.
+ *
+ * 调用前所有线程都必须已经调用cbbst_thread_exit，被摘除的节点已由
+ * 各线程释放。
+ */
+int
+cbbst_destroy( pcbbst_tree t )
+{
+	cbbst_free( t->holder.rc );
+	t->holder.rc = NULL;
+
+	return 0;
+}
+
+/**
+ * @brief cbbst_height - the height of tree, used for checking balance.
+ * @param t pointer to the tree.
+ * @return the height.
+ */
+int
+cbbst_height( pcbbst_tree t )
+{
+	return cbbst_h( t->holder.rc );
+}
+
+/* 多线程混合负载测试 */
+#define BENCH_KEYS	( 1 << 16 )
+#define BENCH_OPS	( 1 << 20 )
+#define BENCH_THREADS	8
+
+typedef struct _bench_arg {
+	pcbbst_tree t;
+	unsigned int seed;
+	int update_pct;
+	long reads;
+}bench_arg;
+
+/**
+ * @brief bench_worker - run a mixed search/insert/delete workload.
+ */
+static void *
+bench_worker( void *arg )
+{
+	bench_arg *pa = ( bench_arg * )arg;
+	epoch_record rec;
+	unsigned int x = pa->seed;
+	int i = 0;
+	int key = 0;
+	int op = 0;
+
+	if ( !cbbst_thread_init( pa->t, &rec ) )
+		return NULL;
+	for ( i = 0; i < BENCH_OPS; i++ ) {
+		x = x * 1103515245 + 12345;
+		key = ( x >> 8 ) % ( 2 * BENCH_KEYS );
+		op = ( x >> 4 ) % 100;
+		if ( op >= pa->update_pct ) {
+			cbbst_search( pa->t, &rec, key );
+			pa->reads++;
+		} else if ( op & 1 ) {
+			cbbst_insert( pa->t, &rec, key );
+		} else {
+			cbbst_delete( pa->t, &rec, key );
+		}
+	}
+	cbbst_thread_exit( &rec );
+
+	return NULL;
+}
+
+/**
+ * @brief bench_run - run the workload with n threads and show throughput.
+ */
+static void
+bench_run( pcbbst_tree t, int n, int update_pct )
+{
+	pthread_t tid[BENCH_THREADS];
+	bench_arg args[BENCH_THREADS];
+	struct timespec t0;
+	struct timespec t1;
+	double sec = 0;
+	long reads = 0;
+	int i = 0;
+
+	clock_gettime( CLOCK_MONOTONIC, &t0 );
+	for ( i = 0; i < n; i++ ) {
+		args[i].t = t;
+		args[i].seed = i * 7919 + 1;
+		args[i].update_pct = update_pct;
+		args[i].reads = 0;
+		pthread_create( &tid[i], NULL, bench_worker, &args[i] );
+	}
+	for ( i = 0; i < n; i++ ) {
+		pthread_join( tid[i], NULL );
+		reads += args[i].reads;
+	}
+	clock_gettime( CLOCK_MONOTONIC, &t1 );
+	sec = ( t1.tv_sec - t0.tv_sec ) + ( t1.tv_nsec - t0.tv_nsec ) / 1e9;
+	printf("threads:%d updates:%2d%%  %.2f Mops/s, reads %.2f Mops/s, height %d\n",
+	       n, update_pct, n * (double)BENCH_OPS / sec / 1e6, reads / sec / 1e6,
+	       cbbst_height( t ) );
+}
+
+int
+main()
+{
+	int array[INIT_SIZE];
+	int i = 0;
+	cbbst_tree tree;
+	epoch_record rec;
+
+	srand( (unsigned int)time(NULL) );
+	cbbst_init( &tree );
+	cbbst_thread_init( &tree, &rec );
+	for ( i = 0; i < INIT_SIZE; i++ ) {
+		array[i] = rand() % 100;
+		printf("%-4d", array[i]);
+		cbbst_insert( &tree, &rec, array[i] );
+	}
+	printf("\n");
+	printf("%d %s.\n", array[5], cbbst_search( &tree, &rec, array[5] ) ? "found" : "not exists");
+	cbbst_delete( &tree, &rec, array[5] );
+	printf("%d %s.\n", array[5], cbbst_search( &tree, &rec, array[5] ) ? "found" : "not exists");
+	cbbst_thread_exit( &rec );
+	cbbst_destroy( &tree );
+
+	cbbst_init( &tree );
+	cbbst_thread_init( &tree, &rec );
+	for ( i = 0; i < BENCH_KEYS; i++ )
+		cbbst_insert( &tree, &rec, 2 * i );
+	cbbst_thread_exit( &rec );
+	for ( i = 1; i <= BENCH_THREADS; i *= 2 )
+		bench_run( &tree, i, 10 );
+	for ( i = 1; i <= BENCH_THREADS; i *= 2 )
+		bench_run( &tree, i, 50 );
+	cbbst_destroy( &tree );
+
+	return 0;
+}
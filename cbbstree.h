@@ -0,0 +1,64 @@
+/**
+ * @file cbbstree.h
+ * @brief describe concurrent balance binary search tree's defination and basic oprations.
+ * @author watertiger <darkwkt@gmail.com>
+ * @date 2026-10-19
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+
+#include "epoch.h"
+
+/**
+ * @brief define the concurrent balanced binary search tree node and it's basic oprations
+ *
+ * 可并发访问的平衡二叉树（AVL树），采用乐观锁耦合(Optimistic Lock Coupling)：
+ *	每个节点带一个版本锁，最低位为写锁标志，次低位为废弃标志，其余为版本号。
+ *	读者不加锁，只在读取孩子指针前后检查节点版本，并在进入孩子节点后再次
+ *	检查双亲的版本（锁耦合），发现版本变化就从根重新开始，因此读者从不阻塞，
+ *	也不写任何共享内存。
+ *	写者乐观地查找到插入位置，只锁住被修改的双亲节点；插入后自底向上调整
+ *	平衡，每次只锁住旋转实际涉及的双亲、当前节点、孩子（及孙子）节点，
+ *	加锁顺序总是自上而下，不会死锁。
+ *
+ * 并发时无法维护平衡因子，因此节点保存的是高度。左右子树都存在的节点被删除时
+ * 只置为"路由节点"(present为0)，之后在调整平衡时若它的孩子不足两个再摘除。
+ * 某个写者调整平衡时若发现路径已被其他写者改变，会放弃本次调整，平衡由之后
+ * 经过该路径的更新恢复（松弛平衡），树始终是正确的二叉排序树。
+ * 被摘除的节点（包括被摘除的路由节点）可能仍被读者或其他写者访问，由epoch.h的
+ * 纪元回收机制延迟释放，占用的内存与树的大小成正比，而不是与更新次数成正比。
+ * 写者等待节点上的锁时先用pause自旋，次数按倍数增加，超过CBBST_SPIN_MAX后
+ * 让出处理器。
+ *
+ * 每个访问树的线程需要先调用cbbst_thread_init获得自己的纪元记录，
+ * 退出前调用cbbst_thread_exit。编译时需要 -pthread。
+ */
+#define CBBST_LOCKED	1ULL
+#define CBBST_OBSOLETE	2ULL
+#define CBBST_VSTEP	4ULL
+
+#define CBBST_MAX_DEPTH	128
+#define CBBST_SPIN_MAX	64	/* 等待锁时连续pause的最大次数 */
+
+typedef struct _concurrent_bbst {
+	int data;
+	int height;
+	int present;	/* 0 for routing node */
+	unsigned long long version;
+	struct _concurrent_bbst *lc, *rc;/* left and right child pointer */
+}cbbst_node, *pcbbst;
+
+typedef struct _concurrent_bbst_tree {
+	cbbst_node holder;	/* holder.rc is the root */
+	epoch_domain ed;
+}cbbst_tree, *pcbbst_tree;
+
+int cbbst_init( pcbbst_tree t );
+int cbbst_thread_init( pcbbst_tree t, pepoch_record r );
+void cbbst_thread_exit( pepoch_record r );
+int cbbst_search( pcbbst_tree t, pepoch_record r, int key );
+int cbbst_insert( pcbbst_tree t, pepoch_record r, int e );
+int cbbst_delete( pcbbst_tree t, pepoch_record r, int key );
+int cbbst_destroy( pcbbst_tree t );
+int cbbst_height( pcbbst_tree t );
@@ -0,0 +1,268 @@
+/**
+ * @file epoch.h
+ * @brief describe epoch based reclamation used by concurrent trees.
+ * @author watertiger <darkwkt@gmail.com>
+ * @date 2026-10-19
+ */
+#ifndef _EPOCH_H
+#define _EPOCH_H
+
+#include <stdio.h>
+#include <stdlib.h>
+
+/**
+ * @brief define the epoch domain and it's basic oprations
+ *
+ * 基于纪元的内存回收（Epoch Based Reclamation）：
+ *	每个线程访问共享结构前调用epoch_enter，宣布自己处于全局纪元e；
+ *	访问结束后调用epoch_exit。
+ *	从结构中摘除的节点不能立即释放，调用epoch_retire记入本线程的待回收表，
+ *	并标记摘除时的全局纪元s。
+ *	只有所有活跃线程都已进入当前全局纪元时，全局纪元才能加1。全局纪元达到
+ *	s+2时，摘除之前进入的线程必然都已退出，节点可以安全释放。
+ * 待回收表按纪元分为3个，由各线程私有，释放时不需要同步。
+ *
+ * 本文件只包含静态函数，可以被多个模块直接包含。编译时需要 -pthread。
+ */
+#define EPOCH_MAX_THREADS	64
+#define EPOCH_FREQ		64	/* retire次数达到该值时尝试推进纪元 */
+
+typedef struct _epoch_slot {
+	unsigned long state;	/* (local epoch << 1) | active */
+	int used;
+	char pad[64 - sizeof(unsigned long) - sizeof(int)];
+}epoch_slot;
+
+typedef struct _epoch_domain {
+	unsigned long global;
+	char pad[64 - sizeof(unsigned long)];
+	epoch_slot slot[EPOCH_MAX_THREADS];
+}epoch_domain, *pepoch_domain;
+
+typedef struct _epoch_limbo {
+	unsigned long epoch;
+	void **ptr;
+	void (**fn)( void * );
+	long num;
+	long cap;
+}epoch_limbo;
+
+typedef struct _epoch_record {
+	pepoch_domain d;
+	int id;
+	unsigned long local;
+	long retired;
+	epoch_limbo limbo[3];
+}epoch_record, *pepoch_record;
+
+/**
+ * @brief epoch_init - initialize an epoch domain.
+ * @param d pointer to the domain.
+ * @return none.
+ */
+static inline void
+epoch_init( pepoch_domain d )
+{
+	int i = 0;
+
+	d->global = 2;
+	for ( i = 0; i < EPOCH_MAX_THREADS; i++ ) {
+		d->slot[i].state = 0;
+		d->slot[i].used = 0;
+	}
+}
+
+/**
+ * @brief epoch_register - register current thread to the domain.
+ * @param d pointer to the domain.
+ * @param r pointer to the thread's record, owned by the thread.
+ * @return 1 for succeed,
+ *	   0 for too many threads.
+ */
+static inline int
+epoch_register( pepoch_domain d, pepoch_record r )
+{
+	int i = 0;
+	int expect = 0;
+
+	for ( i = 0; i < EPOCH_MAX_THREADS; i++ ) {
+		expect = 0;
+		if ( __atomic_compare_exchange_n( &d->slot[i].used, &expect, 1, 0,
+						  __ATOMIC_ACQ_REL, __ATOMIC_RELAXED ) )
+			break;
+	}
+	if ( EPOCH_MAX_THREADS == i ) {
+		printf("Too many threads!!\n");
+		return 0;
+	}
+	r->d = d;
+	r->id = i;
+	r->local = 0;
+	r->retired = 0;
+	for ( i = 0; i < 3; i++ ) {
+		r->limbo[i].epoch = 0;
+		r->limbo[i].ptr = NULL;
+		r->limbo[i].fn = NULL;
+		r->limbo[i].num = 0;
+		r->limbo[i].cap = 0;
+	}
+
+	return 1;
+}
+
+/**
+ * @brief epoch_free_limbo - free all pointers in a limbo list.
+ */
+static inline void
+epoch_free_limbo( epoch_limbo *l )
+{
+	long i = 0;
+
+	for ( i = 0; i < l->num; i++ )
+		l->fn[i]( l->ptr[i] );
+	l->num = 0;
+}
+
+/**
+ * @brief epoch_try_advance - advance the global epoch if all active threads caught up.
+ * @param d pointer to the domain.
+ * @return 1 for advanced,
+ *	   0 for not.
+ */
+static inline int
+epoch_try_advance( pepoch_domain d )
+{
+	unsigned long g = __atomic_load_n( &d->global, __ATOMIC_SEQ_CST );
+	unsigned long s = 0;
+	int i = 0;
+
+	for ( i = 0; i < EPOCH_MAX_THREADS; i++ ) {
+		if ( !__atomic_load_n( &d->slot[i].used, __ATOMIC_ACQUIRE ) )
+			continue;
+		s = __atomic_load_n( &d->slot[i].state, __ATOMIC_SEQ_CST );
+		if ( ( s & 1 ) && ( s >> 1 ) != g )
+			return 0;
+	}
+
+	return __atomic_compare_exchange_n( &d->global, &g, g + 1, 0,
+					    __ATOMIC_SEQ_CST, __ATOMIC_RELAXED );
+}
+
+/**
+ * @brief epoch_reclaim - free the limbo lists which are safe now.
+ * @param r pointer to the thread's record.
+ * @return none.
+ */
+static inline void
+epoch_reclaim( pepoch_record r )
+{
+	unsigned long g = __atomic_load_n( &r->d->global, __ATOMIC_ACQUIRE );
+	int i = 0;
+
+	for ( i = 0; i < 3; i++ )
+		if ( r->limbo[i].num && r->limbo[i].epoch + 2 <= g )
+			epoch_free_limbo( &r->limbo[i] );
+}
+
+/**
+ * @brief epoch_enter - enter the critical section before accessing shared structure.
+ * @param r pointer to the thread's record.
+ * @return none.
+ */
+static inline void
+epoch_enter( pepoch_record r )
+{
+	epoch_slot *s = &r->d->slot[r->id];
+	unsigned long g = 0;
+
+	for ( ; ; ) {
+		g = __atomic_load_n( &r->d->global, __ATOMIC_SEQ_CST );
+		__atomic_store_n( &s->state, ( g << 1 ) | 1, __ATOMIC_SEQ_CST );
+		if ( __atomic_load_n( &r->d->global, __ATOMIC_SEQ_CST ) == g )
+			break;
+	}
+	if ( r->local != g ) {
+		r->local = g;
+		epoch_reclaim( r );
+	}
+}
+
+/**
+ * @brief epoch_exit - leave the critical section.
+ * @param r pointer to the thread's record.
+ * @return none.
+ */
+static inline void
+epoch_exit( pepoch_record r )
+{
+	__atomic_store_n( &r->d->slot[r->id].state, r->local << 1, __ATOMIC_RELEASE );
+}
+
+/**
+ * @brief epoch_retire - defer freeing a pointer unlinked from shared structure.
+ * @param r pointer to the thread's record.
+ * @param p the pointer unlinked.
+ * @param fn the function used to free p.
+ * @return none.
+ *
+ * 必须在摘除p之后调用，调用线程可以处于或不处于临界区。
+ */
+static inline void
+epoch_retire( pepoch_record r, void *p, void (*fn)( void * ) )
+{
+	unsigned long s = __atomic_load_n( &r->d->global, __ATOMIC_SEQ_CST );
+	epoch_limbo *l = &r->limbo[s % 3];
+	void **ptr = NULL;
+	void (**pfn)( void * ) = NULL;
+
+	if ( l->num && l->epoch != s )
+		epoch_free_limbo( l );	/* 表中为s-3纪元摘除的节点，已经安全 */
+	l->epoch = s;
+	if ( l->num == l->cap ) {
+		ptr = ( void ** )realloc( l->ptr, ( l->cap * 2 + 64 ) * sizeof(void *) );
+		pfn = ( void (**)( void * ) )realloc( l->fn, ( l->cap * 2 + 64 ) * sizeof(*pfn) );
+		if ( ptr )
+			l->ptr = ptr;
+		if ( pfn )
+			l->fn = pfn;
+		if ( !ptr || !pfn ) {
+			printf("No Memory!!\n");	/* 无法记录，只能泄漏 */
+			return;
+		}
+		l->cap = l->cap * 2 + 64;
+	}
+	l->ptr[l->num] = p;
+	l->fn[l->num] = fn;
+	l->num++;
+	if ( 0 == ++r->retired % EPOCH_FREQ ) {
+		epoch_try_advance( r->d );
+		epoch_reclaim( r );
+	}
+}
+
+/**
+ * @brief epoch_unregister - unregister current thread, free all it's retired pointers.
+ * @param r pointer to the thread's record.
+ * @return none.
+ *
+ * 等待全局纪元推进两次后释放本线程所有待回收的指针，调用时不能处于临界区。
+ */
+static inline void
+epoch_unregister( pepoch_record r )
+{
+	unsigned long target = __atomic_load_n( &r->d->global, __ATOMIC_SEQ_CST ) + 2;
+	int i = 0;
+
+	epoch_exit( r );
+	for ( ; __atomic_load_n( &r->d->global, __ATOMIC_SEQ_CST ) < target; )
+		epoch_try_advance( r->d );
+	for ( i = 0; i < 3; i++ ) {
+		epoch_free_limbo( &r->limbo[i] );
+		free( r->limbo[i].ptr );
+		free( r->limbo[i].fn );
+	}
+	__atomic_store_n( &r->d->slot[r->id].state, 0, __ATOMIC_RELEASE );
+	__atomic_store_n( &r->d->slot[r->id].used, 0, __ATOMIC_RELEASE );
+}
+
+#endif
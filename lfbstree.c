@@ -0,0 +1,465 @@
+/**
+ * @file lfbstree.c
+ * @brief realize lock-free binary search tree's basic oprations.
+ * @author watertiger <darkwkt@gmail.com>
+ * @date 2026-10-19
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+
+#include "lfbstree.h"
+
+#define INIT_SIZE 10
+
+#define LFBST_LOAD(x) __atomic_load_n( &(x), __ATOMIC_ACQUIRE )
+#define LFBST_CAS(p, e, v) \
+	__atomic_compare_exchange_n( (p), (e), (v), 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE )
+#define LFBST_ADDR(x) ( ( plfbst )( (x) & ~( LFBST_FLAG | LFBST_TAG ) ) )
+#define LFBST_CHILD(n, k) ( *( (k) < (n)->key ? &(n)->lc : &(n)->rc ) )
+
+typedef struct _lfbst_seek_record {
+	plfbst ancestor;	/* 最后一条未标记(tag)边的起点 */
+	plfbst successor;	/* 该边的终点，删除时从此处起的路径整体摘除 */
+	plfbst parent;
+	plfbst leaf;
+}lfbst_seek_record;
+
+/**
+ * @brief lfbst_init - initialize lock-free binary search tree with sentinels.
+ * @param t pointer to the tree.
+ * @return 1 for succeed.
+ */
+int
+lfbst_init( plfbst_tree t )
+{
+	int i = 0;
+
+	for ( i = 0; i < 3; i++ ) {
+		t->leaf[i].key = LFBST_INF0 + i;
+		t->leaf[i].lc = 0;
+		t->leaf[i].rc = 0;
+	}
+	t->s.key = LFBST_INF1;
+	t->s.lc = (uintptr_t)&t->leaf[0];
+	t->s.rc = (uintptr_t)&t->leaf[1];
+	t->r.key = LFBST_INF2;
+	t->r.lc = (uintptr_t)&t->s;
+	t->r.rc = (uintptr_t)&t->leaf[2];
+	epoch_init( &t->ed );
+
+	return 1;
+}
+
+/**
+ * @brief lfbst_thread_init - register current thread before accessing the tree.
+ * @param t pointer to the tree.
+ * @param r pointer to the thread's epoch record.
+ * @return 1 for succeed,
+ *	   0 for failure.
+ */
+int
+lfbst_thread_init( plfbst_tree t, pepoch_record r )
+{
+	return epoch_register( &t->ed, r );
+}
+
+/**
+ * @brief lfbst_thread_exit - unregister current thread, free it's retired nodes.
+ * @param r pointer to the thread's epoch record.
+ * @return none.
+ */
+void
+lfbst_thread_exit( pepoch_record r )
+{
+	epoch_unregister( r );
+}
+
+/**
+ * @brief lfbst_seek - find the leaf where key should be and record the path.
+ * @param t pointer to the tree.
+ * @param key the key to seek.
+ * @param sr pointer to the seek record.
+ * @return none.
+ */
+static void
+lfbst_seek( plfbst_tree t, long long key, lfbst_seek_record *sr )
+{
+	uintptr_t pfield = LFBST_LOAD( t->s.lc );
+	uintptr_t cfield = 0;
+	plfbst cur = NULL;
+
+	sr->ancestor = &t->r;
+	sr->successor = &t->s;
+	sr->parent = &t->s;
+	sr->leaf = LFBST_ADDR( pfield );
+	cfield = LFBST_LOAD( LFBST_CHILD( sr->leaf, key ) );
+	cur = LFBST_ADDR( cfield );
+	for ( ; cur; ) {
+		if ( !( pfield & LFBST_TAG ) ) {
+			sr->ancestor = sr->parent;
+			sr->successor = sr->leaf;
+		}
+		sr->parent = sr->leaf;
+		sr->leaf = cur;
+		pfield = cfield;
+		cfield = LFBST_LOAD( LFBST_CHILD( cur, key ) );
+		cur = LFBST_ADDR( cfield );
+	}
+}
+
+/**
+ * @brief lfbst_free_node - free function used by epoch reclamation.
+ */
+static void
+lfbst_free_node( void *p )
+{
+	free( p );
+}
+
+/**
+ * @brief lfbst_cleanup - physically remove the flagged leaf and it's parent.
+ * @param r pointer to the thread's epoch record.
+ * @param key the key used by the seek.
+ * @param sr pointer to the seek record.
+ * @return 1 for removed by this thread,
+ *	   0 for failure, the caller should seek again.
+ *
+ * 被删叶子的边已被标记(flag)，先标记(tag)其兄弟边，使双亲不能再被修改，
+ * 然后CAS祖先指向successor的边，使其指向兄弟（保留兄弟边上的flag）。
+ * successor到parent之间的路径上每个节点都有一个已标记的叶子，一并摘除。
+ */
+static int
+lfbst_cleanup( pepoch_record r, long long key, lfbst_seek_record *sr )
+{
+	plfbst parent = sr->parent;
+	plfbst n = NULL;
+	uintptr_t *psucc = &LFBST_CHILD( sr->ancestor, key );
+	uintptr_t *pchild = &LFBST_CHILD( parent, key );
+	uintptr_t *psibling = ( pchild == &parent->lc ) ? &parent->rc : &parent->lc;
+	uintptr_t *pn = NULL;
+	uintptr_t expect = (uintptr_t)sr->successor;
+	uintptr_t v = LFBST_LOAD( *pchild );
+
+	if ( !( v & LFBST_FLAG ) ) {
+		/* 被删的是另一侧的叶子 */
+		psibling = pchild;
+		pchild = ( pchild == &parent->lc ) ? &parent->rc : &parent->lc;
+	}
+	__atomic_fetch_or( psibling, LFBST_TAG, __ATOMIC_ACQ_REL );
+	v = LFBST_LOAD( *psibling );
+	if ( !LFBST_CAS( psucc, &expect, v & ~LFBST_TAG ) )
+		return 0;
+
+	/* 摘除的路径上的边都已被标记，不会再变化 */
+	for ( n = sr->successor; n != parent; n = LFBST_ADDR( LFBST_LOAD( *pn ) ) ) {
+		pn = &LFBST_CHILD( n, key );
+		v = LFBST_LOAD( *( ( pn == &n->lc ) ? &n->rc : &n->lc ) );
+		epoch_retire( r, LFBST_ADDR( v ), lfbst_free_node );
+		epoch_retire( r, n, lfbst_free_node );
+	}
+	epoch_retire( r, LFBST_ADDR( LFBST_LOAD( *pchild ) ), lfbst_free_node );
+	epoch_retire( r, parent, lfbst_free_node );
+
+	return 1;
+}
+
+/**
+ * @brief lfbst_search - searching key in lock-free binary search tree.
+ * @param t pointer to the tree.
+ * @param r pointer to the thread's epoch record.
+ * @param key the enum to search.
+ * @return 1 for found,
+ *	   0 for not exists.
+ */
+int
+lfbst_search( plfbst_tree t, pepoch_record r, int key )
+{
+	plfbst n = &t->s;
+	uintptr_t v = 0;
+	int found = 0;
+
+	epoch_enter( r );
+	for ( ; ( v = LFBST_LOAD( LFBST_CHILD( n, key ) ) ); )
+		n = LFBST_ADDR( v );
+	found = ( n->key == key );
+	epoch_exit( r );
+
+	return found;
+}
+
+/**
+ * @brief lfbst_insert - insert an enum into lock-free binary search tree.
+ * @param t pointer to the tree.
+ * @param r pointer to the thread's epoch record.
+ * @param e the enum to insert.
+ * @return 1 for succeed,
+ *	   0 for failure or already exists.
+ *
+ * 新建的叶子和内部节点在重试时复用，CAS成功前不被其他线程可见。
+ */
+int
+lfbst_insert( plfbst_tree t, pepoch_record r, int e )
+{
+	lfbst_seek_record sr;
+	plfbst leaf = NULL;
+	plfbst nleaf = ( plfbst )malloc( sizeof( lfbst_node ) );
+	plfbst ninternal = ( plfbst )malloc( sizeof( lfbst_node ) );
+	uintptr_t *pchild = NULL;
+	uintptr_t expect = 0;
+	int inserted = 0;
+
+	if ( !nleaf || !ninternal ) {
+		printf("No Memory!!\n");
+		free( nleaf );
+		free( ninternal );
+		return 0;
+	}
+	nleaf->key = e;
+	nleaf->lc = 0;
+	nleaf->rc = 0;
+	epoch_enter( r );
+	for ( ; ; ) {
+		lfbst_seek( t, e, &sr );
+		leaf = sr.leaf;
+		if ( leaf->key == e )
+			break;
+		if ( e < leaf->key ) {
+			ninternal->key = leaf->key;
+			ninternal->lc = (uintptr_t)nleaf;
+			ninternal->rc = (uintptr_t)leaf;
+		} else {
+			ninternal->key = e;
+			ninternal->lc = (uintptr_t)leaf;
+			ninternal->rc = (uintptr_t)nleaf;
+		}
+		pchild = &LFBST_CHILD( sr.parent, e );
+		expect = (uintptr_t)leaf;
+		if ( LFBST_CAS( pchild, &expect, (uintptr_t)ninternal ) ) {
+			inserted = 1;
+			break;
+		}
+		/* 边已被标记，先帮助完成删除 */
+		if ( LFBST_ADDR( expect ) == leaf && ( expect & ( LFBST_FLAG | LFBST_TAG ) ) )
+			lfbst_cleanup( r, e, &sr );
+	}
+	epoch_exit( r );
+	if ( !inserted ) {
+		free( nleaf );
+		free( ninternal );
+	}
+
+	return inserted;
+}
+
+/**
+ * @brief lfbst_delete - delete an enum from lock-free binary search tree.
+ * @param t pointer to the tree.
+ * @param r pointer to the thread's epoch record.
+ * @param key the enum to delete.
+ * @return 1 for succeed,
+ *	   0 for failure.
+ *
+ * 注入阶段：CAS标记指向被删叶子的边，成功即表示删除生效（线性化点）；
+ * 清理阶段：反复调用lfbst_cleanup，直到本线程完成摘除或发现叶子已被
+ * 其他线程摘除。
+ */
+int
+lfbst_delete( plfbst_tree t, pepoch_record r, int key )
+{
+	lfbst_seek_record sr;
+	plfbst leaf = NULL;
+	uintptr_t *pchild = NULL;
+	uintptr_t expect = 0;
+	int injected = 0;
+
+	epoch_enter( r );
+	for ( ; ; ) {
+		lfbst_seek( t, key, &sr );
+		if ( injected ) {
+			if ( sr.leaf != leaf || lfbst_cleanup( r, key, &sr ) )
+				break;
+			continue;
+		}
+		leaf = sr.leaf;
+		if ( leaf->key != key )
+			break;
+		pchild = &LFBST_CHILD( sr.parent, key );
+		expect = (uintptr_t)leaf;
+		if ( LFBST_CAS( pchild, &expect, (uintptr_t)leaf | LFBST_FLAG ) ) {
+			injected = 1;
+			if ( lfbst_cleanup( r, key, &sr ) )
+				break;
+		} else if ( LFBST_ADDR( expect ) == leaf && ( expect & ( LFBST_FLAG | LFBST_TAG ) ) ) {
+			lfbst_cleanup( r, key, &sr );
+		}
+	}
+	epoch_exit( r );
+
+	return injected;
+}
+
+/**
+ * @brief lfbst_free_subtree - free all nodes except sentinels.
+ */
+static void
+lfbst_free_subtree( plfbst_tree t, plfbst n )
+{
+	if ( !n || ( n >= &t->leaf[0] && n <= &t->leaf[2] ) )
+		return;
+	lfbst_free_subtree( t, LFBST_ADDR( n->lc ) );
+	lfbst_free_subtree( t, LFBST_ADDR( n->rc ) );
+	free( n );
+}
+
+/**
+ * @brief lfbst_destroy - destroy lock-free binary search tree, free it's space.
+ * @param t pointer to the tree.
+ * @return 0 for success.
+ *
+ * 调用前所有线程都必须已经调用lfbst_thread_exit。
+ */
+int
+lfbst_destroy( plfbst_tree t )
+{
+	lfbst_free_subtree( t, LFBST_ADDR( t->s.lc ) );
+	lfbst_init( t );
+
+	return 0;
+}
+
+/* 对比：用一把互斥锁保护的普通二叉排序树 */
+#define TREE_PREFIX cmp_bst
+#define TREE_KEY_TYPE int
+#define TREE_ENGINE TREE_BST
+#include "treetmpl.h"
+
+#define BENCH_KEYS	( 1 << 16 )
+#define BENCH_OPS	( 1 << 20 )
+#define BENCH_THREADS	8
+
+typedef struct _bench_arg {
+	plfbst_tree t;		/* NULL for the locked tree */
+	pcmp_bst *pbst;
+	pthread_mutex_t *lock;
+	unsigned int seed;
+	int update_pct;
+}bench_arg;
+
+/**
+ * @brief bench_worker - run a mixed search/insert/delete workload.
+ */
+static void *
+bench_worker( void *arg )
+{
+	bench_arg *pa = ( bench_arg * )arg;
+	epoch_record rec;
+	unsigned int x = pa->seed;
+	int i = 0;
+	int key = 0;
+	int op = 0;
+
+	if ( pa->t && !lfbst_thread_init( pa->t, &rec ) )
+		return NULL;
+	for ( i = 0; i < BENCH_OPS; i++ ) {
+		x = x * 1103515245 + 12345;
+		key = ( x >> 8 ) % ( 2 * BENCH_KEYS );
+		op = ( x >> 4 ) % 100;
+		if ( pa->t ) {
+			if ( op >= pa->update_pct )
+				lfbst_search( pa->t, &rec, key );
+			else if ( op & 1 )
+				lfbst_insert( pa->t, &rec, key );
+			else
+				lfbst_delete( pa->t, &rec, key );
+			continue;
+		}
+		pthread_mutex_lock( pa->lock );
+		if ( op >= pa->update_pct )
+			cmp_bst_search( *pa->pbst, key );
+		else if ( op & 1 )
+			cmp_bst_insert( pa->pbst, key );
+		else
+			cmp_bst_delete( pa->pbst, key );
+		pthread_mutex_unlock( pa->lock );
+	}
+	if ( pa->t )
+		lfbst_thread_exit( &rec );
+
+	return NULL;
+}
+
+/**
+ * @brief bench_run - run the workload with n threads and show throughput.
+ */
+static void
+bench_run( plfbst_tree t, pcmp_bst *pbst, int n, int update_pct )
+{
+	pthread_t tid[BENCH_THREADS];
+	bench_arg args[BENCH_THREADS];
+	pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+	struct timespec t0;
+	struct timespec t1;
+	double sec = 0;
+	int i = 0;
+
+	clock_gettime( CLOCK_MONOTONIC, &t0 );
+	for ( i = 0; i < n; i++ ) {
+		args[i].t = t;
+		args[i].pbst = pbst;
+		args[i].lock = &lock;
+		args[i].seed = i * 7919 + 1;
+		args[i].update_pct = update_pct;
+		pthread_create( &tid[i], NULL, bench_worker, &args[i] );
+	}
+	for ( i = 0; i < n; i++ )
+		pthread_join( tid[i], NULL );
+	clock_gettime( CLOCK_MONOTONIC, &t1 );
+	sec = ( t1.tv_sec - t0.tv_sec ) + ( t1.tv_nsec - t0.tv_nsec ) / 1e9;
+	printf("%-6s threads:%d updates:%2d%%  %.2f Mops/s\n", t ? "lfbst" : "locked",
+	       n, update_pct, n * (double)BENCH_OPS / sec / 1e6);
+}
+
+int
+main()
+{
+	int array[INIT_SIZE];
+	int i = 0;
+	lfbst_tree tree;
+	epoch_record rec;
+	pcmp_bst pbst = NULL;
+
+	srand( (unsigned int)time(NULL) );
+	lfbst_init( &tree );
+	lfbst_thread_init( &tree, &rec );
+	for ( i = 0; i < INIT_SIZE; i++ ) {
+		array[i] = rand() % 100;
+		printf("%-4d", array[i]);
+		lfbst_insert( &tree, &rec, array[i] );
+	}
+	printf("\n");
+	printf("%d %s.\n", array[5], lfbst_search( &tree, &rec, array[5] ) ? "found" : "not exists");
+	lfbst_delete( &tree, &rec, array[5] );
+	printf("%d %s.\n", array[5], lfbst_search( &tree, &rec, array[5] ) ? "found" : "not exists");
+	lfbst_thread_exit( &rec );
+	lfbst_destroy( &tree );
+
+	lfbst_init( &tree );
+	lfbst_thread_init( &tree, &rec );
+	for ( i = 0; i < BENCH_KEYS; i++ ) {
+		lfbst_insert( &tree, &rec, ( rand() % BENCH_KEYS ) * 2 );
+		cmp_bst_insert( &pbst, ( rand() % BENCH_KEYS ) * 2 );
+	}
+	lfbst_thread_exit( &rec );
+	for ( i = 1; i <= BENCH_THREADS; i *= 2 ) {
+		bench_run( &tree, NULL, i, 20 );
+		bench_run( NULL, &pbst, i, 20 );
+	}
+	lfbst_destroy( &tree );
+	cmp_bst_destroy( &pbst );
+
+	return 0;
+}
@@ -0,0 +1,57 @@
+/**
+ * @file lfbstree.h
+ * @brief describe lock-free binary search tree's defination and basic oprations.
+ * @author watertiger <darkwkt@gmail.com>
+ * @date 2026-10-19
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+#include "epoch.h"
+
+/**
+ * @brief define the lock-free binary search tree node and it's basic oprations
+ *
+ * 无锁二叉排序树（Natarajan-Mittal外部树）：
+ *	关键字只保存在叶子中，内部节点只用于路由，小于内部节点关键字的在左子树，
+ *	大于等于的在右子树。内部节点总有两个孩子。
+ *	孩子指针的最低两位作为边的标记：
+ *		flag - 指向的叶子正在被删除；
+ *		tag  - 该边不能再修改（其双亲即将被摘除）。
+ *	插入用一次CAS把叶子替换为"新内部节点+新叶子+原叶子"的子树；
+ *	删除先CAS标记(flag)指向被删叶子的边，再标记(tag)兄弟边，最后用一次CAS
+ *	把最近的未标记祖先的边直接指向兄弟，摘除双亲（及路径上其他已标记的节点）。
+ *	任何线程发现被标记的边都会帮助完成删除，因此不会阻塞。
+ * 树中预置3个无穷大关键字的哨兵叶子和2个哨兵内部节点，树永远不为空。
+ * 被摘除的节点由epoch.h的纪元回收机制延迟释放。
+ *
+ * 每个访问树的线程需要先调用lfbst_thread_init获得自己的纪元记录，
+ * 退出前调用lfbst_thread_exit。编译时需要 -pthread。
+ */
+#define LFBST_FLAG	( (uintptr_t)1 )
+#define LFBST_TAG	( (uintptr_t)2 )
+
+#define LFBST_INF0	( 1LL << 32 )
+#define LFBST_INF1	( LFBST_INF0 + 1 )
+#define LFBST_INF2	( LFBST_INF0 + 2 )
+
+typedef struct _lock_free_bst {
+	long long key;	/* 可以表示哨兵的无穷大关键字 */
+	uintptr_t lc, rc;/* left and right child pointer with flag and tag bits */
+}lfbst_node, *plfbst;
+
+typedef struct _lock_free_bst_tree {
+	lfbst_node r;		/* 哨兵根，关键字为INF2 */
+	lfbst_node s;		/* r的左孩子，关键字为INF1，s.lc为真正的树 */
+	lfbst_node leaf[3];	/* 关键字为INF0, INF1, INF2的哨兵叶子 */
+	epoch_domain ed;
+}lfbst_tree, *plfbst_tree;
+
+int lfbst_init( plfbst_tree t );
+int lfbst_thread_init( plfbst_tree t, pepoch_record r );
+void lfbst_thread_exit( pepoch_record r );
+int lfbst_search( plfbst_tree t, pepoch_record r, int key );
+int lfbst_insert( plfbst_tree t, pepoch_record r, int e );
+int lfbst_delete( plfbst_tree t, pepoch_record r, int key );
+int lfbst_destroy( plfbst_tree t );
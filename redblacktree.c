@@ -7,11 +7,54 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <unistd.h>
 
 #include "redblacktree.h"
 
 #define INIT_SIZE 10
 
+/* 孩子指针及树根以release语义写入，并发读者以acquire语义读取 */
+#define RBT_SET(x, v) __atomic_store_n( &(x), (v), __ATOMIC_RELEASE )
+#define RBT_GET(x) __atomic_load_n( &(x), __ATOMIC_ACQUIRE )
+
+#define RBT_TRACE(...) do { if ( rbt_trace ) printf( __VA_ARGS__ ); } while ( 0 )
+
+int rbt_trace = 0;
+
+ptree_arena rbt_arena = NULL;
+
+/**
+ * @brief rbt_alloc - allocate a node, from rbt_arena if it's set.
+ * @param size the size of node.
+ * @return pointer to the node,
+ *	   NULL pointer if no memory.
+ */
+static void *
+rbt_alloc( size_t size )
+{
+	if ( rbt_arena && size <= rbt_arena->size )
+		return tarena_alloc( rbt_arena );
+
+	return malloc( size );
+}
+
+/**
+ * @brief rbt_free - free a node to where it comes from.
+ * @param p pointer to the node.
+ */
+static void
+rbt_free( void *p )
+{
+	if ( rbt_arena && tarena_owns( rbt_arena, p ) )
+		tarena_free( rbt_arena, p );
+	else
+		free( p );
+}
+
 /**
  * @brief rbt_search1 - searching key in red black tree.
  * @param proot pointer to the root of red black tree.
@@ -83,17 +126,17 @@ right_rotate( prbt *proot, prbt pn )
 	prbt plc = NULL;
 
 	plc = pn->lc;
-	pn->lc = plc->rc;
+	RBT_SET( pn->lc, plc->rc );
 	if ( plc->rc )	/* 原始为 plc->rc != 哨兵节点指针，现在为不空即可*/
 		plc->rc->p = pn;
 	plc->p = pn->p;
 	if ( !pn->p )
-		(*proot) = plc;
+		RBT_SET( (*proot), plc );
 	else if ( pn == pn->p->rc )
-		pn->p->rc = plc;
+		RBT_SET( pn->p->rc, plc );
 	else
-		pn->p->lc = plc;
-	plc->rc = pn;
+		RBT_SET( pn->p->lc, plc );
+	RBT_SET( plc->rc, pn );
 	pn->p = plc;
 
 	return;
@@ -112,17 +155,17 @@ left_rotate( prbt *proot, prbt pn )
 	prbt prc = NULL;
 
 	prc = pn->rc;
-	pn->rc = prc->lc;
+	RBT_SET( pn->rc, prc->lc );
 	if ( prc->lc )
 		prc->lc->p = pn;
 	prc->p = pn->p;
 	if ( !pn->p )
-		(*proot) = prc;
+		RBT_SET( (*proot), prc );
 	else if ( pn == pn->p->lc )
-		pn->p->lc = prc;
+		RBT_SET( pn->p->lc, prc );
 	else
-		pn->p->rc = prc;
-	prc->lc = pn;
+		RBT_SET( pn->p->rc, prc );
+	RBT_SET( prc->lc, pn );
 	pn->p = prc;
 
 	return;
@@ -163,21 +206,21 @@ rbt_insert_fixup( prbt *proot, prbt pe )
 		if ( pe->p == pe->p->p->lc ) {
 			pu = pe->p->p->rc;
 			if ( pu && RED == pu->rb ) { /* 检查pu是否存在，case1: b) */
-				printf("Left -- case1.\n");
+				RBT_TRACE("Left -- case1.\n");
 				pe->p->rb = BLACK;
 				pu->rb = BLACK;
 				pe->p->p->rb = RED;
 				pe = pe->p->p;
 				continue; /* 此处continue的作用是由于 case1(left)可能转化为 case2(right)、case3(right) */
 			} else if ( pe == pe->p->rc ) { /* case2: c) */
-				printf("Left -- case2.\n");
+				RBT_TRACE("Left -- case2.\n");
 				pe = pe->p;
 				left_rotate( proot, pe );
 			}  
 			if ( !pe->p || !pe->p->p )
 				break;
 			if ( pe == pe->p->lc ) { 	/* case3: d) */
-				printf("Left -- case3.\n");
+				RBT_TRACE("Left -- case3.\n");
 				pe->p->rb = BLACK;
 				pe->p->p->rb = RED;
 				right_rotate( proot, pe->p->p );
@@ -185,21 +228,21 @@ rbt_insert_fixup( prbt *proot, prbt pe )
 		} else {
 			pu = pe->p->p->lc;
 			if ( pu && RED == pu->rb ) { /* 检查pu是否存在，case1: b) */
-				printf("Right -- case1.\n");
+				RBT_TRACE("Right -- case1.\n");
 				pe->p->rb = BLACK;
 				pu->rb = BLACK;
 				pe->p->p->rb = RED;
 				pe = pe->p->p;
 				continue; /* 此处continue的作用是由于 case1(right)可能转化为case2(left)、case3(left) */
 			} else if ( pe == pe->p->lc ) { /* case2: c) */
-				printf("Right -- case2.\n");
+				RBT_TRACE("Right -- case2.\n");
 				pe = pe->p;
 				right_rotate( proot, pe );
 			} 
 			if ( !pe->p || !pe->p->p )
 				break;
 			if ( pe == pe->p->rc ) {	/* case3: d) */
-				printf("Right -- case3.\n");
+				RBT_TRACE("Right -- case3.\n");
 				pe->p->rb = BLACK;
 				pe->p->p->rb = RED;
 				left_rotate( proot, pe->p->p );
@@ -210,6 +253,62 @@ rbt_insert_fixup( prbt *proot, prbt pe )
 
 	return;
 }
+/**
+ * @brief rbt_insert_at - link a new node of e under parent and fix up.
+ * @param proot pointer to the pointer to the root of red black tree.
+ * @param parent the last node on the search path of e, NULL for empty tree.
+ * @param e the enum to insert, must not exist in the tree.
+ * @return prbt pointer to the new node,
+ *	   NULL pointer if no memory.
+ */
+static prbt
+rbt_insert_at( prbt *proot, prbt parent, int e )
+{
+	prbt pe = ( prbt )rbt_alloc( sizeof( rbt_node ) );
+
+	if ( !pe ) {
+		printf("No Memory!!\n");
+		return NULL;
+	}
+	pe->data = e;
+	pe->lc = NULL;
+	pe->rc = NULL;
+	pe->rb = RED;
+	pe->p = parent;
+	if ( !parent ) {
+		RBT_SET( (*proot), pe );
+		(*proot)->rb = BLACK; //pe->rb = BLACK;
+	} else if ( e < parent->data ) {
+		RBT_SET( parent->lc, pe );
+	} else {
+		RBT_SET( parent->rc, pe );
+	}
+	rbt_insert_fixup( proot, pe ); 
+
+	return pe;
+}
+
+/**
+ * @brief rbt_insert_ptr - insert an enum and return the new node.
+ * @param proot pointer to the pointer to the root of red black tree.
+ * @param e the enum to insert.
+ * @return prbt pointer to the new node,
+ *	   NULL pointer if e exists or no memory.
+ *
+ * 插入修复只做旋转和改色，不改变节点与关键字的对应关系，返回的节点
+ * 在被删除之前一直有效，rbt_hashed据此维护散列索引。
+ */
+static prbt
+rbt_insert_ptr( prbt *proot, int e )
+{
+	prbt parent = NULL;
+
+	if ( rbt_search2( *proot, e, &parent ) )
+		return NULL;
+
+	return rbt_insert_at( proot, parent, e );
+}
+
 /**
  * @brief rbt_insert - insert an enum into red black tree.
  * @param proot pointer to the pointer to the root of red black tree.
@@ -221,34 +320,7 @@ rbt_insert_fixup( prbt *proot, prbt pe )
 int 
 rbt_insert( prbt *proot, int e )
 {
-	prbt parent = NULL;
-	prbt pe = NULL;
-
-	if ( rbt_search2( *proot, e, &parent ) ) {
-		return 0;
-	} else {
-		pe = ( prbt )malloc( sizeof( rbt_node ) );
-		if ( !pe ) {
-			printf("No Memory!!\n");
-			return 0;
-		}
-		pe->data = e;
-		pe->lc = NULL;
-		pe->rc = NULL;
-		pe->rb = RED;
-		pe->p = parent;
-		if ( !parent ) {
-			(*proot) = pe;
-			(*proot)->rb = BLACK; //pe->rb = BLACK;
-		} else if ( e < parent->data ) {
-			parent->lc = pe;
-		} else {
-			parent->rc = pe;
-		}
-	}
-	rbt_insert_fixup( proot, pe ); 
-
-	return 1;
+	return rbt_insert_ptr( proot, e ) != NULL;
 }
 
 
@@ -302,6 +374,176 @@ tree_successor( prbt pn )
 	return ps;
 }
 
+/**
+ * @brief rbt_floor - find the largest node not greater than key.
+ * @param proot pointer to the root of red black tree.
+ * @param key the enum to search.
+ * @return prbt pointer to the node if found,
+ *	   NULL pointer if all nodes are greater than key.
+ *
+ * 一次非递归下降：当前节点不大于key时记为候选并向右，否则向左。
+ * rbt_ceil、rbt_predecessor、rbt_successor与此类似。
+ */
+prbt
+rbt_floor( prbt proot, int key )
+{
+	prbt pc = NULL;
+
+	for ( ; proot; ) {
+		if ( proot->data <= key ) {
+			pc = proot;
+			proot = proot->rc;
+		} else {
+			proot = proot->lc;
+		}
+	}
+
+	return pc;
+}
+
+/**
+ * @brief rbt_ceil - find the smallest node not less than key.
+ * @param proot pointer to the root of red black tree.
+ * @param key the enum to search.
+ * @return prbt pointer to the node if found,
+ *	   NULL pointer if all nodes are less than key.
+ */
+prbt
+rbt_ceil( prbt proot, int key )
+{
+	prbt pc = NULL;
+
+	for ( ; proot; ) {
+		if ( proot->data >= key ) {
+			pc = proot;
+			proot = proot->lc;
+		} else {
+			proot = proot->rc;
+		}
+	}
+
+	return pc;
+}
+
+/**
+ * @brief rbt_predecessor - find the largest node less than key.
+ * @param proot pointer to the root of red black tree.
+ * @param key the enum to search, need not exist in the tree.
+ * @return prbt pointer to the node if found,
+ *	   NULL pointer if no node is less than key.
+ */
+prbt
+rbt_predecessor( prbt proot, int key )
+{
+	prbt pc = NULL;
+
+	for ( ; proot; ) {
+		if ( proot->data < key ) {
+			pc = proot;
+			proot = proot->rc;
+		} else {
+			proot = proot->lc;
+		}
+	}
+
+	return pc;
+}
+
+/**
+ * @brief rbt_successor - find the smallest node greater than key.
+ * @param proot pointer to the root of red black tree.
+ * @param key the enum to search, need not exist in the tree.
+ * @return prbt pointer to the node if found,
+ *	   NULL pointer if no node is greater than key.
+ */
+prbt
+rbt_successor( prbt proot, int key )
+{
+	prbt pc = NULL;
+
+	for ( ; proot; ) {
+		if ( proot->data > key ) {
+			pc = proot;
+			proot = proot->lc;
+		} else {
+			proot = proot->rc;
+		}
+	}
+
+	return pc;
+}
+
+/**
+ * @brief tree_predecessor - find node's predecessor node.
+ * @param pn pointer to current red black tree node
+ * @return pointer to the predecessor node if found,
+ * 	   otherwise return NULL
+ *
+ * 与tree_successor对称。
+ */
+static prbt
+tree_predecessor( prbt pn )
+{
+	prbt ps = NULL;
+
+	if ( pn->lc ) {
+		ps = pn->lc;
+		for ( ; ps->rc; ) {
+			ps = ps->rc;
+		}
+	} else {
+		ps = pn->p;
+		for ( ; ps && ( pn == ps->lc ); ) {
+			pn = ps;
+			ps = ps->p;
+		}
+	}
+
+	return ps;
+}
+
+/**
+ * @brief rbt_nearest - find the k keys nearest to key.
+ * @param proot pointer to the root of red black tree.
+ * @param key the enum to search, need not exist in the tree.
+ * @param k count of keys wanted.
+ * @param keys array of at least k elements, to store keys found, 
+ *	  ordered by distance to key, smaller key first when equal.
+ * @return count of keys stored, less than k if the tree is small.
+ *
+ * 一次下降找到floor和successor，之后借助双亲指针用tree_predecessor、
+ * tree_successor向两边展开，每次取距离较近的一边。连续k次求前驱（后继）
+ * 的均摊代价为O(k)，不需要辅助栈。
+ */
+int
+rbt_nearest( prbt proot, int key, int k, int *keys )
+{
+	prbt pl = NULL;
+	prbt pr = NULL;
+	int n = 0;
+
+	for ( ; proot; ) {
+		if ( proot->data <= key ) {
+			pl = proot;
+			proot = proot->rc;
+		} else {
+			pr = proot;
+			proot = proot->lc;
+		}
+	}
+	for ( ; n < k && ( pl || pr ); n++ ) {
+		if ( pl && ( !pr || (long long)key - pl->data <= (long long)pr->data - key ) ) {
+			keys[n] = pl->data;
+			pl = tree_predecessor( pl );
+		} else {
+			keys[n] = pr->data;
+			pr = tree_successor( pr );
+		}
+	}
+
+	return n;
+}
+
 /**
  * @brief rbt_transplant - link node u's child to u's parent node's child. 
  * @param proot pointer to the pointer to the root of red black tree.
@@ -314,11 +556,11 @@ void
 rbt_transplant( prbt *proot, prbt pn, prbt pc )
 {
 	if ( !pn->p )
-		*proot = pc;
+		RBT_SET( *proot, pc );
 	else if ( pn == pn->p->lc )
-		pn->p->lc = pc;
+		RBT_SET( pn->p->lc, pc );
 	else
-		pn->p->rc = pc;
+		RBT_SET( pn->p->rc, pc );
 	if ( pc )
 		pc->p = pn->p;
 	
@@ -350,101 +592,87 @@ rbt_transplant( prbt *proot, prbt pn, prbt pc )
  * 	   通过改变某些节点的颜色，以pe的双亲节点执行一次左旋，可以将x表示
  * 	   的额外黑色去掉，循环终止。
  * 
- * 注意：pep指针仅在pe==NULL时起作用，目的是为了保证循环的统一性，方便操作。
+ * 注意：pep指针仅在pe==NULL时起作用。pe为NULL时不再临时挂上哨兵节点，
+ * 循环中由pep记录pe的双亲，避免并发读者访问到哨兵节点。
  */
 void
 rbt_delete_fixup( prbt *proot, prbt pe, prbt pep )
 {
-	prbt px = NULL;
 	prbt pw = NULL; /* 指向节点pe的兄弟节点指针 */
 
-	printf("root:0x%p, node:0x%p, node-p:0x%p.\n", (*proot), pe, pep);
+	RBT_TRACE("root:0x%p, node:0x%p, node-p:0x%p.\n", (*proot), pe, pep);
 	if ( !(*proot) ) /* 删除的是根节点，且为最后一个节点 */
 		return;
-	if ( !pe ) {
-		px = ( prbt )malloc( sizeof(rbt_node) );
-		if ( !px ) {
-			printf("No Memory!!\n");
-			return;
-		}
-		px->rb = BLACK;
-		px->p = pep;
-		px->lc = NULL;
-		px->rc = NULL;
-		pe = px;
-		if ( !pep->lc )
-			pep->lc = px;
-		else
-			pep->rc = px;
-	}
 
-	for ( ; (pe != (*proot)) && (BLACK == pe->rb); ) {
-		if ( pe == pe->p->lc ) {
-			pw = pe->p->rc;
+	for ( ; (pe != (*proot)) && (!pe || BLACK == pe->rb); ) {
+		if ( pe )
+			pep = pe->p;
+		if ( pe == pep->lc ) {
+			pw = pep->rc;
 			if ( !pw ) {	
 				printf("Left -- Error happened.\n");
 				return;
 			}
 			if ( RED == pw->rb ) {	/* case1: a) */
-				printf("Left -- case1.\n");
+				RBT_TRACE("Left -- case1.\n");
 				pw->rb = BLACK;
-				pe->p->rb = RED;
-				left_rotate( proot, pe->p );
-				pw = pe->p->rc;
+				pep->rb = RED;
+				left_rotate( proot, pep );
+				pw = pep->rc;
 			}
 			if ( (!pw->lc || BLACK==pw->lc->rb) \
 				&& (!pw->rc || BLACK==pw->rc->rb) ) { /* case2: b) */
-				printf("Left -- case2.\n");
+				RBT_TRACE("Left -- case2.\n");
 				pw->rb = RED;
-				pe = pe->p;
+				pe = pep;
 			} else if ( !pw->rc || BLACK == pw->rc->rb ) { /* case3: c) */
-				printf("Left -- case3.\n");
+				RBT_TRACE("Left -- case3.\n");
 				pw->lc->rb = BLACK;
 				pw->rb = RED;
 				right_rotate( proot, pw ); 
-				pw = pe->p->rc;
+				pw = pep->rc;
 
 			}
 			if ( BLACK == pw->rb &&  pw->rc && RED == pw->rc->rb) { /* case4: d) */
-				printf("Left -- case4.\n");
-				pw->rb = pe->p->rb;
-				pe->p->rb = BLACK;
+				RBT_TRACE("Left -- case4.\n");
+				pw->rb = pep->rb;
+				pep->rb = BLACK;
 				pw->rc->rb = BLACK;
-				left_rotate( proot, pe->p );
+				left_rotate( proot, pep );
 
 				pe = *proot; /* 终止循环 */
 			}
 		} else {
-			pw = pe->p->lc;
+			pw = pep->lc;
 			if ( !pw ) {	
 				printf("Right -- Error happened.\n");
 				return;
 			}
 			if ( RED == pw->rb ) { /* case1: a) */
-				printf("Right -- case1.\n");
+				RBT_TRACE("Right -- case1.\n");
 				pw->rb = BLACK;
-				pe->p->rb = RED;
-				right_rotate( proot, pe->p );
-				pw = pe->p->lc;
+				pep->rb = RED;
+				right_rotate( proot, pep );
+				pw = pep->lc;
 			}
 			if ( (!pw->lc || BLACK==pw->lc->rb) \
 				&& (!pw->rc || BLACK==pw->rc->rb) ) { /* case2: b) */
-				printf("Right -- case2.\n");
+				RBT_TRACE("Right -- case2.\n");
 				pw->rb = RED;
-				pe = pe->p;
+				pe = pep;
 			} else if ( !pw->lc || BLACK == pw->lc->rb ) { /* case3: c) */
-				printf("Right -- case3.\n");
+				RBT_TRACE("Right -- case3.\n");
 				pw->rc->rb = BLACK;
 				pw->rb = RED;
 				left_rotate( proot, pw ); 
-				pw = pe->p->lc;
+				pw = pep->lc;
 			}
 			if ( BLACK == pw->rb && pw->lc && RED == pw->lc->rb ) { /* case4: d) */
-				printf("Right -- case4.\n");
-				pw->rb = pe->p->rb;
-				pe->p->rb = BLACK;
+				RBT_TRACE("Right -- case4.\n");
+				pw->rb = pep->rb;
+				pep->rb = BLACK;
 				pw->lc->rb = BLACK;
-				right_rotate( proot, pe->p );
+				right_rotate( proot, pep );
 
 				pe = *proot; /* 终止循环 */
 			}
@@ -452,13 +680,7 @@ rbt_delete_fixup( prbt *proot, prbt pe, prbt pep )
 	}
 
 	pe->rb = BLACK;
-	if ( px ) {
-		if ( px == px->p->lc )
-			px->p->lc = NULL;
-		else
-			px->p->rc = NULL;
-		free(px);
-	}
+
 	return;
 }
 /**
@@ -473,13 +695,32 @@ int
 rbt_delete( prbt *proot, int e )
 {
 	prbt pn = NULL;
+	
+	if ( ! rbt_search2( *proot, e, &pn ) )
+		return 0;
+
+	return rbt_delete_node( proot, pn );
+}
+
+/**
+ * @brief rbt_unlink_node - unlink a node from red black tree without freeing it.
+ * @param proot pointer to the pointer to the root of red black tree.
+ * @param pn pointer to the node to unlink, must be in the tree.
+ * @return 1 for succeed,
+ *	   0 for failure.
+ *
+ * 只调整节点之间的链接，不移动数据域，因此也适用于键值红黑树。
+ * 后继节点ps在挂到pn的位置之前先接好左子树，并发读者不会经由ps丢失pn的
+ * 左子树；pn本身的孩子指针保持不变，读者停留在pn上时仍可继续向下查找。
+ */
+int
+rbt_unlink_node( prbt *proot, prbt pn )
+{
 	prbt ps = NULL; /* 待删节点的后继节点 */
 	prbt pc = NULL; /* 待删节点的孩子节点 */
 	prbt pcp = NULL; /* 若pc为叶子节点NULL，将pc的双亲节点指针赋给pcp */
 	int ps_rb = 0;
 	
-	if ( ! rbt_search2( *proot, e, &pn ) )
-		return 0;
 	ps = pn;
 	ps_rb = ps->rb;
 	if ( !pn->lc ) {
@@ -503,106 +744,2311 @@ rbt_delete( prbt *proot, int e )
 			rbt_transplant( proot, ps, ps->rc );
 			if ( !pc )
 				pcp = ps->p;
-			ps->rc = pn->rc;
+			RBT_SET( ps->rc, pn->rc );
 			ps->rc->p = ps;
 		}
-		rbt_transplant( proot, pn, ps );
-		ps->lc = pn->lc;
+		RBT_SET( ps->lc, pn->lc );
 		ps->lc->p = ps;
+		rbt_transplant( proot, pn, ps );
 		ps->rb = pn->rb;
 	}
 	if ( BLACK == ps_rb ) {
 		rbt_delete_fixup( proot, pc, pcp );
 	}
 
-	free( pn );
+	return 1;
+}
+
+/**
+ * @brief rbt_delete_node - unlink a node from red black tree and free it.
+ * @param proot pointer to the pointer to the root of red black tree.
+ * @param pn pointer to the node to delete, must be in the tree.
+ * @return 1 for succeed,
+ *	   0 for failure.
+ */
+int
+rbt_delete_node( prbt *proot, prbt pn )
+{
+	rbt_unlink_node( proot, pn );
+	rbt_free( pn );
 	
 	return 1;
 }
 
+/**
+ * @brief rbt_dump_lc - access functions used by treedump.h.
+ */
+static void *
+rbt_dump_lc( void *n )
+{
+	return ( ( prbt )n )->lc;
+}
+
+static void *
+rbt_dump_rc( void *n )
+{
+	return ( ( prbt )n )->rc;
+}
+
+static long long
+rbt_dump_key( void *n )
+{
+	return ( ( prbt )n )->data;
+}
+
+static int
+rbt_dump_attr( void *n )
+{
+	return ( ( prbt )n )->rb;
+}
+
+static const tree_dump_ops rbt_dump_ops = {
+	rbt_dump_lc, rbt_dump_rc, rbt_dump_key, rbt_dump_attr, TDUMP_ATTR_COLOR, sizeof(int)
+};
+
+/**
+ * @brief rbt_dump - dump red black tree without recursion.
+ * @param proot pointer to the root of red black tree.
+ * @param d pointer to the writer initialized by tdump_init.
+ * @return 1 for succeed,
+ *	   0 for failure.
+ */
+int
+rbt_dump( prbt proot, ptree_dump d )
+{
+	return tdump_tree( d, proot, NULL, &rbt_dump_ops );
+}
+
 /**
  * @brief rbt_show - show all node's information of red black tree.
  * @param proot pointer to the node of red black tree.
  * @return none.
  *
+ * 通过treedump.h以文本格式写到标准输出，不再递归调用printf。
+ *
  */
 void
 rbt_show( prbt proot )
 {
-	if ( proot ) {
-		printf("Current:%-4d color:%s. ", proot->data, proot->rb ? "BLACK" : "RED");
-		if ( proot->lc )
-			printf("LC:%-4d", proot->lc->data);
-		else
-			printf("LC:$   ");
-		if ( proot->rc )
-			printf("RC:%-4d", proot->rc->data);
-		else
-			printf("RC:$   ");
-		if ( proot->p )
-			printf("P:%-4d\n", proot->p->data);
-		else
-			printf("P:$   \n");
-		rbt_show( proot->lc);
-		rbt_show( proot->rc);
-	} 
+	char buf[8192];
+	tree_dump d;
+
+	fflush( stdout );
+	tdump_init( &d, STDOUT_FILENO, buf, sizeof(buf), TDUMP_TEXT );
+	tdump_tree( &d, proot, proot ? proot->p : NULL, &rbt_dump_ops );
 
 	return;
 }
 
 
+/**
+ * @brief rbt_destroy - destroy red black tree, free it's space.
+ * @param proot pointer to the pointer to the root of red black tree.
+ * @return 0 for success.
+ *
+ * 仅依赖孩子指针，同样适用于键值红黑树。
+ */
 int
-main()
+rbt_destroy( prbt *proot )
 {
-	int array[INIT_SIZE];
-	//int array1[INIT_SIZE] = {4,17,54,61,11,0,51,75,43,88};
-	int array1[INIT_SIZE] = {87,10,68,69,6,27,24,28,70,62};
-	int i = 0;
-	prbt proot = NULL; /* 此处一定要显式置NULL，否则调用会出错，因为是根 */
-	prbt proot1 = NULL; /* 此处一定要显式置NULL，否则调用会出错，因为是根 */
-	prbt pfind = NULL;
-
-	srand( (unsigned int)time(NULL) );
-	for ( i = 0; i < INIT_SIZE; i++ ) {
-		array[i] = rand() % 100;
-		printf("%-4d", array[i]);
-	}
-	printf("\n");
-	/* 创建红黑树 */
-	for ( i = 0; i < INIT_SIZE; i++ ) {
-		rbt_insert( &proot, array[i] );
-//		if ( proot ) {
-//			rbt_show( proot );
-//			printf("\n");
-//		}
-	}
-	rbt_show( proot );
-	printf("\n");
-	for ( i = 0; i < INIT_SIZE; i++ ) {
-		printf("%d -- \n", array[i]);
-		rbt_delete( &proot, array[i]);
-		rbt_show( proot );
-		printf("\n");
-	}
-	
-	printf("======================分割线======================\n");
-	for ( i = 0; i < INIT_SIZE; i++ ) {
-		printf("%d -- \n", array1[i]);
-		rbt_insert( &proot1, array1[i] );
-		rbt_show( proot1 );
-		printf("\n");
+	if ( *proot ) {
+		rbt_destroy( &(*proot)->lc );
+		rbt_destroy( &(*proot)->rc );
+		rbt_free( *proot );
+		(*proot) = NULL;
 	}
-	printf("======================分割线1--insert finish======================\n");
-	rbt_show( proot1 );
-	printf("\n");
-	for ( i = 0; i < INIT_SIZE; i++ ) {
+
+	return 0;
+}
+
+/**
+ * @brief rbt_kv_init - initialize an empty key/value red black tree.
+ * @param t pointer to the key/value tree.
+ * @return 1 for succeed.
+ */
+int
+rbt_kv_init( prbt_kv_tree t )
+{
+	t->root = NULL;
+
+	return 1;
+}
+
+/**
+ * @brief rbt_kv_search1 - searching key in key/value red black tree.
+ * @param t pointer to the key/value tree.
+ * @param key the key to search.
+ * @return prbt_kv pointer to the node if found,
+ *	   NULL pointer if key not found.
+ */
+prbt_kv
+rbt_kv_search1( prbt_kv_tree t, rbt_key key )
+{
+	prbt pn = t->root;
+
+	for ( ; pn && key != RBT_KV(pn)->key; )
+		pn = ( key < RBT_KV(pn)->key ) ? pn->lc : pn->rc;
+
+	return RBT_KV(pn);
+}
+
+/**
+ * @brief rbt_kv_get - get the value of key in key/value red black tree.
+ * @param t pointer to the key/value tree.
+ * @param key the key to search.
+ * @param value pointer to store the value found, may be NULL.
+ * @return 1 for found,
+ *	   0 for not found.
+ */
+int
+rbt_kv_get( prbt_kv_tree t, rbt_key key, rbt_value *value )
+{
+	prbt_kv p = rbt_kv_search1( t, key );
+
+	if ( !p )
+		return 0;
+	if ( value )
+		*value = p->value;
+
+	return 1;
+}
+
+/**
+ * @brief rbt_kv_insert - insert a key/value pair into red black tree.
+ * @param t pointer to the key/value tree.
+ * @param key the key to insert.
+ * @param value the value bound to key.
+ * @return 1 for new node inserted,
+ *	   0 for key already exists (value is updated) or failure.
+ */
+int
+rbt_kv_insert( prbt_kv_tree t, rbt_key key, rbt_value value )
+{
+	prbt *proot = &t->root;
+	prbt parent = NULL;
+	prbt pn = *proot;
+	prbt_kv pe = NULL;
+
+	for ( ; pn; ) {
+		if ( key == RBT_KV(pn)->key ) {
+			RBT_KV(pn)->value = value;
+			return 0;
+		}
+		parent = pn;
+		pn = ( key < RBT_KV(pn)->key ) ? pn->lc : pn->rc;
+	}
+	pe = ( prbt_kv )rbt_alloc( sizeof( rbt_kv_node ) );
+	if ( !pe ) {
+		printf("No Memory!!\n");
+		return 0;
+	}
+	pe->node.data = 0;
+	pe->node.lc = NULL;
+	pe->node.rc = NULL;
+	pe->node.rb = RED;
+	pe->node.p = parent;
+	pe->key = key;
+	pe->value = value;
+	if ( !parent ) {
+		RBT_SET( (*proot), &pe->node );
+		(*proot)->rb = BLACK;
+	} else if ( key < RBT_KV(parent)->key ) {
+		RBT_SET( parent->lc, &pe->node );
+	} else {
+		RBT_SET( parent->rc, &pe->node );
+	}
+	rbt_insert_fixup( proot, &pe->node );
+
+	return 1;
+}
+
+/**
+ * @brief rbt_kv_delete - delete a key from key/value red black tree.
+ * @param t pointer to the key/value tree.
+ * @param key the key to delete.
+ * @return 1 for succeed,
+ *	   0 for failure.
+ */
+int
+rbt_kv_delete( prbt_kv_tree t, rbt_key key )
+{
+	prbt_kv pn = rbt_kv_search1( t, key );
+
+	if ( !pn )
+		return 0;
+
+	return rbt_delete_node( &t->root, &pn->node );
+}
+
+/**
+ * @brief rbt_kv_destroy - destroy key/value red black tree, free it's space.
+ * @param t pointer to the key/value tree.
+ * @return 0 for success.
+ */
+int
+rbt_kv_destroy( prbt_kv_tree t )
+{
+	return rbt_destroy( &t->root );
+}
+
+/**
+ * @brief rbt_shared_init - initialize single-writer, multi-reader red black tree.
+ * @param t pointer to the tree.
+ * @return 1 for succeed.
+ */
+int
+rbt_shared_init( prbt_shared t )
+{
+	t->root = NULL;
+	t->seq = 0;
+	epoch_init( &t->ed );
+
+	return 1;
+}
+
+/**
+ * @brief rbt_shared_thread_init - register current thread before accessing the tree.
+ * @param t pointer to the tree.
+ * @param r pointer to the thread's epoch record.
+ * @return 1 for succeed,
+ *	   0 for failure.
+ */
+int
+rbt_shared_thread_init( prbt_shared t, pepoch_record r )
+{
+	return epoch_register( &t->ed, r );
+}
+
+/**
+ * @brief rbt_shared_thread_exit - unregister current thread, free it's retired nodes.
+ * @param r pointer to the thread's epoch record.
+ * @return none.
+ */
+void
+rbt_shared_thread_exit( pepoch_record r )
+{
+	epoch_unregister( r );
+}
+
+/**
+ * @brief rbt_write_begin - mark the start of a modification, seq becomes odd.
+ */
+static void
+rbt_write_begin( prbt_shared t )
+{
+	__atomic_store_n( &t->seq, t->seq + 1, __ATOMIC_RELAXED );
+	__atomic_thread_fence( __ATOMIC_RELEASE );
+}
+
+/**
+ * @brief rbt_write_end - mark the end of a modification, seq becomes even.
+ */
+static void
+rbt_write_end( prbt_shared t )
+{
+	__atomic_store_n( &t->seq, t->seq + 1, __ATOMIC_RELEASE );
+}
+
+/**
+ * @brief rbt_free_node - free function used by epoch reclamation.
+ */
+static void
+rbt_free_node( void *p )
+{
+	rbt_free( p );
+}
+
+/**
+ * @brief rbt_shared_search - searching key while the writer may be modifying the tree.
+ * @param t pointer to the tree.
+ * @param r pointer to the reader's epoch record.
+ * @param key the enum to search.
+ * @return 1 for found,
+ *	   0 for not exists.
+ *
+ * 找到即返回；未找到时只有查找期间seq为偶数且未变化才可信，否则重新查找。
+ * 查找深度超过RBT_MAX_DEPTH说明读到了正在调整的路径，同样重新查找。
+ */
+int
+rbt_shared_search( prbt_shared t, pepoch_record r, int key )
+{
+	prbt pn = NULL;
+	unsigned long seq = 0;
+	int depth = 0;
+	int found = 0;
+
+	epoch_enter( r );
+	for ( ; ; ) {
+		seq = __atomic_load_n( &t->seq, __ATOMIC_ACQUIRE );
+		pn = RBT_GET( t->root );
+		for ( depth = 0; pn && key != pn->data && depth < RBT_MAX_DEPTH; depth++ )
+			pn = ( key < pn->data ) ? RBT_GET( pn->lc ) : RBT_GET( pn->rc );
+		if ( pn && key == pn->data ) {
+			found = 1;
+			break;
+		}
+		__atomic_thread_fence( __ATOMIC_ACQUIRE );
+		if ( !pn && !( seq & 1 ) && seq == __atomic_load_n( &t->seq, __ATOMIC_RELAXED ) )
+			break;
+	}
+	epoch_exit( r );
+
+	return found;
+}
+
+/**
+ * @brief rbt_shared_insert - insert an enum, called by the only writer.
+ * @param t pointer to the tree.
+ * @param e the enum to insert.
+ * @return 1 for succeed,
+ *	   0 for failure.
+ */
+int
+rbt_shared_insert( prbt_shared t, int e )
+{
+	int ret = 0;
+
+	rbt_write_begin( t );
+	ret = rbt_insert( &t->root, e );
+	rbt_write_end( t );
+
+	return ret;
+}
+
+/**
+ * @brief rbt_shared_delete - delete an enum, called by the only writer.
+ * @param t pointer to the tree.
+ * @param r pointer to the writer's epoch record.
+ * @param key the enum to delete.
+ * @return 1 for succeed,
+ *	   0 for failure.
+ *
+ * 被删节点可能仍被读者访问，交给纪元回收延迟释放。
+ */
+int
+rbt_shared_delete( prbt_shared t, pepoch_record r, int key )
+{
+	prbt pn = NULL;
+
+	if ( !rbt_search2( t->root, key, &pn ) )
+		return 0;
+	rbt_write_begin( t );
+	rbt_unlink_node( &t->root, pn );
+	rbt_write_end( t );
+	epoch_retire( r, pn, rbt_free_node );
+
+	return 1;
+}
+
+/**
+ * @brief rbt_shared_destroy - destroy the tree, free it's space.
+ * @param t pointer to the tree.
+ * @return 0 for success.
+ *
+ * 调用前所有线程都必须已经调用rbt_shared_thread_exit。
+ */
+int
+rbt_shared_destroy( prbt_shared t )
+{
+	return rbt_destroy( &t->root );
+}
+
+/**
+ * @brief define the nodes allocated in advance for rbt_build_sorted.
+ */
+typedef struct _rbt_slab {
+	char *next;	/* 下一个可用的节点 */
+	size_t stride;	/* 相邻节点的距离 */
+}rbt_slab;
+
+/**
+ * @brief rbt_build_sorted - build red black subtree from sorted keys in O(n).
+ * @param keys the sorted keys without duplicates.
+ * @param lo index of the first key of subtree.
+ * @param hi index of the last key of subtree.
+ * @param depth depth of the subtree's root.
+ * @param maxdepth depth of the deepest node, floor(log2(n)).
+ * @param parent pointer to the parent of subtree.
+ * @param ok set to 0 if no memory.
+ * @param slab nodes allocated in advance, NULL to allocate by rbt_alloc.
+ * @return pointer to the root of subtree.
+ *
+ * 每次取中间的关键字作为根，左右子树节点数最多相差1，除最深一层外都是满的。
+ * 最深一层（深度大于0时）的节点为红色，其余为黑色，满足红黑树的5条性质。
+ */
+static prbt
+rbt_build_sorted( const int *keys, long lo, long hi, int depth, int maxdepth,
+		  prbt parent, int *ok, rbt_slab *slab )
+{
+	prbt pn = NULL;
+	long mid = lo + ( hi - lo ) / 2;
+
+	if ( lo > hi || !(*ok) )
+		return NULL;
+	if ( slab ) {
+		pn = ( prbt )slab->next;
+		slab->next += slab->stride;
+	} else {
+		pn = ( prbt )rbt_alloc( sizeof( rbt_node ) );
+	}
+	if ( !pn ) {
+		printf("No Memory!!\n");
+		*ok = 0;
+		return NULL;
+	}
+	pn->data = keys[mid];
+	pn->rb = ( depth == maxdepth && depth > 0 ) ? RED : BLACK;
+	pn->p = parent;
+	pn->lc = rbt_build_sorted( keys, lo, mid - 1, depth + 1, maxdepth, pn, ok, slab );
+	pn->rc = rbt_build_sorted( keys, mid + 1, hi, depth + 1, maxdepth, pn, ok, slab );
+
+	return pn;
+}
+
+/**
+ * @brief define the shared state of rbt_bulk_build.
+ *
+ * 各阶段由rbt_bulk_run启动threads个线程执行，阶段之间由调用线程做
+ * 少量的串行工作（前缀和、构造树的上层）。
+ */
+#define RBT_BULK_SAMPLE		64	/* 每个线程抽样的关键字数 */
+
+#define RBT_BULK_COUNT		0
+#define RBT_BULK_SCATTER	1
+#define RBT_BULK_SORT		2
+#define RBT_BULK_COPY		3
+#define RBT_BULK_BUILD		4
+
+typedef struct _rbt_bulk_job {
+	long lo;		/* 子树的关键字范围 */
+	long hi;
+	prbt parent;
+	prbt *slot;		/* 子树的根写到这里 */
+	char *slab;		/* 预先分配的节点，NULL表示用rbt_alloc */
+}rbt_bulk_job;
+
+typedef struct _rbt_bulk {
+	const int *keys;
+	long n;
+	int threads;
+	int phase;
+	int *a;			/* 分桶后的关键字 */
+	int *b;			/* 排序的临时空间，之后是去重后的全部关键字 */
+	int split[RBT_BULK_THREADS];	/* 桶i的关键字不小于split[i-1]，小于split[i] */
+	long pos[RBT_BULK_THREADS][RBT_BULK_THREADS];	/* 线程t在桶i中的个数及写入位置 */
+	long start[RBT_BULK_THREADS + 1];	/* 桶在a中的起点 */
+	long uniq[RBT_BULK_THREADS];	/* 桶中去重后的个数 */
+	long dst[RBT_BULK_THREADS];	/* 桶在b中的起点 */
+	rbt_bulk_job job[RBT_BULK_THREADS];
+	int njob;
+	int jobdepth;		/* 并行构造的子树的根所在的深度 */
+	int maxdepth;
+	size_t stride;
+	int ok[RBT_BULK_THREADS];
+}rbt_bulk;
+
+typedef struct _rbt_bulk_arg {
+	rbt_bulk *bk;
+	int id;
+}rbt_bulk_arg;
+
+/**
+ * @brief rbt_int_cmp - compare two int for qsort.
+ */
+static int
+rbt_int_cmp( const void *a, const void *b )
+{
+	int x = *( const int * )a;
+	int y = *( const int * )b;
+
+	return ( x > y ) - ( x < y );
+}
+
+/**
+ * @brief rbt_bulk_bucket - find the bucket of key by the splitters.
+ */
+static int
+rbt_bulk_bucket( const rbt_bulk *bk, int key )
+{
+	int lo = 0;
+	int hi = bk->threads - 1;
+	int mid = 0;
+
+	for ( ; lo < hi; ) {
+		mid = ( lo + hi ) / 2;
+		if ( key < bk->split[mid] )
+			hi = mid;
+		else
+			lo = mid + 1;
+	}
+
+	return lo;
+}
+
+/**
+ * @brief rbt_radix_sort - sort keys by 4 passes of 8 bits.
+ * @param a the keys to sort.
+ * @param tmp temporary space of n keys.
+ * @param n count of keys.
+ *
+ * 每一趟按一个字节稳定地分配，最高字节的符号位取反，负数排在前面。
+ * 趟数为偶数，结果仍在a中。
+ */
+static void
+rbt_radix_sort( int *a, int *tmp, long n )
+{
+	long cnt[256];
+	long sum = 0;
+	long c = 0;
+	long i = 0;
+	int shift = 0;
+	int *src = a;
+	int *dst = tmp;
+	int *t = NULL;
+
+	for ( shift = 0; shift < 32; shift += 8 ) {
+		memset( cnt, 0, sizeof(cnt) );
+		for ( i = 0; i < n; i++ )
+			cnt[( ( (unsigned int)src[i] ^ 0x80000000U ) >> shift ) & 0xff]++;
+		for ( i = 0, sum = 0; i < 256; i++ ) {
+			c = cnt[i];
+			cnt[i] = sum;
+			sum += c;
+		}
+		for ( i = 0; i < n; i++ )
+			dst[cnt[( ( (unsigned int)src[i] ^ 0x80000000U ) >> shift ) & 0xff]++] = src[i];
+		t = src;
+		src = dst;
+		dst = t;
+	}
+}
+
+/**
+ * @brief rbt_bulk_worker - run one phase of rbt_bulk_build in thread id.
+ */
+static void *
+rbt_bulk_worker( void *arg )
+{
+	rbt_bulk_arg *pa = ( rbt_bulk_arg * )arg;
+	rbt_bulk *bk = pa->bk;
+	long *pos = bk->pos[pa->id];
+	long lo = bk->n * pa->id / bk->threads;
+	long hi = bk->n * ( pa->id + 1 ) / bk->threads;
+	long i = 0;
+	long m = 0;
+	int *a = NULL;
+	int j = 0;
+	rbt_slab slab;
+
+	switch ( bk->phase ) {
+	case RBT_BULK_COUNT:
+		for ( i = lo; i < hi; i++ )
+			pos[rbt_bulk_bucket( bk, bk->keys[i] )]++;
+		break;
+	case RBT_BULK_SCATTER:
+		for ( i = lo; i < hi; i++ )
+			bk->a[pos[rbt_bulk_bucket( bk, bk->keys[i] )]++] = bk->keys[i];
+		break;
+	case RBT_BULK_SORT:
+		lo = bk->start[pa->id];
+		hi = bk->start[pa->id + 1];
+		a = bk->a + lo;
+		rbt_radix_sort( a, bk->b + lo, hi - lo );
+		for ( i = 0; i < hi - lo; i++ ) {
+			if ( !m || a[m - 1] != a[i] )
+				a[m++] = a[i];
+		}
+		bk->uniq[pa->id] = m;
+		break;
+	case RBT_BULK_COPY:
+		memcpy( bk->b + bk->dst[pa->id], bk->a + bk->start[pa->id],
+			bk->uniq[pa->id] * sizeof(int) );
+		break;
+	case RBT_BULK_BUILD:
+		for ( j = pa->id; j < bk->njob; j += bk->threads ) {
+			slab.next = bk->job[j].slab;
+			slab.stride = bk->stride;
+			*bk->job[j].slot = rbt_build_sorted( bk->b, bk->job[j].lo, bk->job[j].hi,
+					bk->jobdepth, bk->maxdepth, bk->job[j].parent, &bk->ok[pa->id],
+					slab.next ? &slab : NULL );
+		}
+		break;
+	}
+
+	return NULL;
+}
+
+/**
+ * @brief rbt_bulk_run - run a phase in all threads, wait for them.
+ *
+ * 调用线程自己执行0号，线程创建失败时也由调用线程补做。
+ */
+static void
+rbt_bulk_run( rbt_bulk *bk, int phase )
+{
+	pthread_t tid[RBT_BULK_THREADS];
+	rbt_bulk_arg args[RBT_BULK_THREADS];
+	int created[RBT_BULK_THREADS];
+	int i = 0;
+
+	bk->phase = phase;
+	for ( i = 0; i < bk->threads; i++ ) {
+		args[i].bk = bk;
+		args[i].id = i;
+		created[i] = i && !pthread_create( &tid[i], NULL, rbt_bulk_worker, &args[i] );
+	}
+	for ( i = 0; i < bk->threads; i++ ) {
+		if ( !created[i] )
+			rbt_bulk_worker( &args[i] );
+	}
+	for ( i = 1; i < bk->threads; i++ ) {
+		if ( created[i] )
+			pthread_join( tid[i], NULL );
+	}
+}
+
+/**
+ * @brief rbt_bulk_top - build the top levels, leave the subtrees below as jobs.
+ * @return pointer to the root of subtree,
+ *	   NULL pointer if it's empty or left as a job.
+ */
+static prbt
+rbt_bulk_top( rbt_bulk *bk, long lo, long hi, int depth, prbt parent, prbt *slot, int *ok )
+{
+	prbt pn = NULL;
+	long mid = lo + ( hi - lo ) / 2;
+
+	if ( lo > hi || !(*ok) )
+		return NULL;
+	if ( depth == bk->jobdepth ) {
+		bk->job[bk->njob].lo = lo;
+		bk->job[bk->njob].hi = hi;
+		bk->job[bk->njob].parent = parent;
+		bk->job[bk->njob].slot = slot;
+		bk->job[bk->njob].slab = NULL;
+		bk->njob++;
+		return NULL;
+	}
+	pn = ( prbt )rbt_alloc( sizeof( rbt_node ) );
+	if ( !pn ) {
+		printf("No Memory!!\n");
+		*ok = 0;
+		return NULL;
+	}
+	pn->data = bk->b[mid];
+	pn->rb = ( depth == bk->maxdepth && depth > 0 ) ? RED : BLACK;
+	pn->p = parent;
+	pn->lc = NULL;
+	pn->rc = NULL;
+	pn->lc = rbt_bulk_top( bk, lo, mid - 1, depth + 1, pn, &pn->lc, ok );
+	pn->rc = rbt_bulk_top( bk, mid + 1, hi, depth + 1, pn, &pn->rc, ok );
+
+	return pn;
+}
+
+/**
+ * @brief rbt_bulk_build - build red black tree from unsorted keys in parallel.
+ * @param proot pointer to the pointer to the root of red black tree,
+ *	  nodes in it are freed first.
+ * @param keys the keys, unsorted and may have duplicates.
+ * @param n count of keys.
+ * @param threads count of threads to use, at most RBT_BULK_THREADS.
+ * @return count of nodes in the tree,
+ *	   -1 for failure, the tree is empty.
+ *
+ * 排序和构造都是O(n)的顺序访存，不需要逐个插入时每层一次的指针追逐。
+ */
+long
+rbt_bulk_build( prbt *proot, const int *keys, long n, int threads )
+{
+	rbt_bulk *bk = NULL;
+	int sample[RBT_BULK_THREADS * RBT_BULK_SAMPLE];
+	int ns = 0;
+	int ok = 1;
+	int i = 0;
+	int j = 0;
+	long m = 0;
+	long sum = 0;
+	long c = 0;
+	char *slab = NULL;
+
+	rbt_destroy( proot );
+	if ( n <= 0 )
+		return 0;
+	bk = ( rbt_bulk * )calloc( 1, sizeof(rbt_bulk) );
+	if ( bk ) {
+		bk->a = ( int * )malloc( n * sizeof(int) );
+		bk->b = ( int * )malloc( n * sizeof(int) );
+	}
+	if ( !bk || !bk->a || !bk->b ) {
+		printf("No Memory!!\n");
+		if ( bk ) {
+			free( bk->a );
+			free( bk->b );
+		}
+		free( bk );
+		return -1;
+	}
+	/* 关键字太少时多线程得不偿失 */
+	threads = threads < RBT_BULK_THREADS ? threads : RBT_BULK_THREADS;
+	threads = threads < n / 4096 + 1 ? threads : (int)( n / 4096 + 1 );
+	bk->threads = threads > 0 ? threads : 1;
+	bk->keys = keys;
+	bk->n = n;
+
+	/* 抽样选出分隔值 */
+	ns = bk->threads * RBT_BULK_SAMPLE;
+	for ( i = 0; i < ns; i++ )
+		sample[i] = keys[n * i / ns];
+	qsort( sample, ns, sizeof(int), rbt_int_cmp );
+	for ( i = 1; i < bk->threads; i++ )
+		bk->split[i - 1] = sample[i * RBT_BULK_SAMPLE];
+
+	/* 分桶：统计个数，算出每个线程在每个桶中的写入位置，再分散 */
+	rbt_bulk_run( bk, RBT_BULK_COUNT );
+	for ( j = 0, sum = 0; j < bk->threads; j++ ) {
+		bk->start[j] = sum;
+		for ( i = 0; i < bk->threads; i++ ) {
+			c = bk->pos[i][j];
+			bk->pos[i][j] = sum;
+			sum += c;
+		}
+	}
+	bk->start[bk->threads] = sum;
+	rbt_bulk_run( bk, RBT_BULK_SCATTER );
+
+	/* 各桶排序去重，再拼接到b中 */
+	rbt_bulk_run( bk, RBT_BULK_SORT );
+	for ( j = 0; j < bk->threads; j++ ) {
+		bk->dst[j] = m;
+		m += bk->uniq[j];
+	}
+	rbt_bulk_run( bk, RBT_BULK_COPY );
+
+	/* 上层由调用线程构造，下面不少于threads棵子树并行构造 */
+	for ( c = m; c > 1; c >>= 1 )
+		bk->maxdepth++;
+	for ( bk->jobdepth = 0; ( 1 << bk->jobdepth ) < bk->threads; )
+		bk->jobdepth++;
+	(*proot) = rbt_bulk_top( bk, 0, m - 1, 0, NULL, proot, &ok );
+	for ( j = 0, c = 0; j < bk->njob; j++ )
+		c += bk->job[j].hi - bk->job[j].lo + 1;
+	if ( ok && c && rbt_arena && sizeof( rbt_node ) <= rbt_arena->size ) {
+		bk->stride = rbt_arena->size;
+		slab = ( char * )tarena_alloc_many( rbt_arena, c );
+		if ( !slab ) {
+			printf("No Memory!!\n");
+			ok = 0;
+		}
+		for ( j = 0, c = 0; slab && j < bk->njob; j++ ) {
+			bk->job[j].slab = slab + c * bk->stride;
+			c += bk->job[j].hi - bk->job[j].lo + 1;
+		}
+	}
+	for ( i = 0; i < bk->threads; i++ )
+		bk->ok[i] = ok;
+	if ( ok )
+		rbt_bulk_run( bk, RBT_BULK_BUILD );
+	for ( i = 0; i < bk->threads; i++ )
+		ok = ok && bk->ok[i];
+
+	free( bk->a );
+	free( bk->b );
+	free( bk );
+	if ( !ok ) {
+		rbt_destroy( proot );
+		return -1;
+	}
+
+	return m;
+}
+
+/**
+ * @brief rbt_log_sum - checksum of a log record.
+ */
+static unsigned short
+rbt_log_sum( int key, unsigned char op )
+{
+	unsigned int x = (unsigned int)key * 2654435761U ^ op;
+
+	return (unsigned short)( ( x >> 16 ) ^ x ^ 0x5a5a );
+}
+
+#define RBT_CKPT_MAGIC	0x32425443	/* "CTB2"，关键字之后带校验和 */
+
+/**
+ * @brief rbt_ckpt_sum - update the checksum of checkpoint with n keys.
+ * @param sum checksum of the keys before, the count of keys at first.
+ * @return checksum including the n keys.
+ *
+ * 逐个关键字做FNV-1a，任意位置的改动、交换或截断都会改变结果。
+ */
+static unsigned long long
+rbt_ckpt_sum( unsigned long long sum, const int *keys, long n )
+{
+	long i = 0;
+
+	for ( i = 0; i < n; i++ )
+		sum = ( sum ^ (unsigned int)keys[i] ) * 0x100000001b3ULL;
+
+	return sum;
+}
+
+/**
+ * @brief rbt_write_all - write the whole buffer, retry on partial write.
+ * @return 1 for succeed,
+ *	   0 for failure.
+ */
+static int
+rbt_write_all( int fd, const void *p, size_t n )
+{
+	const char *pc = ( const char * )p;
+	ssize_t w = 0;
+
+	for ( ; n; ) {
+		w = write( fd, pc, n );
+		if ( w < 0 && EINTR == errno )
+			continue;
+		if ( w <= 0 )
+			return 0;
+		pc += w;
+		n -= w;
+	}
+
+	return 1;
+}
+
+/**
+ * @brief rbt_read_all - read exactly n bytes, retry on partial read.
+ * @return 1 for succeed,
+ *	   0 for failure or end of file.
+ */
+static int
+rbt_read_all( int fd, void *p, size_t n )
+{
+	char *pc = ( char * )p;
+	ssize_t r = 0;
+
+	for ( ; n; ) {
+		r = read( fd, pc, n );
+		if ( r < 0 && EINTR == errno )
+			continue;
+		if ( r <= 0 )
+			return 0;
+		pc += r;
+		n -= r;
+	}
+
+	return 1;
+}
+
+/**
+ * @brief rbt_durable_load - load the checkpoint, then replay the log tail.
+ * @param d pointer to the durable tree.
+ * @return 1 for succeed,
+ *	   0 for failure.
+ */
+static int
+rbt_durable_load( prbt_durable d )
+{
+	rbt_log_rec recs[1024];
+	long long count = 0;
+	unsigned long long sum = 0;
+	unsigned int magic = 0;
+	int *keys = NULL;
+	int fd = -1;
+	int ok = 1;
+	int maxdepth = 0;
+	long i = 0;
+	long n = 0;
+	off_t valid = 0;
+	ssize_t r = 0;
+
+	fd = open( d->ckpt_path, O_RDONLY );
+	if ( fd >= 0 ) {
+		/* count来自文件，先确认count*sizeof(int)不会溢出再分配 */
+		if ( !rbt_read_all( fd, &magic, sizeof(magic) ) || RBT_CKPT_MAGIC != magic
+		     || !rbt_read_all( fd, &count, sizeof(count) ) || count < 0
+		     || (unsigned long long)count > ( (size_t)-1 >> 1 ) / sizeof(int) ) {
+			printf("Bad checkpoint %s!!\n", d->ckpt_path);
+			close( fd );
+			return 0;
+		}
+		keys = ( int * )malloc( ( count ? count : 1 ) * sizeof(int) );
+		if ( !keys ) {
+			printf("No Memory!!\n");
+			close( fd );
+			return 0;
+		}
+		/* 写了一半或被破坏的检查点不能构造成红黑树：校验和必须一致，
+		 * 关键字必须严格递增 */
+		ok = rbt_read_all( fd, keys, count * sizeof(int) ) && rbt_read_all( fd, &sum, sizeof(sum) )
+		     && rbt_ckpt_sum( (unsigned long long)count, keys, count ) == sum;
+		for ( i = 1; ok && i < count; i++ )
+			ok = keys[i - 1] < keys[i];
+		close( fd );
+		if ( !ok ) {
+			printf("Bad checkpoint %s!!\n", d->ckpt_path);
+			free( keys );
+			return 0;
+		}
+		for ( n = count; n > 1; n >>= 1 )
+			maxdepth++;
+		d->root = rbt_build_sorted( keys, 0, count - 1, 0, maxdepth, NULL, &ok, NULL );
+		d->size = count;
+		free( keys );
+		if ( !ok ) {
+			rbt_destroy( &d->root );
+			d->size = 0;
+			return 0;
+		}
+	}
+
+	/* 重放日志，截断尾部不完整的记录 */
+	for ( ; ( r = read( d->log_fd, recs, sizeof(recs) ) ) > 0; ) {
+		n = r / sizeof(rbt_log_rec);
+		for ( i = 0; i < n; i++ ) {
+			if ( recs[i].sum != rbt_log_sum( recs[i].key, recs[i].op ) )
+				break;
+			if ( RBT_LOG_INSERT == recs[i].op )
+				d->size += rbt_insert( &d->root, recs[i].key );
+			else if ( RBT_LOG_DELETE == recs[i].op )
+				d->size -= rbt_delete( &d->root, recs[i].key );
+			else
+				break;
+			valid += sizeof(rbt_log_rec);
+		}
+		if ( i < n || r % sizeof(rbt_log_rec) )
+			break;
+	}
+	if ( ftruncate( d->log_fd, valid ) < 0 ) {
+		printf("Truncate log %s failed!!\n", d->log_path);
+		return 0;
+	}
+
+	return 1;
+}
+
+/**
+ * @brief rbt_durable_open - open a durable red black tree, recover it from disk.
+ * @param d pointer to the durable tree.
+ * @param path the prefix of log and checkpoint file.
+ * @param batch how many operations are committed together, at least 1.
+ * @param ckpt_every how many operations between checkpoints, 0 for never.
+ * @return 1 for succeed,
+ *	   0 for failure.
+ */
+int
+rbt_durable_open( prbt_durable d, const char *path, int batch, long ckpt_every )
+{
+	size_t len = strlen( path ) + 8;
+
+	memset( d, 0, sizeof(rbt_durable) );
+	d->batch = batch > 0 ? batch : 1;
+	d->ckpt_every = ckpt_every;
+	d->log_path = ( char * )malloc( len );
+	d->ckpt_path = ( char * )malloc( len );
+	if ( !d->log_path || !d->ckpt_path ) {
+		printf("No Memory!!\n");
+		free( d->log_path );
+		free( d->ckpt_path );
+		return 0;
+	}
+	snprintf( d->log_path, len, "%s.log", path );
+	snprintf( d->ckpt_path, len, "%s.ckpt", path );
+	pthread_mutex_init( &d->lock, NULL );
+	pthread_cond_init( &d->cond, NULL );
+	d->log_fd = open( d->log_path, O_RDWR | O_CREAT | O_APPEND, 0644 );
+	if ( d->log_fd < 0 ) {
+		printf("Open log %s failed!!\n", d->log_path);
+		rbt_durable_close( d );
+		return 0;
+	}
+	if ( !rbt_durable_load( d ) ) {
+		rbt_durable_close( d );
+		return 0;
+	}
+
+	return 1;
+}
+
+/**
+ * @brief rbt_log_append - append a record to the log buffer, lock must be held.
+ * @return 1 for succeed,
+ *	   0 for failure.
+ */
+static int
+rbt_log_append( prbt_durable d, int key, unsigned char op )
+{
+	rbt_log_rec *buf = NULL;
+	long cap = 0;
+
+	if ( d->buf_len == d->buf_cap ) {
+		cap = d->buf_cap ? d->buf_cap * 2 : 256;
+		buf = ( rbt_log_rec * )realloc( d->buf, cap * sizeof(rbt_log_rec) );
+		if ( !buf ) {
+			printf("No Memory!!\n");
+			return 0;
+		}
+		d->buf = buf;
+		d->buf_cap = cap;
+	}
+	d->buf[d->buf_len].key = key;
+	d->buf[d->buf_len].op = op;
+	d->buf[d->buf_len].pad = 0;
+	d->buf[d->buf_len].sum = rbt_log_sum( key, op );
+	d->buf_len++;
+	d->lsn++;
+
+	return 1;
+}
+
+/**
+ * @brief rbt_log_commit - group commit until record lsn is on disk, lock must be held.
+ * @param d pointer to the durable tree.
+ * @param lsn the sequence number to wait for.
+ * @return 1 for succeed,
+ *	   0 for failure.
+ *
+ * 没有领导者时当前线程成为领导者：交换两个缓冲区后释放锁，写盘并
+ * fdatasync，期间其他线程继续向新缓冲区追加记录；有领导者时等待。
+ */
+static int
+rbt_log_commit( prbt_durable d, unsigned long long lsn )
+{
+	rbt_log_rec *buf = NULL;
+	unsigned long long target = 0;
+	long len = 0;
+	long cap = 0;
+	int ok = 0;
+
+	for ( ; d->synced < lsn && !d->error; ) {
+		if ( d->flushing ) {
+			pthread_cond_wait( &d->cond, &d->lock );
+			continue;
+		}
+		d->flushing = 1;
+		buf = d->buf;
+		len = d->buf_len;
+		cap = d->buf_cap;
+		d->buf = d->spare;
+		d->buf_cap = d->spare_cap;
+		d->buf_len = 0;
+		d->spare = buf;
+		d->spare_cap = cap;
+		target = d->lsn;
+		pthread_mutex_unlock( &d->lock );
+		ok = rbt_write_all( d->log_fd, buf, len * sizeof(rbt_log_rec) )
+		     && 0 == fdatasync( d->log_fd );
+		pthread_mutex_lock( &d->lock );
+		d->flushing = 0;
+		if ( ok ) {
+			d->synced = target;
+		} else {
+			printf("Write log %s failed!!\n", d->log_path);
+			d->error = 1;
+		}
+		pthread_cond_broadcast( &d->cond );
+	}
+
+	return !d->error;
+}
+
+/**
+ * @brief rbt_checkpoint_locked - write sorted keys to checkpoint and clear the log.
+ * @param d pointer to the durable tree, lock must be held.
+ * @return 1 for succeed,
+ *	   0 for failure.
+ */
+static int
+rbt_checkpoint_locked( prbt_durable d )
+{
+	int chunk[1024];
+	unsigned int magic = RBT_CKPT_MAGIC;
+	long long count = d->size;
+	unsigned long long sum = (unsigned long long)count;
+	size_t len = strlen( d->ckpt_path ) + 5;
+	char *tmp = NULL;
+	char *slash = NULL;
+	prbt pn = d->root;
+	int fd = -1;
+	int n = 0;
+	int ok = 1;
+
+	for ( ; d->flushing; )
+		pthread_cond_wait( &d->cond, &d->lock );
+	tmp = ( char * )malloc( len );
+	if ( !tmp ) {
+		printf("No Memory!!\n");
+		return 0;
+	}
+	snprintf( tmp, len, "%s.tmp", d->ckpt_path );
+	fd = open( tmp, O_WRONLY | O_CREAT | O_TRUNC, 0644 );
+	if ( fd < 0 ) {
+		printf("Open checkpoint %s failed!!\n", tmp);
+		free( tmp );
+		return 0;
+	}
+	ok = rbt_write_all( fd, &magic, sizeof(magic) ) && rbt_write_all( fd, &count, sizeof(count) );
+	for ( ; pn && pn->lc; )
+		pn = pn->lc;
+	for ( ; ok && pn; pn = tree_successor( pn ) ) {
+		chunk[n++] = pn->data;
+		if ( 1024 == n ) {
+			sum = rbt_ckpt_sum( sum, chunk, n );
+			ok = rbt_write_all( fd, chunk, sizeof(chunk) );
+			n = 0;
+		}
+	}
+	sum = rbt_ckpt_sum( sum, chunk, n );
+	ok = ok && rbt_write_all( fd, chunk, n * sizeof(int) ) && rbt_write_all( fd, &sum, sizeof(sum) )
+	     && 0 == fsync( fd );
+	close( fd );
+	ok = ok && 0 == rename( tmp, d->ckpt_path );
+	free( tmp );
+	if ( ok ) {
+		/* 同步目录项，保证重命名落盘 */
+		slash = strrchr( d->ckpt_path, '/' );
+		if ( slash ) {
+			*slash = '\0';
+			fd = open( slash == d->ckpt_path ? "/" : d->ckpt_path, O_RDONLY );
+			*slash = '/';
+		} else {
+			fd = open( ".", O_RDONLY );
+		}
+		if ( fd >= 0 ) {
+			fsync( fd );
+			close( fd );
+		}
+		ok = 0 == ftruncate( d->log_fd, 0 ) && 0 == fdatasync( d->log_fd );
+	}
+	if ( !ok ) {
+		printf("Checkpoint %s failed!!\n", d->ckpt_path);
+		return 0;
+	}
+	/* 缓冲区中的记录已经包含在检查点中 */
+	d->buf_len = 0;
+	d->synced = d->lsn;
+	d->since_ckpt = 0;
+	pthread_cond_broadcast( &d->cond );
+
+	return 1;
+}
+
+/**
+ * @brief rbt_durable_apply - log an operation, apply it and commit, lock must be held.
+ * @param d pointer to the durable tree.
+ * @param key the enum to insert or delete, caller has checked it takes effect.
+ * @param op RBT_LOG_INSERT or RBT_LOG_DELETE.
+ * @return 1 for succeed,
+ *	   RBT_EIO for failure.
+ *
+ * 先追加日志记录再修改树；修改树失败（插入时内存不足）时撤销刚追加的
+ * 记录，持有锁期间缓冲区不会被交换，该记录一定在缓冲区末尾。
+ * 检查点失败时日志缓冲区没有清空，退回到普通的组提交。
+ */
+static int
+rbt_durable_apply( prbt_durable d, int key, unsigned char op )
+{
+	if ( !rbt_log_append( d, key, op ) )
+		return RBT_EIO;
+	if ( RBT_LOG_INSERT == op ? !rbt_insert( &d->root, key ) : !rbt_delete( &d->root, key ) ) {
+		d->buf_len--;
+		d->lsn--;
+		return RBT_EIO;
+	}
+	d->size += ( RBT_LOG_INSERT == op ) ? 1 : -1;
+	if ( d->ckpt_every && ++d->since_ckpt >= d->ckpt_every && rbt_checkpoint_locked( d ) )
+		return 1;
+	if ( d->lsn - d->synced >= (unsigned long long)d->batch && !rbt_log_commit( d, d->lsn ) )
+		return RBT_EIO;
+
+	return 1;
+}
+
+/**
+ * @brief rbt_durable_insert - insert an enum into durable red black tree.
+ * @param d pointer to the durable tree.
+ * @param e the enum to insert.
+ * @return 1 for succeed (on disk if batch is 1),
+ *	   0 for already exists,
+ *	   RBT_EIO for out of memory or log failure.
+ */
+int
+rbt_durable_insert( prbt_durable d, int e )
+{
+	int ret = RBT_EIO;
+
+	pthread_mutex_lock( &d->lock );
+	if ( d->error )
+		ret = RBT_EIO;
+	else if ( rbt_search1( d->root, e ) )
+		ret = 0;
+	else
+		ret = rbt_durable_apply( d, e, RBT_LOG_INSERT );
+	pthread_mutex_unlock( &d->lock );
+
+	return ret;
+}
+
+/**
+ * @brief rbt_durable_delete - delete an enum from durable red black tree.
+ * @param d pointer to the durable tree.
+ * @param key the enum to delete.
+ * @return 1 for succeed (on disk if batch is 1),
+ *	   0 for not exists,
+ *	   RBT_EIO for out of memory or log failure.
+ */
+int
+rbt_durable_delete( prbt_durable d, int key )
+{
+	int ret = RBT_EIO;
+
+	pthread_mutex_lock( &d->lock );
+	if ( d->error )
+		ret = RBT_EIO;
+	else if ( !rbt_search1( d->root, key ) )
+		ret = 0;
+	else
+		ret = rbt_durable_apply( d, key, RBT_LOG_DELETE );
+	pthread_mutex_unlock( &d->lock );
+
+	return ret;
+}
+
+/**
+ * @brief rbt_durable_search - searching key in durable red black tree.
+ * @return 1 for found,
+ *	   0 for not exists.
+ */
+int
+rbt_durable_search( prbt_durable d, int key )
+{
+	int found = 0;
+
+	pthread_mutex_lock( &d->lock );
+	found = ( NULL != rbt_search1( d->root, key ) );
+	pthread_mutex_unlock( &d->lock );
+
+	return found;
+}
+
+/**
+ * @brief rbt_durable_sync - commit all operations logged.
+ * @return 1 for succeed,
+ *	   0 for failure.
+ */
+int
+rbt_durable_sync( prbt_durable d )
+{
+	int ret = 0;
+
+	pthread_mutex_lock( &d->lock );
+	ret = rbt_log_commit( d, d->lsn );
+	pthread_mutex_unlock( &d->lock );
+
+	return ret;
+}
+
+/**
+ * @brief rbt_durable_checkpoint - take a checkpoint now.
+ * @return 1 for succeed,
+ *	   0 for failure.
+ */
+int
+rbt_durable_checkpoint( prbt_durable d )
+{
+	int ret = 0;
+
+	pthread_mutex_lock( &d->lock );
+	ret = rbt_checkpoint_locked( d );
+	pthread_mutex_unlock( &d->lock );
+
+	return ret;
+}
+
+/**
+ * @brief rbt_durable_close - commit the log and free the tree.
+ * @return 1 for succeed,
+ *	   0 for failure.
+ */
+int
+rbt_durable_close( prbt_durable d )
+{
+	int ret = 1;
+
+	if ( d->log_fd >= 0 ) {
+		ret = rbt_durable_sync( d );
+		close( d->log_fd );
+		d->log_fd = -1;
+	}
+	rbt_destroy( &d->root );
+	free( d->buf );
+	free( d->spare );
+	free( d->log_path );
+	free( d->ckpt_path );
+	d->buf = NULL;
+	d->spare = NULL;
+	d->log_path = NULL;
+	d->ckpt_path = NULL;
+	pthread_mutex_destroy( &d->lock );
+	pthread_cond_destroy( &d->cond );
+
+	return ret;
+}
+
+/**
+ * @brief rbt_hash_slot - find the slot of key, or the empty slot to put it.
+ * @param t pointer to the hashed red black tree.
+ * @param key the key to hash.
+ * @return the index of slot.
+ *
+ * 斐波那契乘法散列，取乘积的高位，线性探测。
+ */
+static unsigned long
+rbt_hash_slot( prbt_hashed t, int key )
+{
+	unsigned long i = (unsigned long)( ( (unsigned long long)(unsigned int)key * 
+			  0x9E3779B97F4A7C15ULL ) >> t->shift );
+
+	for ( ; t->slot[i].node && t->slot[i].key != key; )
+		i = ( i + 1 ) & t->mask;
+
+	return i;
+}
+
+/**
+ * @brief rbt_hash_resize - allocate a table of cap slots and rehash.
+ * @param t pointer to the hashed red black tree.
+ * @param cap count of slots, must be power of 2.
+ * @return 1 for succeed,
+ *	   0 for failure.
+ */
+static int
+rbt_hash_resize( prbt_hashed t, unsigned long cap )
+{
+	rbt_hash_entry *old = t->slot;
+	unsigned long old_cap = old ? t->mask + 1 : 0;
+	unsigned long i = 0;
+	int shift = 64;
+
+	t->slot = ( rbt_hash_entry * )calloc( cap, sizeof(rbt_hash_entry) );
+	if ( !t->slot ) {
+		printf("No Memory!!\n");
+		t->slot = old;
+		return 0;
+	}
+	for ( ; ( 1UL << ( 64 - shift ) ) < cap; )
+		shift--;
+	t->mask = cap - 1;
+	t->shift = shift;
+	for ( i = 0; i < old_cap; i++ )
+		if ( old[i].node )
+			t->slot[rbt_hash_slot( t, old[i].key )] = old[i];
+	free( old );
+
+	return 1;
+}
+
+/**
+ * @brief rbt_hashed_init - initialize the hashed red black tree.
+ * @param t pointer to the hashed red black tree.
+ * @param hint expected count of keys, used to size the table, may be 0.
+ * @return 1 for succeed,
+ *	   0 for failure.
+ */
+int
+rbt_hashed_init( prbt_hashed t, long hint )
+{
+	unsigned long cap = RBT_HASH_MIN;
+
+	t->root = NULL;
+	t->size = 0;
+	t->slot = NULL;
+	for ( ; cap < 2 * (unsigned long)( hint > 0 ? hint : 0 ); )
+		cap <<= 1;
+
+	return rbt_hash_resize( t, cap );
+}
+
+/**
+ * @brief rbt_hashed_search - searching key through the hash index.
+ * @param t pointer to the hashed red black tree.
+ * @param key the enum to search.
+ * @return prbt pointer to the node of red black tree if found,
+ *	   NULL pointer if key not found.
+ *
+ * 槽中保存关键字，探测时不需要访问树节点，平均一次缓存缺失。
+ */
+prbt
+rbt_hashed_search( prbt_hashed t, int key )
+{
+	return t->slot[rbt_hash_slot( t, key )].node;
+}
+
+/**
+ * @brief rbt_hashed_insert - insert an enum into tree and hash index.
+ * @param t pointer to the hashed red black tree.
+ * @param e the enum to insert.
+ * @return 1 for succeed,
+ *	   0 for failure.
+ *
+ * 先查散列表排除重复关键字，装载因子超过1/2时表扩大一倍。
+ */
+int
+rbt_hashed_insert( prbt_hashed t, int e )
+{
+	unsigned long i = rbt_hash_slot( t, e );
+	prbt pe = NULL;
+
+	if ( t->slot[i].node )
+		return 0;
+	if ( 2 * (unsigned long)( t->size + 1 ) > t->mask + 1 ) {
+		if ( !rbt_hash_resize( t, 2 * ( t->mask + 1 ) ) )
+			return 0;
+		i = rbt_hash_slot( t, e );
+	}
+	pe = rbt_insert_ptr( &t->root, e );
+	if ( !pe )
+		return 0;
+	t->slot[i].key = e;
+	t->slot[i].node = pe;
+	t->size++;
+
+	return 1;
+}
+
+/**
+ * @brief rbt_hashed_delete - delete an enum from tree and hash index.
+ * @param t pointer to the hashed red black tree.
+ * @param key the enum to delete.
+ * @return 1 for succeed,
+ *	   0 for failure.
+ *
+ * 从散列表直接得到节点，树中不必再查找。线性探测删除时不留墓碑：
+ * 把后面同一探测序列中的元素向前移动填补空槽。
+ */
+int
+rbt_hashed_delete( prbt_hashed t, int key )
+{
+	unsigned long i = rbt_hash_slot( t, key );
+	unsigned long j = i;
+	unsigned long h = 0;
+	prbt pn = t->slot[i].node;
+
+	if ( !pn )
+		return 0;
+	rbt_delete_node( &t->root, pn );
+	for ( ;; ) {
+		t->slot[i].node = NULL;
+		for ( ;; ) {
+			j = ( j + 1 ) & t->mask;
+			if ( !t->slot[j].node ) {
+				t->size--;
+				return 1;
+			}
+			h = (unsigned long)( ( (unsigned long long)(unsigned int)t->slot[j].key * 
+			    0x9E3779B97F4A7C15ULL ) >> t->shift );
+			/* h不在(i, j]之间时，j处的元素可以移到i */
+			if ( i <= j ? ( h <= i || h > j ) : ( h <= i && h > j ) )
+				break;
+		}
+		t->slot[i] = t->slot[j];
+		i = j;
+	}
+}
+
+/**
+ * @brief rbt_hashed_destroy - destroy the tree and hash index.
+ * @param t pointer to the hashed red black tree.
+ * @return 0 for success.
+ */
+int
+rbt_hashed_destroy( prbt_hashed t )
+{
+	rbt_destroy( &t->root );
+	free( t->slot );
+	t->slot = NULL;
+	t->size = 0;
+
+	return 0;
+}
+
+/**
+ * @brief rbt_buffered_init - initialize the buffered red black tree.
+ * @param t pointer to the buffered red black tree.
+ * @param cap capacity of the buffer, 0 for RBT_BUF_CAP.
+ * @return 1 for succeed,
+ *	   0 for failure.
+ */
+int
+rbt_buffered_init( prbt_buffered t, int cap )
+{
+	t->root = NULL;
+	t->size = 0;
+	t->len = 0;
+	t->cap = cap > 0 ? cap : RBT_BUF_CAP;
+	t->buf = ( rbt_buf_entry * )malloc( t->cap * sizeof(rbt_buf_entry) );
+	if ( !t->buf ) {
+		printf("No Memory!!\n");
+		return 0;
+	}
+
+	return 1;
+}
+
+/**
+ * @brief rbt_buf_find - find the first entry not less than key.
+ * @return index of the entry, t->len if all entries are less than key.
+ */
+static int
+rbt_buf_find( prbt_buffered t, int key )
+{
+	int lo = 0;
+	int hi = t->len;
+	int mid = 0;
+
+	for ( ; lo < hi; ) {
+		mid = ( lo + hi ) / 2;
+		if ( t->buf[mid].key < key )
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	return lo;
+}
+
+/**
+ * @brief rbt_buffered_search - searching key in buffer and tree.
+ * @param t pointer to the buffered red black tree.
+ * @param key the enum to search.
+ * @return 1 for found,
+ *	   0 for not found.
+ */
+int
+rbt_buffered_search( prbt_buffered t, int key )
+{
+	int i = rbt_buf_find( t, key );
+
+	if ( i < t->len && t->buf[i].key == key )
+		return RBT_LOG_INSERT == t->buf[i].op;
+
+	return rbt_search1( t->root, key ) != NULL;
+}
+
+/**
+ * @brief rbt_buf_put - record an operation in the buffer.
+ * @return 1 for succeed,
+ *	   0 for failure.
+ *
+ * 缓冲区满时先合并到树中，合并因缺少内存而未完成时放弃本次操作。
+ */
+static int
+rbt_buf_put( prbt_buffered t, int key, int op )
+{
+	int i = rbt_buf_find( t, key );
+
+	if ( i < t->len && t->buf[i].key == key ) {
+		t->buf[i].op = op;
+		return 1;
+	}
+	if ( t->len == t->cap ) {
+		rbt_buffered_flush( t );
+		if ( t->len == t->cap )
+			return 0;
+		i = rbt_buf_find( t, key );
+	}
+	memmove( t->buf + i + 1, t->buf + i, ( t->len - i ) * sizeof(rbt_buf_entry) );
+	t->buf[i].key = key;
+	t->buf[i].op = op;
+	t->len++;
+
+	return 1;
+}
+
+/**
+ * @brief rbt_buffered_insert - insert an enum through the buffer.
+ * @param t pointer to the buffered red black tree.
+ * @param e the enum to insert.
+ * @return 1 for succeed,
+ *	   0 for failure.
+ */
+int
+rbt_buffered_insert( prbt_buffered t, int e )
+{
+	return rbt_buf_put( t, e, RBT_LOG_INSERT );
+}
+
+/**
+ * @brief rbt_buffered_delete - delete an enum through the buffer.
+ * @param t pointer to the buffered red black tree.
+ * @param key the enum to delete.
+ * @return 1 for succeed,
+ *	   0 for failure.
+ */
+int
+rbt_buffered_delete( prbt_buffered t, int key )
+{
+	return rbt_buf_put( t, key, RBT_LOG_DELETE );
+}
+
+/**
+ * @brief rbt_finger - search key starting from hint instead of the root.
+ * @param proot pointer to the root of red black tree.
+ * @param hint a node whose key is less than key, NULL to start from root.
+ * @param key the enum to search.
+ * @param parent to store the last node on the search path.
+ * @return prbt pointer to the node if found,
+ *	   NULL pointer if key not found.
+ *
+ * 从hint沿双亲上升，双亲的关键字不大于key时继续，否则key一定落在当前
+ * 子树的范围内（子树中有hint，小于key；双亲大于key），从这里向下查找。
+ */
+static prbt
+rbt_finger( prbt proot, prbt hint, int key, prbt *parent )
+{
+	prbt pn = hint ? hint : proot;
+
+	*parent = NULL;
+	if ( !pn )
+		return NULL;
+	for ( ; pn->p && pn->p->data <= key; )
+		pn = pn->p;
+
+	return rbt_search2( pn, key, parent ) ? *parent : NULL;
+}
+
+/**
+ * @brief rbt_buf_warm - bring the search paths of n entries into cache.
+ * @param proot pointer to the root of red black tree.
+ * @param e the entries, n is at most RBT_BUF_LANES.
+ * @param n count of entries.
+ *
+ * 逐个下降时每层都要等一次缓存缺失。这里n个关键字同时下降，每一轮
+ * 每个关键字前进一层并预取下一层的节点，n次缺失重叠在一起等待，
+ * 之后真正插入、删除时路径上的节点已经在缓存中。只读不写。
+ */
+static void
+rbt_buf_warm( prbt proot, const rbt_buf_entry *e, int n )
+{
+	prbt cur[RBT_BUF_LANES];
+	int active = n;
+	int i = 0;
+
+	for ( i = 0; i < n; i++ )
+		cur[i] = proot;
+	for ( ; active; ) {
+		active = 0;
+		for ( i = 0; i < n; i++ ) {
+			if ( !cur[i] || e[i].key == cur[i]->data ) {
+				cur[i] = NULL;
+				continue;
+			}
+			cur[i] = e[i].key < cur[i]->data ? cur[i]->lc : cur[i]->rc;
+			if ( cur[i] ) {
+				__builtin_prefetch( cur[i] );
+				active++;
+			}
+		}
+	}
+}
+
+/**
+ * @brief rbt_buffered_flush - merge the buffer into the tree.
+ * @param t pointer to the buffered red black tree.
+ * @return count of nodes inserted or deleted.
+ *
+ * 旋转和删除都不改变节点与关键字的对应关系，上一个插入的节点和被删
+ * 节点的前驱在之后的操作中一直有效，可以作为下一个关键字的起点。
+ * 分配节点失败时停止，未合并的操作留在缓冲区中。
+ */
+long
+rbt_buffered_flush( prbt_buffered t )
+{
+	prbt hint = NULL;
+	prbt parent = NULL;
+	prbt pn = NULL;
+	long changed = 0;
+	int i = 0;
+
+	for ( i = 0; i < t->len; i++ ) {
+		if ( 0 == i % RBT_BUF_LANES )
+			rbt_buf_warm( t->root, t->buf + i,
+				      t->len - i < RBT_BUF_LANES ? t->len - i : RBT_BUF_LANES );
+		pn = rbt_finger( t->root, hint, t->buf[i].key, &parent );
+		if ( RBT_LOG_INSERT == t->buf[i].op ) {
+			if ( !pn ) {
+				pn = rbt_insert_at( &t->root, parent, t->buf[i].key );
+				if ( !pn )
+					break;
+				t->size++;
+				changed++;
+			}
+			hint = pn;
+		} else if ( pn ) {
+			hint = tree_predecessor( pn );
+			rbt_delete_node( &t->root, pn );
+			t->size--;
+			changed++;
+		}
+	}
+	t->len -= i;
+	memmove( t->buf, t->buf + i, t->len * sizeof(rbt_buf_entry) );
+
+	return changed;
+}
+
+/**
+ * @brief rbt_buffered_destroy - destroy the tree and buffer.
+ * @param t pointer to the buffered red black tree.
+ * @return 0 for success.
+ */
+int
+rbt_buffered_destroy( prbt_buffered t )
+{
+	rbt_destroy( &t->root );
+	free( t->buf );
+	t->buf = NULL;
+	t->size = 0;
+	t->len = 0;
+
+	return 0;
+}
+
+/* 以下为演示和性能测试，作为库与其他模块一起编译时定义RBT_NO_MAIN去掉 */
+#ifndef RBT_NO_MAIN
+
+#define HASH_KEYS	( 1 << 20 )
+#define HASH_GETS	( 1 << 22 )
+
+/**
+ * @brief hash_bench - random point lookups, by descent and by hash index.
+ */
+static void
+hash_bench( void )
+{
+	rbt_hashed t;
+	struct timespec t0;
+	struct timespec t1;
+	double tree = 0;
+	double hash = 0;
+	long hit = 0;
+	int *keys = ( int * )malloc( HASH_GETS * sizeof(int) );
+	int i = 0;
+
+	if ( !keys ) {
+		printf("No Memory!!\n");
+		return;
+	}
+	rbt_hashed_init( &t, HASH_KEYS );
+	for ( i = 0; i < HASH_KEYS; i++ )
+		rbt_hashed_insert( &t, rand() % ( 2 * HASH_KEYS ) );
+	for ( i = 0; i < HASH_GETS; i++ )
+		keys[i] = rand() % ( 2 * HASH_KEYS );
+	clock_gettime( CLOCK_MONOTONIC, &t0 );
+	for ( i = 0; i < HASH_GETS; i++ )
+		hit += ( rbt_search1( t.root, keys[i] ) != NULL );
+	clock_gettime( CLOCK_MONOTONIC, &t1 );
+	tree = ( t1.tv_sec - t0.tv_sec ) + ( t1.tv_nsec - t0.tv_nsec ) / 1e9;
+	clock_gettime( CLOCK_MONOTONIC, &t0 );
+	for ( i = 0; i < HASH_GETS; i++ )
+		hit -= ( rbt_hashed_search( &t, keys[i] ) != NULL );
+	clock_gettime( CLOCK_MONOTONIC, &t1 );
+	hash = ( t1.tv_sec - t0.tv_sec ) + ( t1.tv_nsec - t0.tv_nsec ) / 1e9;
+	printf("%ld keys, get: rbt_search1 %.1f ns, rbt_hashed_search %.1f ns%s.\n",
+		t.size, tree * 1e9 / HASH_GETS, hash * 1e9 / HASH_GETS, hit ? ", results differ" : "");
+	rbt_hashed_destroy( &t );
+	free( keys );
+}
+
+#define ARENA_KEYS	( 1 << 21 )
+#define ARENA_GETS	( 1 << 21 )
+
+/**
+ * @brief arena_run - build a tree and time random lookups.
+ * @param a pointer to the arena, NULL for malloc.
+ * @param keys keys to insert, then to search.
+ * @param name name of the configuration.
+ */
+static void
+arena_run( ptree_arena a, const int *keys, const char *name )
+{
+	prbt proot = NULL;
+	tree_arena_stats st;
+	struct timespec t0;
+	struct timespec t1;
+	double sec = 0;
+	long hit = 0;
+	int i = 0;
+
+	rbt_arena = a;
+	for ( i = 0; i < ARENA_KEYS; i++ )
+		rbt_insert( &proot, keys[i] );
+	clock_gettime( CLOCK_MONOTONIC, &t0 );
+	for ( i = 0; i < ARENA_GETS; i++ )
+		hit += ( rbt_search1( proot, keys[( i * 7919L ) % ARENA_KEYS] ) != NULL );
+	clock_gettime( CLOCK_MONOTONIC, &t1 );
+	sec = ( t1.tv_sec - t0.tv_sec ) + ( t1.tv_nsec - t0.tv_nsec ) / 1e9;
+	printf("%-12s %.1f ns/get", name, sec * 1e9 / ARENA_GETS);
+	if ( a && tarena_stats( a, &st ) ) {
+		printf(", %.0f MB resident, %.0f MB in huge pages, %ld TLB entries, %ld/%ld pages remote",
+			st.resident / 1048576.0, st.huge / 1048576.0, st.tlb_pages, st.remote, st.sampled);
+	}
+	printf("%s.\n", hit == ARENA_GETS ? "" : ", keys missing");
+	rbt_destroy( &proot );
+	rbt_arena = NULL;
+}
+
+/**
+ * @brief arena_bench - compare malloc, arena with 4KB pages and with huge pages.
+ */
+static void
+arena_bench( void )
+{
+	tree_arena a;
+	int *keys = ( int * )malloc( ARENA_KEYS * sizeof(int) );
+	int i = 0;
+
+	if ( !keys ) {
+		printf("No Memory!!\n");
+		return;
+	}
+	for ( i = 0; i < ARENA_KEYS; i++ )
+		keys[i] = i * 2;
+	for ( i = ARENA_KEYS - 1; i > 0; i-- ) {
+		int j = rand() % ( i + 1 );
+		int tmp = keys[i];
+		keys[i] = keys[j];
+		keys[j] = tmp;
+	}
+	arena_run( NULL, keys, "malloc" );
+	if ( tarena_init( &a, sizeof(rbt_node), (size_t)ARENA_KEYS * sizeof(rbt_node), 
+			  TARENA_DEFAULT, 0 ) ) {
+		arena_run( &a, keys, "arena 4KB" );
+		tarena_destroy( &a );
+	}
+	if ( tarena_init( &a, sizeof(rbt_node), (size_t)ARENA_KEYS * sizeof(rbt_node), 
+			  TARENA_HUGE | TARENA_INTERLEAVE, ~0UL ) ) {
+		arena_run( &a, keys, "arena 2MB" );
+		tarena_destroy( &a );
+	}
+	free( keys );
+}
+
+#define BULK_KEYS	( 1 << 22 )
+
+/**
+ * @brief bulk_bench - compare rbt_insert with rbt_bulk_build on unsorted keys.
+ */
+static void
+bulk_bench( void )
+{
+	struct timespec t0;
+	struct timespec t1;
+	double sec = 0;
+	int *keys = ( int * )malloc( BULK_KEYS * sizeof(int) );
+	prbt proot = NULL;
+	long n = 0;
+	int i = 0;
+
+	if ( !keys ) {
+		printf("No Memory!!\n");
+		return;
+	}
+	for ( i = 0; i < BULK_KEYS; i++ )
+		keys[i] = rand();
+	clock_gettime( CLOCK_MONOTONIC, &t0 );
+	for ( i = 0; i < BULK_KEYS; i++ )
+		n += rbt_insert( &proot, keys[i] );
+	clock_gettime( CLOCK_MONOTONIC, &t1 );
+	sec = ( t1.tv_sec - t0.tv_sec ) + ( t1.tv_nsec - t0.tv_nsec ) / 1e9;
+	printf("%d keys, rbt_insert:       %.1f ms, %ld nodes.\n", BULK_KEYS, sec * 1e3, n);
+	rbt_destroy( &proot );
+	for ( i = 1; i <= 4; i *= 2 ) {
+		clock_gettime( CLOCK_MONOTONIC, &t0 );
+		n = rbt_bulk_build( &proot, keys, BULK_KEYS, i );
+		clock_gettime( CLOCK_MONOTONIC, &t1 );
+		sec = ( t1.tv_sec - t0.tv_sec ) + ( t1.tv_nsec - t0.tv_nsec ) / 1e9;
+		printf("%d keys, rbt_bulk_build %d: %.1f ms, %ld nodes.\n", BULK_KEYS, i, sec * 1e3, n);
+		rbt_destroy( &proot );
+	}
+	free( keys );
+}
+
+#define BUF_TREE	( 1 << 20 )
+#define BUF_WRITES	( 1 << 20 )
+
+/**
+ * @brief buffered_bench - a burst of random writes into a large tree.
+ *
+ * 树中预先有BUF_TREE个关键字，再写入BUF_WRITES个，其中1/4为删除，
+ * 比较直接rbt_insert/rbt_delete与经过不同容量缓冲区的时间，
+ * 最后逐个比较两棵树的查找结果。
+ */
+static void
+buffered_bench( void )
+{
+	struct timespec t0;
+	struct timespec t1;
+	double sec = 0;
+	int *keys = ( int * )malloc( ( BUF_TREE + BUF_WRITES ) * sizeof(int) );
+	int *writes = NULL;
+	prbt proot = NULL;
+	rbt_buffered t;
+	long diff = 0;
+	int cap = 0;
+	int i = 0;
+
+	if ( !keys ) {
+		printf("No Memory!!\n");
+		return;
+	}
+	writes = keys + BUF_TREE;
+	for ( i = 0; i < BUF_TREE; i++ )
+		keys[i] = rand();
+	for ( i = 0; i < BUF_WRITES; i++ )
+		writes[i] = ( i % 4 == 3 ) ? keys[rand() % BUF_TREE] : rand();
+	rbt_bulk_build( &proot, keys, BUF_TREE, 1 );
+	clock_gettime( CLOCK_MONOTONIC, &t0 );
+	for ( i = 0; i < BUF_WRITES; i++ ) {
+		if ( i % 4 == 3 )
+			rbt_delete( &proot, writes[i] );
+		else
+			rbt_insert( &proot, writes[i] );
+	}
+	clock_gettime( CLOCK_MONOTONIC, &t1 );
+	sec = ( t1.tv_sec - t0.tv_sec ) + ( t1.tv_nsec - t0.tv_nsec ) / 1e9;
+	printf("%d writes into %d keys, unbuffered:     %.1f ms.\n", BUF_WRITES, BUF_TREE, sec * 1e3);
+
+	for ( cap = 64; cap <= 4096; cap *= 4 ) {
+		rbt_buffered_init( &t, cap );
+		t.size = rbt_bulk_build( &t.root, keys, BUF_TREE, 1 );
+		clock_gettime( CLOCK_MONOTONIC, &t0 );
+		for ( i = 0; i < BUF_WRITES; i++ ) {
+			if ( i % 4 == 3 )
+				rbt_buffered_delete( &t, writes[i] );
+			else
+				rbt_buffered_insert( &t, writes[i] );
+		}
+		rbt_buffered_flush( &t );
+		clock_gettime( CLOCK_MONOTONIC, &t1 );
+		sec = ( t1.tv_sec - t0.tv_sec ) + ( t1.tv_nsec - t0.tv_nsec ) / 1e9;
+		for ( i = 0, diff = 0; i < BUF_WRITES; i++ )
+			diff += ( rbt_search1( proot, writes[i] ) != NULL ) != rbt_buffered_search( &t, writes[i] );
+		printf("%d writes into %d keys, buffer %5d: %.1f ms, %ld nodes, %ld mismatches.\n",
+			BUF_WRITES, BUF_TREE, cap, sec * 1e3, t.size, diff);
+		rbt_buffered_destroy( &t );
+	}
+	rbt_destroy( &proot );
+	free( keys );
+}
+
+#define BENCH_KEYS	( 1 << 16 )
+#define BENCH_READS	( 1 << 20 )
+#define BENCH_THREADS	8
+
+typedef struct _bench_arg {
+	prbt_shared t;
+	unsigned int seed;
+	long misses;
+}bench_arg;
+
+static int bench_stop = 0;
+
+/**
+ * @brief bench_reader - search keys which are never deleted, count misses.
+ */
+static void *
+bench_reader( void *arg )
+{
+	bench_arg *pa = ( bench_arg * )arg;
+	epoch_record rec;
+	unsigned int x = pa->seed;
+	int i = 0;
+
+	if ( !rbt_shared_thread_init( pa->t, &rec ) )
+		return NULL;
+	for ( i = 0; i < BENCH_READS; i++ ) {
+		x = x * 1103515245 + 12345;
+		if ( !rbt_shared_search( pa->t, &rec, ( ( x >> 8 ) % BENCH_KEYS ) * 4 ) )
+			pa->misses++;
+	}
+	rbt_shared_thread_exit( &rec );
+
+	return NULL;
+}
+
+/**
+ * @brief bench_writer - insert and delete keys not multiple of 4 until readers finish.
+ */
+static void *
+bench_writer( void *arg )
+{
+	bench_arg *pa = ( bench_arg * )arg;
+	epoch_record rec;
+	unsigned int x = pa->seed;
+	int key = 0;
+
+	if ( !rbt_shared_thread_init( pa->t, &rec ) )
+		return NULL;
+	for ( ; !__atomic_load_n( &bench_stop, __ATOMIC_ACQUIRE ); pa->misses++ ) {
+		x = x * 1103515245 + 12345;
+		key = ( ( x >> 8 ) % BENCH_KEYS ) * 4 + 1 + ( x >> 4 ) % 3;
+		if ( ( x >> 2 ) & 1 )
+			rbt_shared_insert( pa->t, key );
+		else
+			rbt_shared_delete( pa->t, &rec, key );
+	}
+	rbt_shared_thread_exit( &rec );
+
+	return NULL;
+}
+
+/**
+ * @brief bench_run - run n readers with one writer and show throughput.
+ */
+static void
+bench_run( prbt_shared t, int n )
+{
+	pthread_t tid[BENCH_THREADS + 1];
+	bench_arg args[BENCH_THREADS + 1];
+	struct timespec t0;
+	struct timespec t1;
+	double sec = 0;
+	long misses = 0;
+	int i = 0;
+
+	bench_stop = 0;
+	clock_gettime( CLOCK_MONOTONIC, &t0 );
+	for ( i = 0; i <= n; i++ ) {
+		args[i].t = t;
+		args[i].seed = i * 7919 + 1;
+		args[i].misses = 0;
+		pthread_create( &tid[i], NULL, i ? bench_reader : bench_writer, &args[i] );
+	}
+	for ( i = 1; i <= n; i++ ) {
+		pthread_join( tid[i], NULL );
+		misses += args[i].misses;
+	}
+	clock_gettime( CLOCK_MONOTONIC, &t1 );
+	__atomic_store_n( &bench_stop, 1, __ATOMIC_RELEASE );
+	pthread_join( tid[0], NULL );
+	sec = ( t1.tv_sec - t0.tv_sec ) + ( t1.tv_nsec - t0.tv_nsec ) / 1e9;
+	printf("readers:%d  reads %.2f Mops/s, writes %.2f Mops/s, misses %ld\n",
+	       n, n * (double)BENCH_READS / sec / 1e6, args[0].misses / sec / 1e6, misses);
+}
+
+#define WAL_PATH	"/tmp/rbt_durable"
+#define WAL_OPS		4096
+
+typedef struct _wal_arg {
+	prbt_durable d;
+	int base;
+}wal_arg;
+
+/**
+ * @brief wal_worker - insert WAL_OPS keys durably.
+ */
+static void *
+wal_worker( void *arg )
+{
+	wal_arg *pa = ( wal_arg * )arg;
+	int i = 0;
+
+	for ( i = 0; i < WAL_OPS; i++ )
+		rbt_durable_insert( pa->d, pa->base + i );
+
+	return NULL;
+}
+
+/**
+ * @brief wal_run - run n writers on a fresh durable tree and show throughput.
+ */
+static void
+wal_run( int n, int batch )
+{
+	pthread_t tid[BENCH_THREADS];
+	wal_arg args[BENCH_THREADS];
+	rbt_durable d;
+	struct timespec t0;
+	struct timespec t1;
+	double sec = 0;
+	int i = 0;
+
+	unlink( WAL_PATH ".log" );
+	unlink( WAL_PATH ".ckpt" );
+	if ( !rbt_durable_open( &d, WAL_PATH, batch, 0 ) )
+		return;
+	clock_gettime( CLOCK_MONOTONIC, &t0 );
+	for ( i = 0; i < n; i++ ) {
+		args[i].d = &d;
+		args[i].base = i * WAL_OPS;
+		pthread_create( &tid[i], NULL, wal_worker, &args[i] );
+	}
+	for ( i = 0; i < n; i++ )
+		pthread_join( tid[i], NULL );
+	rbt_durable_sync( &d );
+	clock_gettime( CLOCK_MONOTONIC, &t1 );
+	sec = ( t1.tv_sec - t0.tv_sec ) + ( t1.tv_nsec - t0.tv_nsec ) / 1e9;
+	printf("writers:%d batch:%-3d  %.0f durable ops/s\n", n, batch, n * WAL_OPS / sec);
+	rbt_durable_close( &d );
+}
+
+int
+main()
+{
+	int array[INIT_SIZE];
+	//int array1[INIT_SIZE] = {4,17,54,61,11,0,51,75,43,88};
+	int array1[INIT_SIZE] = {87,10,68,69,6,27,24,28,70,62};
+	int i = 0;
+	prbt proot = NULL; /* 此处一定要显式置NULL，否则调用会出错，因为是根 */
+	prbt proot1 = NULL; /* 此处一定要显式置NULL，否则调用会出错，因为是根 */
+	prbt pfind = NULL;
+	rbt_kv_tree kv;
+	rbt_value value = 0;
+	rbt_shared shared;
+	rbt_durable durable;
+	int nearest[5];
+	int n = 0;
+	rbt_hashed hashed;
+	rbt_buffered buffered;
+
+	srand( (unsigned int)time(NULL) );
+	rbt_trace = 1;	/* 只在基本演示中输出修复过程 */
+	for ( i = 0; i < INIT_SIZE; i++ ) {
+		array[i] = rand() % 100;
+		printf("%-4d", array[i]);
+	}
+	printf("\n");
+	/* 创建红黑树 */
+	for ( i = 0; i < INIT_SIZE; i++ ) {
+		rbt_insert( &proot, array[i] );
+//		if ( proot ) {
+//			rbt_show( proot );
+//			printf("\n");
+//		}
+	}
+	rbt_show( proot );
+	printf("\n");
+	for ( i = 0; i < INIT_SIZE; i++ ) {
+		printf("%d -- \n", array[i]);
+		rbt_delete( &proot, array[i]);
+		rbt_show( proot );
+		printf("\n");
+	}
+	
+	printf("======================分割线======================\n");
+	for ( i = 0; i < INIT_SIZE; i++ ) {
+		printf("%d -- \n", array1[i]);
+		rbt_insert( &proot1, array1[i] );
+		rbt_show( proot1 );
+		printf("\n");
+	}
+	printf("======================分割线1--insert finish======================\n");
+	rbt_show( proot1 );
+	printf("\n");
+	for ( i = 0; i < INIT_SIZE; i++ ) {
 		printf("%d -- \n", array1[i]);
 		rbt_delete( &proot1, array1[i]);
 		rbt_show( proot1 );
 		printf("\n");
 	}
 
+	printf("======================分割线2--key/value======================\n");
+	rbt_trace = 0;
+	rbt_kv_init( &kv );
+	for ( i = 0; i < INIT_SIZE; i++ ) {
+		rbt_kv_insert( &kv, (rbt_key)array1[i] << 32, array1[i] * 10 );
+	}
+	if ( rbt_kv_get( &kv, (rbt_key)array1[5] << 32, &value ) )
+		printf("Key found. value is %lld.\n", (long long)value);
+	rbt_kv_delete( &kv, (rbt_key)array1[5] << 32 );
+	if ( !rbt_kv_get( &kv, (rbt_key)array1[5] << 32, &value ) )
+		printf("Key not exists.\n");
+	rbt_kv_destroy( &kv );
+
+	printf("======================分割线3--single writer, multi reader======================\n");
+	rbt_shared_init( &shared );
+	for ( i = 0; i < BENCH_KEYS; i++ )
+		rbt_shared_insert( &shared, i * 4 );
+	for ( i = 1; i <= BENCH_THREADS; i *= 2 )
+		bench_run( &shared, i );
+	rbt_shared_destroy( &shared );
+
+	printf("======================分割线4--write-ahead log======================\n");
+	unlink( WAL_PATH ".log" );
+	unlink( WAL_PATH ".ckpt" );
+	rbt_durable_open( &durable, WAL_PATH, 1, 0 );
+	for ( i = 0; i < INIT_SIZE; i++ )
+		rbt_durable_insert( &durable, array1[i] );
+	rbt_durable_checkpoint( &durable );
+	rbt_durable_delete( &durable, array1[0] );
+	rbt_durable_insert( &durable, 101 );
+	rbt_durable_close( &durable );
+	/* 从检查点和日志恢复 */
+	rbt_durable_open( &durable, WAL_PATH, 1, 0 );
+	printf("recovered %ld keys, %d %s, 101 %s.\n", durable.size, array1[0],
+	       rbt_durable_search( &durable, array1[0] ) ? "found" : "not exists",
+	       rbt_durable_search( &durable, 101 ) ? "found" : "not exists");
+	rbt_durable_close( &durable );
+	for ( i = 1; i <= BENCH_THREADS; i *= 2 )
+		wal_run( i, 1 );
+	wal_run( 1, 64 );
+
+	printf("======================分割线5--neighbour queries======================\n");
+	for ( i = 0; i < INIT_SIZE; i++ )
+		rbt_insert( &proot1, array1[i] );
+	pfind = rbt_floor( proot1, 40 );
+	if ( pfind )
+		printf("floor(40) = %d.\n", pfind->data);
+	pfind = rbt_ceil( proot1, 40 );
+	if ( pfind )
+		printf("ceil(40) = %d.\n", pfind->data);
+	n = rbt_nearest( proot1, 40, 5, nearest );
+	printf("5 keys nearest to 40:");
+	for ( i = 0; i < n; i++ )
+		printf(" %d", nearest[i]);
+	printf("\n");
+	rbt_destroy( &proot1 );
+
+	printf("======================分割线6--hash index======================\n");
+	rbt_hashed_init( &hashed, 0 );
+	for ( i = 0; i < INIT_SIZE; i++ )
+		rbt_hashed_insert( &hashed, array1[i] );
+	rbt_hashed_delete( &hashed, array1[0] );
+	pfind = rbt_hashed_search( &hashed, array1[1] );
+	if ( pfind )
+		printf("Node found. it's %d, %ld nodes.\n", pfind->data, hashed.size);
+	rbt_hashed_destroy( &hashed );
+	hash_bench();
+
+	printf("======================分割线7--huge pages and NUMA======================\n");
+	arena_bench();
+
+	printf("======================分割线8--bulk build======================\n");
+	n = (int)rbt_bulk_build( &proot1, array1, INIT_SIZE, 2 );
+	rbt_show( proot1 );
+	printf("%d nodes built.\n", n);
+	rbt_destroy( &proot1 );
+	bulk_bench();
+
+	printf("======================分割线9--write buffer======================\n");
+	rbt_buffered_init( &buffered, INIT_SIZE / 2 );
+	for ( i = 0; i < INIT_SIZE; i++ )
+		rbt_buffered_insert( &buffered, array1[i] );
+	rbt_buffered_delete( &buffered, array1[0] );
+	printf("%d %s, %d %s, %d buffered.\n",
+	       array1[0], rbt_buffered_search( &buffered, array1[0] ) ? "found" : "not exists",
+	       array1[1], rbt_buffered_search( &buffered, array1[1] ) ? "found" : "not exists",
+	       buffered.len);
+	rbt_buffered_flush( &buffered );
+	rbt_show( buffered.root );
+	printf("%ld nodes.\n", buffered.size);
+	rbt_buffered_destroy( &buffered );
+	buffered_bench();
+
 	return 0;
 }
 
-
+#endif
@@ -7,6 +7,10 @@
 #include <stdio.h>
 #include <stdlib.h>
 
+#include "treedump.h"
+#include "treealloc.h"
+#include "epoch.h"
+
 /**
  * @brief define the red black tree node and it's basic oprations
  *
@@ -35,6 +39,244 @@ prbt rbt_search1( prbt proot, int key );
 int rbt_search2( prbt proot, int key, prbt *p );
 int rbt_insert( prbt *proot, int e );
 int rbt_delete( prbt *proot, int key );
+prbt rbt_floor( prbt proot, int key );
+prbt rbt_ceil( prbt proot, int key );
+prbt rbt_predecessor( prbt proot, int key );
+prbt rbt_successor( prbt proot, int key );
+int rbt_nearest( prbt proot, int key, int k, int *keys );
+int rbt_delete_node( prbt *proot, prbt pn );
+int rbt_unlink_node( prbt *proot, prbt pn );
 int rbt_destroy( prbt *proot );
 void rbt_show( prbt proot );
+int rbt_dump( prbt proot, ptree_dump d );
+
+/* 不为NULL时节点从该内存池分配（见treealloc.h），一棵树的节点全部释放
+ * 之前不能更换，不能与rbt_shared同时使用（节点由读者线程回收） */
+extern ptree_arena rbt_arena;
+
+extern int rbt_trace;	/* 为1时输出插入、删除修复的跟踪信息，默认为0，只供演示使用 */
+
+/**
+ * @brief define the key/value red black tree node.
+ *
+ * 带有64位关键字和值域的红黑树节点。rbt_node作为第一个成员，旋转、
+ * 插入修复及删除修复直接复用，孩子、双亲指针仍为prbt类型，通过RBT_KV
+ * 宏取得所在的键值节点。
+ * 键值树的树根包装为rbt_kv_tree，与整数关键字的prbt类型不同，两种树
+ * 混用（节点大小不同）时编译器报错。
+ * node.data在键值节点中不使用，这是复用修复代码的代价；它与rb共占
+ * 指针之前的8字节，去掉后也只是对齐填充，rbt_kv_node仍为48字节。
+ * 值域类型默认为 long long，可以在包含本头文件之前定义 RBT_VALUE_TYPE
+ * 为任意定长类型（包括结构体）。
+ */
+#ifndef RBT_VALUE_TYPE
+#define RBT_VALUE_TYPE long long
+#endif
+
+typedef long long rbt_key;
+typedef RBT_VALUE_TYPE rbt_value;
+
+typedef struct _red_black_tree_kv {
+	rbt_node node;	/* must be the first member */
+	rbt_key key;
+	rbt_value value;
+}rbt_kv_node, *prbt_kv;
+
+#define RBT_KV(p) ((prbt_kv)(p))
+
+typedef struct _red_black_tree_kv_tree {
+	prbt root;	/* 所有节点都是rbt_kv_node */
+}rbt_kv_tree, *prbt_kv_tree;
+
+int rbt_kv_init( prbt_kv_tree t );
+prbt_kv rbt_kv_search1( prbt_kv_tree t, rbt_key key );
+int rbt_kv_get( prbt_kv_tree t, rbt_key key, rbt_value *value );
+int rbt_kv_insert( prbt_kv_tree t, rbt_key key, rbt_value value );
+int rbt_kv_delete( prbt_kv_tree t, rbt_key key );
+int rbt_kv_destroy( prbt_kv_tree t );
+
+/**
+ * @brief define the single-writer, multi-reader red black tree.
+ *
+ * 一个写者、多个读者并发访问的红黑树：
+ *	写者仍使用rbt_insert、rbt_unlink_node修改树，旋转和摘除时孩子指针以
+ *	release语义写入，新节点初始化完成后才被链接；被删节点不立即释放，
+ *	由epoch.h的纪元回收机制在所有读者离开后释放。
+ *	读者进入纪元后不加锁地从根向下查找。旋转过程中读者可能暂时错过某个
+ *	关键字，因此写者在每次修改前后递增seq（修改期间为奇数），读者未找到
+ *	时检查seq，若有修改发生则重新查找；找到时直接返回，不受写者影响。
+ *
+ * 读者和写者都需要先调用rbt_shared_thread_init获得自己的纪元记录，
+ * 写者只能有一个。编译时需要 -pthread。
+ */
+#define RBT_MAX_DEPTH	128
+
+typedef struct _red_black_tree_shared {
+	prbt root;
+	unsigned long seq;	/* 写者修改期间为奇数 */
+	epoch_domain ed;
+}rbt_shared, *prbt_shared;
+
+int rbt_shared_init( prbt_shared t );
+int rbt_shared_thread_init( prbt_shared t, pepoch_record r );
+void rbt_shared_thread_exit( pepoch_record r );
+int rbt_shared_search( prbt_shared t, pepoch_record r, int key );
+int rbt_shared_insert( prbt_shared t, int e );
+int rbt_shared_delete( prbt_shared t, pepoch_record r, int key );
+int rbt_shared_destroy( prbt_shared t );
+
+/**
+ * @brief define the durable red black tree with write-ahead log and checkpoint.
+ *
+ * 可持久化到磁盘的红黑树：
+ *	每次插入、删除先在树中查找，确定操作会生效后把它追加到日志缓冲区
+ *	（预写日志），再修改内存中的树，树中的内容不会超前于日志。
+ *	组提交：多个线程的日志记录在缓冲区中合并，由其中一个线程（领导者）
+ *	一次write、一次fdatasync写入磁盘，其余线程等待，写盘期间新的记录写入
+ *	另一个缓冲区，供下一次组提交使用。
+ *	batch为1时每个操作返回时已经落盘；batch为n时累积n个未落盘的操作才
+ *	提交一次，崩溃时最多丢失n-1个操作。
+ *	每ckpt_every个操作做一次检查点：把有序的关键字集合及其校验和写入
+ *	临时文件，fsync后重命名为检查点文件，然后清空日志。
+ * 恢复时先从检查点批量构造红黑树（校验和不符或关键字不严格递增时
+ * 拒绝打开），再重放日志尾部，遇到不完整或校验和错误的记录即截断。检查点与日志中的操作都是集合的插入、删除，
+ * 重复重放结果不变，因此检查点完成后清空日志前崩溃也不影响正确性。
+ *
+ * 插入、删除返回1表示成功，0表示关键字已存在或不存在，RBT_EIO表示
+ * 内存不足或写日志失败；写日志失败后树不再接受修改，没有落盘的操作
+ * 可能丢失，重新打开即恢复到最后落盘的状态。
+ *
+ * 日志文件为path.log，检查点文件为path.ckpt。编译时需要 -pthread。
+ */
+#include <pthread.h>
+
+#define RBT_LOG_INSERT	1
+#define RBT_LOG_DELETE	2
+#define RBT_EIO		-1	/* 内存不足或写日志失败 */
+
+typedef struct _rbt_log_rec {
+	int key;
+	unsigned char op;
+	unsigned char pad;
+	unsigned short sum;	/* 校验和，用于识别写了一半的尾部记录 */
+}rbt_log_rec;
+
+typedef struct _red_black_tree_durable {
+	prbt root;
+	long size;
+	char *log_path;
+	char *ckpt_path;
+	int log_fd;
+	int batch;		/* 累积多少个操作提交一次 */
+	long ckpt_every;	/* 多少个操作做一次检查点，0表示不自动做 */
+	long since_ckpt;
+	rbt_log_rec *buf;	/* 正在积累的日志记录 */
+	rbt_log_rec *spare;	/* 领导者正在写盘的缓冲区 */
+	long buf_len;
+	long buf_cap;
+	long spare_cap;
+	unsigned long long lsn;		/* 最后一条记录的序号 */
+	unsigned long long synced;	/* 已经落盘的最大序号 */
+	int flushing;
+	int error;
+	pthread_mutex_t lock;
+	pthread_cond_t cond;
+}rbt_durable, *prbt_durable;
+
+int rbt_durable_open( prbt_durable d, const char *path, int batch, long ckpt_every );
+int rbt_durable_insert( prbt_durable d, int e );
+int rbt_durable_delete( prbt_durable d, int key );
+int rbt_durable_search( prbt_durable d, int key );
+int rbt_durable_sync( prbt_durable d );
+int rbt_durable_checkpoint( prbt_durable d );
+int rbt_durable_close( prbt_durable d );
+
+/**
+ * @brief define the red black tree with hash index.
+ *
+ * 带散列索引的红黑树：
+ *	另外维护一个开放定址（线性探测）的散列表，从关键字映射到树节点。
+ *	点查询只查散列表，平均O(1)；树仍然是权威的数据结构，有序查询
+ *	（rbt_floor、rbt_nearest等）直接作用于root。
+ *	插入、删除同时修改树和散列表。删除节点时红黑树摘除的是该节点本身，
+ *	其余节点的地址不变，因此散列表中的指针始终有效。
+ *
+ * 树中的节点必须只通过rbt_hashed_*修改。
+ */
+#define RBT_HASH_MIN	16
+
+typedef struct _rbt_hash_entry {
+	int key;
+	prbt node;	/* NULL表示空槽 */
+}rbt_hash_entry;
+
+typedef struct _red_black_tree_hashed {
+	prbt root;
+	long size;
+	rbt_hash_entry *slot;
+	unsigned long mask;	/* 槽数减1，槽数为2的幂 */
+	int shift;		/* 64减去槽数的对数 */
+}rbt_hashed, *prbt_hashed;
+
+int rbt_hashed_init( prbt_hashed t, long hint );
+prbt rbt_hashed_search( prbt_hashed t, int key );
+int rbt_hashed_insert( prbt_hashed t, int e );
+int rbt_hashed_delete( prbt_hashed t, int key );
+int rbt_hashed_destroy( prbt_hashed t );
+
+/**
+ * @brief build red black tree from unsorted keys with several threads.
+ *
+ * 从无序的关键字批量构造红黑树，代替逐个rbt_insert：
+ *	1.抽样选出threads-1个分隔值，各线程统计自己那一段关键字落在每个桶中
+ *	  的个数，再并行地把关键字分散到各桶，桶之间已经有序。
+ *	2.每个线程对一个桶做基数排序并去重，相同的关键字一定在同一个桶中。
+ *	3.树的上面几层（不少于threads棵子树）由调用线程构造，其下互不相交的
+ *	  子树由各线程并行构造，节点颜色和双亲指针与rbt_build_sorted相同，
+ *	  直接得到合法的红黑树，不需要旋转和修复。
+ * rbt_arena不为NULL时先从内存池切出一段连续的节点，按子树分给各线程；
+ * 否则各线程用malloc分配（glibc为每个线程使用独立的分配区）。
+ * 编译时需要 -pthread。
+ */
+#define RBT_BULK_THREADS	64	/* 最多使用的线程数 */
+
+long rbt_bulk_build( prbt *proot, const int *keys, long n, int threads );
+
+/**
+ * @brief define the red black tree with write buffer.
+ *
+ * 带写缓冲的红黑树（类似LSM树的前端）：
+ *	插入、删除先记入一个按关键字有序的小缓冲区，二分查找定位，memmove
+ *	腾出位置，不访问树，不分配节点；同一关键字的后一次操作覆盖前一次。
+ *	查找先查缓冲区，缓冲区中有该关键字时以缓冲区为准，否则查树。
+ *	缓冲区满时按关键字升序合并到树中：每RBT_BUF_LANES个关键字先同时
+ *	从根下降一遍并预取路径上的节点，使各自的缓存缺失重叠；然后逐个
+ *	从上一个插入的节点（或被删节点的前驱）出发，沿双亲指针上升到子树
+ *	范围包含该关键字为止，再向下查找并插入或删除，相邻关键字共享的
+ *	上层路径不再从根下降。
+ * 插入、删除只记录操作，不检查关键字是否已在树中，返回1表示已接受，
+ * 树的节点数在合并后才确定。树只能通过rbt_buffered_*修改，直接读取
+ * root之前先调用rbt_buffered_flush。
+ */
+#define RBT_BUF_CAP	256	/* 缓冲区默认容量 */
+#define RBT_BUF_LANES	16	/* 合并时同时预取路径的关键字个数 */
+
+typedef struct _rbt_buf_entry {
+	int key;
+	int op;		/* RBT_LOG_INSERT 或 RBT_LOG_DELETE */
+}rbt_buf_entry;
+
+typedef struct _red_black_tree_buffered {
+	prbt root;
+	long size;		/* 树中节点个数，不含缓冲区 */
+	rbt_buf_entry *buf;	/* 按关键字升序 */
+	int len;
+	int cap;
+}rbt_buffered, *prbt_buffered;
 
+int rbt_buffered_init( prbt_buffered t, int cap );
+int rbt_buffered_search( prbt_buffered t, int key );
+int rbt_buffered_insert( prbt_buffered t, int e );
+int rbt_buffered_delete( prbt_buffered t, int key );
+long rbt_buffered_flush( prbt_buffered t );
+int rbt_buffered_destroy( prbt_buffered t );
@@ -0,0 +1,573 @@
+/**
+ * @file splaytree.c
+ * @brief realize splay tree's basic oprations.
+ * @author watertiger <darkwkt@gmail.com>
+ * @date 2026-10-19
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "splaytree.h"
+#ifdef SPLAY_BENCH_ENGINES
+#include "balancebstree.h"
+#include "redblacktree.h"
+#endif
+
+#define INIT_SIZE 10
+
+/**
+ * @brief r_rotate - rotate the splay tree to the right.
+ * @param p pointer to the pointer to the root of splay subtree.
+ * @return none.
+ *
+ */
+static void
+r_rotate( psplay *p )
+{
+	psplay plc = NULL;
+
+	plc = (*p)->lc;
+	(*p)->lc = plc->rc;
+	plc->rc = (*p);
+	(*p) = plc;
+
+	return;
+}
+
+/**
+ * @brief l_rotate - rotate the splay tree to the left.
+ * @param p pointer to the pointer to the root of splay subtree.
+ * @return none.
+ *
+ */
+static void
+l_rotate( psplay *p )
+{
+	psplay prc = NULL;
+
+	prc = (*p)->rc;
+	(*p)->rc = prc->lc;
+	prc->lc = (*p);
+	(*p) = prc;
+
+	return;
+}
+
+/**
+ * @brief splay - top-down splay the node nearest to key to the root.
+ * @param proot pointer to the pointer to the root of splay tree.
+ * @param key the key to splay.
+ * @return none.
+ *
+ * 自顶向下伸展（Sleator & Tarjan）：
+ *	用一个临时头节点收集两棵树：左树L中的关键字都小于key，右树R中的
+ *	都大于key。从根向下，一字形时先旋转一次再链接，之字形时直接链接。
+ *	到达key（或路径末端）后把L、R分别作为新根的左、右子树。
+ * key不存在时，最后访问的节点（key的前驱或后继）成为树根。
+ */
+static void
+splay( psplay *proot, int key )
+{
+	splay_node head;
+	psplay pl = &head;
+	psplay pr = &head;
+	psplay pt = *proot;
+
+	if ( !pt )
+		return;
+	head.lc = NULL;
+	head.rc = NULL;
+	for ( ;; ) {
+		if ( key < pt->data ) {
+			if ( !pt->lc )
+				break;
+			if ( key < pt->lc->data ) { /* 一字形 */
+				r_rotate( &pt );
+				if ( !pt->lc )
+					break;
+			}
+			pr->lc = pt;	/* 链接到右树 */
+			pr = pt;
+			pt = pt->lc;
+		} else if ( key > pt->data ) {
+			if ( !pt->rc )
+				break;
+			if ( key > pt->rc->data ) {
+				l_rotate( &pt );
+				if ( !pt->rc )
+					break;
+			}
+			pl->rc = pt;	/* 链接到左树 */
+			pl = pt;
+			pt = pt->rc;
+		} else {
+			break;
+		}
+	}
+	pl->rc = pt->lc;
+	pr->lc = pt->rc;
+	pt->lc = head.rc;
+	pt->rc = head.lc;
+	(*proot) = pt;
+}
+
+/**
+ * @brief splay_search1 - searching key and splay it to the root.
+ * @param proot pointer to the pointer to the root of splay tree.
+ * @param key the enum to search.
+ * @return psplay pointer to the node (the new root) if found,
+ *	   NULL pointer if key not found.
+ */
+psplay
+splay_search1( psplay *proot, int key )
+{
+	splay( proot, key );
+
+	return ( *proot && key == (*proot)->data ) ? *proot : NULL;
+}
+
+/**
+ * @brief splay_search_semi - searching key, splay only if it's deep.
+ * @param proot pointer to the pointer to the root of splay tree.
+ * @param key the enum to search.
+ * @return psplay pointer to the node if found,
+ *	   NULL pointer if key not found.
+ *
+ * 先像普通二叉排序树一样只读查找，记下深度，深度不超过SPLAY_SEMI_DEPTH
+ * 时不修改树；更深时再按key做一次完全伸展，路径刚访问过，都在缓存中。
+ * 热点关键字被提到上面几层后，重复访问既不旋转也不写内存，不会因为
+ * 每次命中都把根附近的节点重新排列一遍。
+ * 下降时不保存路径，也不用条件选择子指针的地址，比较结果只决定分支，
+ * 分支预测可以提前取下一层的节点。
+ */
+psplay
+splay_search_semi( psplay *proot, int key )
+{
+	psplay pn = *proot;
+	int d = 0;
+
+	for ( ; pn && key != pn->data; d++ )
+		pn = ( key < pn->data ) ? pn->lc : pn->rc;
+	if ( d > SPLAY_SEMI_DEPTH )
+		splay( proot, key );
+
+	return pn;
+}
+
+/**
+ * @brief splay_insert - insert an enum into splay tree.
+ * @param proot pointer to the pointer to the root of splay tree.
+ * @param e the enum to insert.
+ * @return 1 for succeed,
+ *	   0 for failure.
+ *
+ * 先按e伸展，树根为e的前驱或后继，新节点成为树根，原树根及其一侧
+ * 子树分别成为新节点的左右子树。
+ */
+int
+splay_insert( psplay *proot, int e )
+{
+	psplay pe = NULL;
+
+	splay( proot, e );
+	if ( *proot && e == (*proot)->data )
+		return 0;
+	pe = ( psplay )malloc( sizeof( splay_node ) );
+	if ( !pe ) {
+		printf("No Memory!!\n");
+		return 0;
+	}
+	pe->data = e;
+	if ( !(*proot) ) {
+		pe->lc = NULL;
+		pe->rc = NULL;
+	} else if ( e < (*proot)->data ) {
+		pe->lc = (*proot)->lc;
+		pe->rc = *proot;
+		(*proot)->lc = NULL;
+	} else {
+		pe->rc = (*proot)->rc;
+		pe->lc = *proot;
+		(*proot)->rc = NULL;
+	}
+	(*proot) = pe;
+
+	return 1;
+}
+
+/**
+ * @brief splay_delete - delete an enum from splay tree.
+ * @param proot pointer to the pointer to the root of splay tree.
+ * @param key the enum to delete.
+ * @return 1 for succeed,
+ *	   0 for failure.
+ *
+ * 按key伸展后key位于树根。左子树再按key伸展，其最大节点成为左子树的
+ * 根且没有右孩子，把原右子树接上即可。
+ */
+int
+splay_delete( psplay *proot, int key )
+{
+	psplay pn = NULL;
+
+	splay( proot, key );
+	if ( !(*proot) || key != (*proot)->data )
+		return 0;
+	pn = *proot;
+	if ( !pn->lc ) {
+		(*proot) = pn->rc;
+	} else {
+		(*proot) = pn->lc;
+		splay( proot, key );
+		(*proot)->rc = pn->rc;
+	}
+	free( pn );
+
+	return 1;
+}
+
+/**
+ * @brief splay_destroy - destroy splay tree, free it's space.
+ * @param proot pointer to the pointer to the root of splay tree.
+ * @return 0 for success.
+ *
+ * 伸展树可能很深，与bst_destroy相同，用右旋代替递归。
+ */
+int
+splay_destroy( psplay *proot )
+{
+	psplay pn = *proot;
+	psplay ptmp = NULL;
+
+	for ( ; pn; ) {
+		if ( pn->lc ) {
+			ptmp = pn->lc;
+			pn->lc = ptmp->rc;
+			ptmp->rc = pn;
+			pn = ptmp;
+		} else {
+			ptmp = pn->rc;
+			free( pn );
+			pn = ptmp;
+		}
+	}
+	(*proot) = NULL;
+
+	return 0;
+}
+
+/**
+ * @brief splay_compress - rotate left every other node of the vine.
+ * @param head the pseudo root whose rc is the vine.
+ * @param count count of rotations.
+ */
+static void
+splay_compress( psplay head, long count )
+{
+	psplay pn = head;
+	psplay pc = NULL;
+	long i = 0;
+
+	for ( i = 0; i < count; i++ ) {
+		pc = pn->rc;
+		pn->rc = pc->rc;
+		pn = pn->rc;
+		pc->rc = pn->lc;
+		pn->lc = pc;
+	}
+}
+
+/**
+ * @brief splay_rebalance - rebuild splay tree into a perfectly balanced one.
+ * @param proot pointer to the pointer to the root of splay tree.
+ * @return the count of nodes.
+ *
+ * 与bst_rebalance相同，Day-Stout-Warren算法，O(n)时间，O(1)额外空间。
+ * 随机关键字逐个splay_insert得到的树，100万个节点时平均深度约35，
+ * AVL树约19；批量插入完成后调用一次，冷数据的查找少走一半的路径。
+ * 之后的伸展会逐渐改变树的形状，实测平均深度稳定在25左右。
+ */
+long
+splay_rebalance( psplay *proot )
+{
+	splay_node head;
+	psplay tail = &head;
+	psplay rest = *proot;
+	psplay ptmp = NULL;
+	long n = 0;
+	long m = 0;
+
+	head.rc = rest;
+	for ( ; rest; ) {
+		if ( rest->lc ) {
+			ptmp = rest->lc;
+			rest->lc = ptmp->rc;
+			ptmp->rc = rest;
+			rest = ptmp;
+			tail->rc = ptmp;
+		} else {
+			tail = rest;
+			rest = rest->rc;
+			n++;
+		}
+	}
+	for ( m = 1; m <= n; m = 2 * m + 1 )
+		;
+	m /= 2;
+	splay_compress( &head, n - m );
+	for ( ; m > 1; ) {
+		m /= 2;
+		splay_compress( &head, m );
+	}
+	(*proot) = head.rc;
+
+	return n;
+}
+
+/**
+ * @brief splay_dump_lc - access functions used by treedump.h.
+ */
+static void *
+splay_dump_lc( void *n )
+{
+	return ( ( psplay )n )->lc;
+}
+
+static void *
+splay_dump_rc( void *n )
+{
+	return ( ( psplay )n )->rc;
+}
+
+static long long
+splay_dump_key( void *n )
+{
+	return ( ( psplay )n )->data;
+}
+
+static const tree_dump_ops splay_dump_ops = {
+	splay_dump_lc, splay_dump_rc, splay_dump_key, NULL, TDUMP_ATTR_NONE, sizeof(int)
+};
+
+/**
+ * @brief splay_dump - dump splay tree without recursion.
+ * @param proot pointer to the root of splay tree.
+ * @param d pointer to the writer initialized by tdump_init.
+ * @return 1 for succeed,
+ *	   0 for failure.
+ */
+int
+splay_dump( psplay proot, ptree_dump d )
+{
+	return tdump_tree( d, proot, NULL, &splay_dump_ops );
+}
+
+/**
+ * @brief splay_show - show all node's information of splay tree.
+ * @param proot pointer to the node of splay tree.
+ * @param parent pointer to the parent node of node which pointer proot point to
+ * @return none.
+ */
+void
+splay_show( psplay proot, psplay parent )
+{
+	char buf[8192];
+	tree_dump d;
+
+	fflush( stdout );
+	tdump_init( &d, STDOUT_FILENO, buf, sizeof(buf), TDUMP_TEXT );
+	tdump_tree( &d, proot, parent, &splay_dump_ops );
+
+	return;
+}
+
+/*
+ * 性能测试默认只比较splay_search1和splay_search_semi，本文件单独即可编译。
+ * 定义SPLAY_BENCH_ENGINES时再与balancebstree.c、redblacktree.c中的
+ * bbst_search1、rbt_search1比较，需要一起编译，并去掉它们的演示程序：
+ *	gcc -O2 -pthread -DSPLAY_BENCH_ENGINES -DBBST_NO_MAIN -DRBT_NO_MAIN \
+ *		splaytree.c balancebstree.c redblacktree.c
+ */
+#define BENCH_KEYS	( 1 << 20 )
+#define BENCH_GETS	( 1 << 22 )
+#define BENCH_WORKSET	64	/* 每个会话访问的关键字个数 */
+
+/**
+ * @brief bench_query - generate lookups, session-local or uniform.
+ * @param keys keys in the trees.
+ * @param query array to store the lookups.
+ * @param session count of lookups in each session, 0 for uniform.
+ *
+ * 会话局部：每个会话随机选出BENCH_WORKSET个关键字，会话内的访问都落在
+ * 这些关键字上，会话之间的工作集互不相关。
+ */
+static void
+bench_query( const int *keys, int *query, int session )
+{
+	int set[BENCH_WORKSET];
+	int i = 0;
+	int j = 0;
+
+	for ( i = 0; i < BENCH_GETS; i++ ) {
+		if ( !session ) {
+			query[i] = keys[rand() % BENCH_KEYS];
+			continue;
+		}
+		if ( 0 == i % session ) {
+			for ( j = 0; j < BENCH_WORKSET; j++ )
+				set[j] = keys[rand() % BENCH_KEYS];
+		}
+		query[i] = set[rand() % BENCH_WORKSET];
+	}
+}
+
+/**
+ * @brief bench_time - time the lookups on one engine.
+ * @param e 0 for splay_search1, 1 for splay_search_semi,
+ *	  2 for bbst_search1, 3 for rbt_search1.
+ * @param t the tree, pointer to the root pointer for splay trees.
+ * @param query the lookups.
+ * @param hit count of keys found is added to it.
+ * @return nanoseconds per lookup.
+ */
+static double
+bench_time( int e, void *t, const int *query, long *hit )
+{
+	struct timespec t0;
+	struct timespec t1;
+	int i = 0;
+
+	clock_gettime( CLOCK_MONOTONIC, &t0 );
+	for ( i = 0; i < BENCH_GETS; i++ ) {
+		switch ( e ) {
+			case 0:(*hit) += ( splay_search1( ( psplay * )t, query[i] ) != NULL );break;
+			case 1:(*hit) += ( splay_search_semi( ( psplay * )t, query[i] ) != NULL );break;
+#ifdef SPLAY_BENCH_ENGINES
+			case 2:(*hit) += ( bbst_search1( ( pbbst )t, query[i] ) != NULL );break;
+			case 3:(*hit) += ( rbt_search1( ( prbt )t, query[i] ) != NULL );break;
+#endif
+		}
+	}
+	clock_gettime( CLOCK_MONOTONIC, &t1 );
+
+	return ( ( t1.tv_sec - t0.tv_sec ) * 1e9 + ( t1.tv_nsec - t0.tv_nsec ) ) / BENCH_GETS;
+}
+
+/**
+ * @brief bench - compare full splaying with splaying only deep keys.
+ *
+ * 两种读法各用一棵伸展树，都先用splay_rebalance重建，与AVL树从相同的
+ * 深度开始。依次测试每个会话1024、4096次访问（每个关键字约16、64次）
+ * 和均匀访问，树的形状在各项测试之间保留，与实际使用时一样。
+ */
+static void
+bench( void )
+{
+	static const int session[] = { 1024, 4096, 0 };
+	static const char *name[] = { "splay", "semi-splay", "avl", "rbt" };
+	int *keys = ( int * )malloc( BENCH_KEYS * sizeof(int) );
+	int *query = ( int * )malloc( BENCH_GETS * sizeof(int) );
+	void *tree[4] = { NULL, NULL, NULL, NULL };
+	psplay ps[2] = { NULL, NULL };
+	long hit = 0;
+	int engines = 2;
+	int e = 0;
+	int i = 0;
+#ifdef SPLAY_BENCH_ENGINES
+	pbbst pavl = NULL;
+	prbt prb = NULL;
+	int tf = 0;
+#endif
+
+	if ( !keys || !query ) {
+		printf("No Memory!!\n");
+		free( keys );
+		free( query );
+		return;
+	}
+	/* 分别构造，各棵树的节点在内存中不交错 */
+	for ( i = 0; i < BENCH_KEYS; i++ )
+		keys[i] = rand();
+	for ( e = 0; e < 2; e++ ) {
+		for ( i = 0; i < BENCH_KEYS; i++ )
+			splay_insert( &ps[e], keys[i] );
+		splay_rebalance( &ps[e] );
+		tree[e] = &ps[e];
+	}
+#ifdef SPLAY_BENCH_ENGINES
+	for ( i = 0; i < BENCH_KEYS; i++ )
+		bbst_insert( &pavl, keys[i], &tf );
+	for ( i = 0; i < BENCH_KEYS; i++ )
+		rbt_insert( &prb, keys[i] );
+	tree[2] = pavl;
+	tree[3] = prb;
+	engines = 4;
+#endif
+	for ( i = 0; i < 3; i++ ) {
+		bench_query( keys, query, session[i] );
+		if ( session[i] )
+			printf("session %-5d", session[i]);
+		else
+			printf("uniform      ");
+		for ( e = 0; e < engines; e++ )
+			printf("%s %s %.1f ns", e ? "," : "", name[e], bench_time( e, tree[e], query, &hit ));
+		printf(".\n");
+	}
+	if ( hit != 3L * engines * BENCH_GETS )
+		printf("Keys missing.\n");
+	splay_destroy( &ps[0] );
+	splay_destroy( &ps[1] );
+#ifdef SPLAY_BENCH_ENGINES
+	bbst_destroy( &pavl );
+	rbt_destroy( &prb );
+#endif
+	free( keys );
+	free( query );
+}
+
+int
+main()
+{
+	int array[INIT_SIZE];
+	int i = 0;
+	psplay proot = NULL; /* 此处一定要显式置NULL，否则调用会出错，因为是根 */
+	psplay pfind = NULL;
+
+	srand( (unsigned int)time(NULL) );
+	for ( i = 0; i < INIT_SIZE; i++ ) {
+		array[i] = rand() % 100;
+		printf("%-4d", array[i]);
+	}
+	printf("\n");
+	/* 创建伸展树 */
+	for ( i = 0; i < INIT_SIZE; i++ ) {
+		splay_insert( &proot, array[i] );
+	}
+	splay_show( proot, NULL );
+	printf("\n");
+	/* 查找节点，找到的节点被移到树根 */
+	pfind = splay_search1( &proot, array[5] );
+	if ( pfind )
+		printf("Node found. it's %-4d.\n", pfind->data);
+	else
+		printf("Node not exists.\n");
+	splay_show( proot, NULL );
+	printf("\n");
+	pfind = splay_search_semi( &proot, array[0] );
+	if ( pfind )
+		printf("Node found. it's %-4d.\n", pfind->data);
+	else
+		printf("Node not exists.\n");
+	splay_show( proot, NULL );
+	printf("\n");
+
+	splay_delete( &proot, array[5] );
+	splay_show( proot, NULL );
+	splay_destroy( &proot );
+
+	bench();
+
+	return 0;
+}
@@ -0,0 +1,54 @@
+/**
+ * @file splaytree.h
+ * @brief describe splay tree's defination and basic oprations.
+ * @author watertiger <darkwkt@gmail.com>
+ * @date 2026-10-19
+ */
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "treedump.h"
+
+/**
+ * @brief define the splay tree node and it's basic oprations
+ *
+ * 伸展树（Splay Tree）是一种自调整的二叉排序树，节点不保存平衡信息。
+ * 每次访问后通过一系列旋转把被访问的节点移到树根（伸展），因此
+ * 最近访问过的关键字离根很近，再次访问很快；任意m次操作的总代价为
+ * O(m log n)，单次操作最坏为O(n)。
+ *	自顶向下伸展：从根向下查找的同时把路径拆成左、右两棵树，一趟完成，
+ *	不需要双亲指针和栈。查找、插入、删除都使用这种方式。
+ *	半伸展（semi-splay）：只用于读，限制读操作的重构。先只读查找，
+ *	节点深度超过SPLAY_SEMI_DEPTH时才做一次完全伸展，否则不修改树。
+ *	splay_rebalance把树重建为完全平衡的，批量插入后调用一次。
+ *
+ * 每次命中都伸展时，热点关键字之间互相挤压，根附近的节点反复被改写，
+ * 与只读的AVL树相当甚至更慢。半伸展把热点留在上面几层后就不再改动，重复访问
+ * 只需几次比较。演示程序中100万个关键字，每个会话64个关键字：
+ *	每个会话4096次访问（每个关键字约64次）：splay_search_semi约55~70ns，
+ *	splay_search1约85~100ns，bbst_search1、rbt_search1约90~100ns；
+ *	每个会话1024次访问（约16次）：splay_search_semi约145~180ns，
+ *	反而比bbst_search1、rbt_search1的105~145ns慢，每个会话第一次访问
+ *	冷关键字的代价摊不回来；
+ *	均匀访问：伸展树约2~2.5us，AVL树和红黑树约0.4~0.6us，每次访问
+ *	都会伸展，树也被改得更深。
+ * 所以只在同一关键字短时间内重复访问几十次以上、且不需要最坏情况保证
+ * 时使用伸展树，读操作使用splay_search_semi。
+ *
+ * 读操作也会修改树，多个线程即使只读也需要互斥。
+ */
+#define SPLAY_SEMI_DEPTH	8	/* 深度0~8共511个节点，足以容纳64个关键字的工作集 */
+
+typedef struct _splay_tree {
+	int data;
+	struct _splay_tree *lc, *rc;/* left and right child pointer */
+}splay_node, *psplay;
+
+psplay splay_search1( psplay *proot, int key );
+psplay splay_search_semi( psplay *proot, int key );
+int splay_insert( psplay *proot, int e );
+int splay_delete( psplay *proot, int key );
+int splay_destroy( psplay *proot );
+long splay_rebalance( psplay *proot );
+void splay_show( psplay proot, psplay parent );
+int splay_dump( psplay proot, ptree_dump d );
@@ -0,0 +1,127 @@
+/**
+ * @file statictree.c
+ * @brief show how to generate static search trees with statictree.h.
+ * @author watertiger <darkwkt@gmail.com>
+ * @date 2026-10-19
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/* 状态码到说明的映射 */
+#define STREE_PREFIX httpcode
+#define STREE_KEY_TYPE int
+#define STREE_KEYS 200, 201, 204, 301, 302, 304, 400, 401, 403, 404, 409, 500, 502, 503
+#define STREE_VALUE_TYPE const char *
+#define STREE_VALUES "OK", "Created", "No Content", "Moved Permanently", "Found", \
+	"Not Modified", "Bad Request", "Unauthorized", "Forbidden", "Not Found", \
+	"Conflict", "Internal Server Error", "Bad Gateway", "Service Unavailable"
+#include "statictree.h"
+
+/* 关键字集合，比较函数strcmp在查找中直接展开 */
+#define STREE_PREFIX keyword
+#define STREE_KEY_TYPE const char *
+#define STREE_KEYS "break", "case", "char", "const", "continue", "default", "do", \
+	"double", "else", "enum", "extern", "float", "for", "goto", "if", "int", \
+	"long", "return", "short", "signed", "sizeof", "static", "struct", \
+	"switch", "typedef", "union", "unsigned", "void", "while"
+#define STREE_KEY_LESS(a, b) ( strcmp( (a), (b) ) < 0 )
+#include "statictree.h"
+
+/* 比较用的64个关键字，静态表与启动时构造的红黑树 */
+#define BENCH_KEY_LIST 3, 17, 29, 41, 58, 66, 79, 83, 97, 104, 118, 125, 137, 149, \
+	151, 163, 172, 188, 190, 206, 211, 227, 239, 242, 256, 263, 277, 281, 295, \
+	302, 314, 326, 331, 349, 357, 362, 378, 384, 399, 405, 413, 428, 436, 441, \
+	459, 467, 472, 486, 493, 508, 514, 529, 537, 548, 552, 566, 571, 589, 594, \
+	603, 617, 625, 638, 649
+
+#define STREE_PREFIX bench_static
+#define STREE_KEY_TYPE int
+#define STREE_KEYS BENCH_KEY_LIST
+#include "statictree.h"
+
+#define TREE_PREFIX bench_rbt
+#define TREE_KEY_TYPE int
+#define TREE_ENGINE TREE_RBT
+#include "treetmpl.h"
+
+#define INIT_SIZE 10
+#define BENCH_GETS ( 1 << 24 )
+
+/**
+ * @brief bench - compare the static tree with a red black tree built at startup.
+ */
+static void
+bench( void )
+{
+	static const int keys[] = { BENCH_KEY_LIST };
+	struct timespec t0;
+	struct timespec t1;
+	double sec = 0;
+	int *query = ( int * )malloc( BENCH_GETS * sizeof(int) );
+	pbench_rbt prbt = NULL;
+	long hit = 0;
+	int i = 0;
+
+	if ( !query ) {
+		printf("No Memory!!\n");
+		return;
+	}
+	/* 一半命中，一半落在关键字之间 */
+	for ( i = 0; i < BENCH_GETS; i++ )
+		query[i] = keys[rand() % bench_static_size] + rand() % 2;
+
+	clock_gettime( CLOCK_MONOTONIC, &t0 );
+	for ( i = 0; i < bench_static_size; i++ )
+		bench_rbt_insert( &prbt, keys[i] );
+	clock_gettime( CLOCK_MONOTONIC, &t1 );
+	sec = ( t1.tv_sec - t0.tv_sec ) + ( t1.tv_nsec - t0.tv_nsec ) / 1e9;
+	printf("%d keys: red black tree built in %.1f us, static tree needs none.\n",
+		bench_static_size, sec * 1e6);
+
+	clock_gettime( CLOCK_MONOTONIC, &t0 );
+	for ( i = 0; i < BENCH_GETS; i++ )
+		hit += ( bench_rbt_search( prbt, query[i] ) != NULL );
+	clock_gettime( CLOCK_MONOTONIC, &t1 );
+	sec = ( t1.tv_sec - t0.tv_sec ) + ( t1.tv_nsec - t0.tv_nsec ) / 1e9;
+	printf("red black tree %.2f ns/get, %ld hits.\n", sec * 1e9 / BENCH_GETS, hit);
+
+	hit = 0;
+	clock_gettime( CLOCK_MONOTONIC, &t0 );
+	for ( i = 0; i < BENCH_GETS; i++ )
+		hit += ( bench_static_search( query[i] ) >= 0 );
+	clock_gettime( CLOCK_MONOTONIC, &t1 );
+	sec = ( t1.tv_sec - t0.tv_sec ) + ( t1.tv_nsec - t0.tv_nsec ) / 1e9;
+	printf("static tree    %.2f ns/get, %ld hits.\n", sec * 1e9 / BENCH_GETS, hit);
+
+	bench_rbt_destroy( &prbt );
+	free( query );
+}
+
+int
+main()
+{
+	const char *words[] = {"static", "inline", "while", "auto", "do", "zebra"};
+	const char *msg = NULL;
+	int code = 0;
+	int i = 0;
+
+	srand( (unsigned int)time(NULL) );
+	if ( !httpcode_verify() || !keyword_verify() || !bench_static_verify() ) {
+		printf("Keys are not ascending!!\n");
+		return 1;
+	}
+	for ( i = 0; i < INIT_SIZE; i++ ) {
+		code = httpcode_keys[rand() % httpcode_size] + rand() % 2;
+		if ( httpcode_get( code, &msg ) )
+			printf("%d %s\n", code, msg);
+		else
+			printf("%d not exists, %d codes less than it.\n", code, httpcode_rank( code ));
+	}
+	for ( i = 0; i < 6; i++ )
+		printf("%-8s %s\n", words[i], keyword_search( words[i] ) >= 0 ? "keyword" : "identifier");
+	bench();
+
+	return 0;
+}
@@ -0,0 +1,162 @@
+/**
+ * @file statictree.h
+ * @brief compile-time static search tree over a fixed key set.
+ * @author watertiger <darkwkt@gmail.com>
+ * @date 2026-10-19
+ *
+ * 与treetmpl.h一样是"模板"头文件，没有包含保护，每包含一次就按照当前
+ * 定义的参数宏生成一张只读的查找表。
+ *
+ * 关键字集合在编译时给出，生成 static const 的有序数组，作为隐式的
+ * 完全平衡查找树（区间中点为根），放在只读数据段中：程序启动时不需要
+ * 逐个插入，也不分配内存。
+ * 查找为无分支的二分：每一步只用一次比较选择下一段的起点，编译为条件
+ * 传送而不是条件跳转，不会因分支预测失败而停顿；表的大小是编译时常量，
+ * 循环次数固定为ceil(log2(n))，编译器可以完全展开。
+ *
+ * 参数宏（包含后全部被#undef，可以接着生成下一张）：
+ *	STREE_PREFIX		生成的名字前缀，必须定义
+ *	STREE_KEY_TYPE		关键字类型，必须定义
+ *	STREE_KEYS		逗号分隔的关键字，必须严格升序且不为空，必须定义
+ *	STREE_VALUE_TYPE	值域类型，未定义时为集合
+ *	STREE_VALUES		与STREE_KEYS一一对应的值（定义了值域时必须定义）
+ *	STREE_KEY_LESS(a, b)	关键字比较，默认 ((a) < (b))
+ *
+ * C没有constexpr，编译时无法检查关键字是否有序，可以在调试版本中
+ * 用xx_verify检查一次。
+ *
+ * 生成的接口（以 STREE_PREFIX 为 xx 为例）：
+ *	xx_keys[], xx_values[]		关键字及值域数组
+ *	xx_size				关键字个数，编译时常量
+ *	int  xx_rank( key )		小于key的关键字个数
+ *	int  xx_search( key )		key的下标，找不到返回-1
+ *	int  xx_get( key, value * )	取值（仅有值域时）
+ *	int  xx_verify( void )		关键字严格升序返回1
+ *
+ * 例：
+ *	#define STREE_PREFIX httpcode
+ *	#define STREE_KEY_TYPE int
+ *	#define STREE_KEYS 200, 301, 404, 500
+ *	#define STREE_VALUE_TYPE const char *
+ *	#define STREE_VALUES "OK", "Moved", "Not Found", "Error"
+ *	#include "statictree.h"
+ */
+#ifndef STREE_CAT
+#define STREE_CAT_(a, b) a##_##b
+#define STREE_CAT(a, b) STREE_CAT_(a, b)
+#endif
+
+#ifndef STREE_PREFIX
+#error "STREE_PREFIX must be defined before including statictree.h"
+#endif
+#ifndef STREE_KEY_TYPE
+#error "STREE_KEY_TYPE must be defined before including statictree.h"
+#endif
+#ifndef STREE_KEYS
+#error "STREE_KEYS must be defined before including statictree.h"
+#endif
+#if defined(STREE_VALUE_TYPE) && !defined(STREE_VALUES)
+#error "STREE_VALUES must be defined with STREE_VALUE_TYPE"
+#endif
+#ifndef STREE_KEY_LESS
+#define STREE_KEY_LESS(a, b) ((a) < (b))
+#endif
+
+#define STREE_FN(name) STREE_CAT(STREE_PREFIX, name)
+
+static const STREE_KEY_TYPE STREE_FN(keys)[] = { STREE_KEYS };
+
+enum { STREE_FN(size) = sizeof(STREE_FN(keys)) / sizeof(STREE_FN(keys)[0]) };
+
+#ifdef STREE_VALUE_TYPE
+static const STREE_VALUE_TYPE STREE_FN(values)[STREE_FN(size)] = { STREE_VALUES };
+#endif
+
+/**
+ * @brief xx_rank - count keys less than key.
+ * @param key the key to search.
+ * @return count of keys less than key, also the index of the first key
+ *	   not less than key.
+ *
+ * base指向当前区间的起点，区间长度n每步减半：中点小于key时起点后移，
+ * 否则不动。n只与表的大小有关，与key无关，每次查找的步数相同。
+ * 后移量用掩码取得而不是条件表达式，编译器不会把它还原成条件跳转。
+ */
+static inline int
+STREE_FN(rank)( STREE_KEY_TYPE key )
+{
+	const STREE_KEY_TYPE *base = STREE_FN(keys);
+	int n = STREE_FN(size);
+	int half = 0;
+
+#ifdef __GNUC__
+#pragma GCC unroll 32
+#endif
+	for ( ; n > 1; n -= half ) {
+		half = n / 2;
+		base += half & -( STREE_KEY_LESS( base[half - 1], key ) != 0 );
+	}
+
+	return (int)( base - STREE_FN(keys) ) + STREE_KEY_LESS( *base, key );
+}
+
+/**
+ * @brief xx_search - searching key in the static tree.
+ * @param key the key to search.
+ * @return index of key in xx_keys if found,
+ *	   -1 if key not found.
+ */
+static inline int
+STREE_FN(search)( STREE_KEY_TYPE key )
+{
+	int i = STREE_FN(rank)( key );
+
+	return ( i < STREE_FN(size) && !STREE_KEY_LESS( key, STREE_FN(keys)[i] ) ) ? i : -1;
+}
+
+#ifdef STREE_VALUE_TYPE
+/**
+ * @brief xx_get - get the value of key.
+ * @param key the key to search.
+ * @param value pointer to store the value if found.
+ * @return 1 for succeed,
+ *	   0 for failure.
+ */
+static inline int
+STREE_FN(get)( STREE_KEY_TYPE key, STREE_VALUE_TYPE *value )
+{
+	int i = STREE_FN(search)( key );
+
+	if ( i < 0 )
+		return 0;
+	*value = STREE_FN(values)[i];
+
+	return 1;
+}
+#endif
+
+/**
+ * @brief xx_verify - check the keys are strictly ascending.
+ * @return 1 for succeed,
+ *	   0 for failure.
+ */
+static inline int
+STREE_FN(verify)( void )
+{
+	int i = 0;
+
+	for ( i = 1; i < STREE_FN(size); i++ ) {
+		if ( !STREE_KEY_LESS( STREE_FN(keys)[i - 1], STREE_FN(keys)[i] ) )
+			return 0;
+	}
+
+	return 1;
+}
+
+#undef STREE_FN
+#undef STREE_PREFIX
+#undef STREE_KEY_TYPE
+#undef STREE_KEYS
+#undef STREE_VALUE_TYPE
+#undef STREE_VALUES
+#undef STREE_KEY_LESS
@@ -0,0 +1,355 @@
+/**
+ * @file tdredblacktree.c
+ * @brief realize top-down red black tree's basic oprations.
+ * @author watertiger <darkwkt@gmail.com>
+ * @date 2026-10-19
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "tdredblacktree.h"
+
+#define INIT_SIZE 10
+
+/* dir为0时表示左孩子，为1时表示右孩子 */
+#define TDRBT_LINK(n, dir) ( *( (dir) ? &(n)->rc : &(n)->lc ) )
+#define TDRBT_IS_RED(n) ( (n) && RED == (n)->rb )
+
+/**
+ * @brief tdrbt_search1 - searching key in top-down red black tree.
+ * @param proot pointer to the root of red black tree.
+ * @param key the enum to search.
+ * @return ptdrbt pointer to the node if found,
+ *	   NULL pointer if key not found.
+ */
+ptdrbt
+tdrbt_search1( ptdrbt proot, int key )
+{
+	for ( ; proot && key != proot->data; )
+		proot = TDRBT_LINK( proot, proot->data < key );
+
+	return proot;
+}
+
+/**
+ * @brief tdrbt_single - single rotation and recolor.
+ * @param pn pointer to the root of subtree.
+ * @param dir the direction to rotate to, 1 for right rotation.
+ * @return pointer to the new root of subtree.
+ *
+ * 旋转后新的子树根为黑色，原来的根为红色。
+ */
+static ptdrbt
+tdrbt_single( ptdrbt pn, int dir )
+{
+	ptdrbt ps = TDRBT_LINK( pn, !dir );
+
+	TDRBT_LINK( pn, !dir ) = TDRBT_LINK( ps, dir );
+	TDRBT_LINK( ps, dir ) = pn;
+	pn->rb = RED;
+	ps->rb = BLACK;
+
+	return ps;
+}
+
+/**
+ * @brief tdrbt_double - double rotation and recolor.
+ * @param pn pointer to the root of subtree.
+ * @param dir the direction of the second rotation.
+ * @return pointer to the new root of subtree.
+ */
+static ptdrbt
+tdrbt_double( ptdrbt pn, int dir )
+{
+	TDRBT_LINK( pn, !dir ) = tdrbt_single( TDRBT_LINK( pn, !dir ), !dir );
+
+	return tdrbt_single( pn, dir );
+}
+
+/**
+ * @brief tdrbt_insert - insert an enum into top-down red black tree.
+ * @param proot pointer to the pointer to the root of red black tree.
+ * @param e the enum to insert.
+ * @return 1 for succeed,
+ *	   0 for failure.
+ *
+ * head为虚拟的树根，其右孩子为真正的根，使根的旋转与其他节点相同。
+ * 自顶向下查找时：
+ *	1、当前节点q的两个孩子都为红色，翻转颜色（q变红，孩子变黑）；
+ *	2、q与双亲p都为红色，以祖父g为支点单旋或双旋，g的双亲t作为链接点；
+ *	3、到达空位时挂上红色新节点，同样可能触发第2步。
+ */
+int
+tdrbt_insert( ptdrbt *proot, int e )
+{
+	tdrbt_node head;
+	ptdrbt t = &head;	/* 曾祖父节点 */
+	ptdrbt g = NULL;	/* 祖父节点 */
+	ptdrbt p = NULL;	/* 双亲节点 */
+	ptdrbt q = *proot;
+	int dir = 0;
+	int last = 0;
+	int dir2 = 0;
+	int inserted = 0;
+
+	memset( &head, 0, sizeof(head) );
+	head.rc = *proot;
+	if ( !q ) {
+		q = ( ptdrbt )malloc( sizeof( tdrbt_node ) );
+		if ( !q ) {
+			printf("No Memory!!\n");
+			return 0;
+		}
+		q->data = e;
+		q->rb = BLACK;
+		q->lc = NULL;
+		q->rc = NULL;
+		(*proot) = q;
+		return 1;
+	}
+	for ( ; ; ) {
+		if ( !q ) {
+			q = ( ptdrbt )malloc( sizeof( tdrbt_node ) );
+			if ( !q ) {
+				printf("No Memory!!\n");
+				break;
+			}
+			q->data = e;
+			q->rb = RED;
+			q->lc = NULL;
+			q->rc = NULL;
+			TDRBT_LINK( p, dir ) = q;
+			inserted = 1;
+		} else if ( TDRBT_IS_RED( q->lc ) && TDRBT_IS_RED( q->rc ) ) {
+			q->rb = RED;
+			q->lc->rb = BLACK;
+			q->rc->rb = BLACK;
+		}
+		if ( TDRBT_IS_RED( q ) && TDRBT_IS_RED( p ) ) {
+			dir2 = ( t->rc == g );
+			if ( q == TDRBT_LINK( p, last ) )
+				TDRBT_LINK( t, dir2 ) = tdrbt_single( g, !last );
+			else
+				TDRBT_LINK( t, dir2 ) = tdrbt_double( g, !last );
+		}
+		if ( q->data == e )
+			break;
+		last = dir;
+		dir = ( q->data < e );
+		if ( g )
+			t = g;
+		g = p;
+		p = q;
+		q = TDRBT_LINK( q, dir );
+	}
+	(*proot) = head.rc;
+	(*proot)->rb = BLACK;
+
+	return inserted;
+}
+
+/**
+ * @brief tdrbt_delete - delete an enum from top-down red black tree.
+ * @param proot pointer to the pointer to the root of red black tree.
+ * @param key the enum to delete.
+ * @return 1 for succeed,
+ *	   0 for failure.
+ *
+ * 一直查找到叶子（被删节点存在两个孩子时继续找其前驱），途中保证当前节点q
+ * 或其下一步要去的孩子为红色：
+ *	1、q的另一个孩子为红色，以q旋转，使q变红；
+ *	2、q的兄弟s的两个孩子都为黑色，翻转颜色（p变黑，q和s变红）；
+ *	3、s存在红色孩子，以p为支点单旋或双旋后重新着色。
+ * 最后把前驱q的数据复制到被删节点f中，释放q，此时q必为红色或根。
+ */
+int
+tdrbt_delete( ptdrbt *proot, int key )
+{
+	tdrbt_node head;
+	ptdrbt q = &head;
+	ptdrbt p = NULL;
+	ptdrbt g = NULL;
+	ptdrbt f = NULL;	/* 被删节点 */
+	ptdrbt s = NULL;	/* 兄弟节点 */
+	int dir = 1;
+	int last = 0;
+	int dir2 = 0;
+
+	if ( !(*proot) )
+		return 0;
+	memset( &head, 0, sizeof(head) );
+	head.rc = *proot;
+	for ( ; TDRBT_LINK( q, dir ); ) {
+		last = dir;
+		g = p;
+		p = q;
+		q = TDRBT_LINK( q, dir );
+		dir = ( q->data < key );
+		if ( q->data == key )
+			f = q;
+		if ( TDRBT_IS_RED( q ) || TDRBT_IS_RED( TDRBT_LINK( q, dir ) ) )
+			continue;
+		if ( TDRBT_IS_RED( TDRBT_LINK( q, !dir ) ) ) {
+			TDRBT_LINK( p, last ) = tdrbt_single( q, dir );
+			p = TDRBT_LINK( p, last );
+		} else {
+			s = TDRBT_LINK( p, !last );
+			if ( !s )
+				continue;
+			if ( !TDRBT_IS_RED( s->lc ) && !TDRBT_IS_RED( s->rc ) ) {
+				p->rb = BLACK;
+				s->rb = RED;
+				q->rb = RED;
+			} else {
+				dir2 = ( g->rc == p );
+				if ( TDRBT_IS_RED( TDRBT_LINK( s, last ) ) )
+					TDRBT_LINK( g, dir2 ) = tdrbt_double( p, last );
+				else
+					TDRBT_LINK( g, dir2 ) = tdrbt_single( p, last );
+				q->rb = RED;
+				TDRBT_LINK( g, dir2 )->rb = RED;
+				TDRBT_LINK( g, dir2 )->lc->rb = BLACK;
+				TDRBT_LINK( g, dir2 )->rc->rb = BLACK;
+			}
+		}
+	}
+	if ( f ) {
+		f->data = q->data;
+		TDRBT_LINK( p, p->rc == q ) = TDRBT_LINK( q, !q->lc );
+		free( q );
+	}
+	(*proot) = head.rc;
+	if ( *proot )
+		(*proot)->rb = BLACK;
+
+	return f ? 1 : 0;
+}
+
+/**
+ * @brief tdrbt_destroy - destroy top-down red black tree, free it's space.
+ * @param proot pointer to the pointer to the root of red black tree.
+ * @return 0 for success.
+ */
+int
+tdrbt_destroy( ptdrbt *proot )
+{
+	if ( *proot ) {
+		tdrbt_destroy( &(*proot)->lc );
+		tdrbt_destroy( &(*proot)->rc );
+		free( *proot );
+		(*proot) = NULL;
+	}
+
+	return 0;
+}
+
+/**
+ * @brief tdrbt_dump_lc - access functions used by treedump.h.
+ */
+static void *
+tdrbt_dump_lc( void *n )
+{
+	return ( ( ptdrbt )n )->lc;
+}
+
+static void *
+tdrbt_dump_rc( void *n )
+{
+	return ( ( ptdrbt )n )->rc;
+}
+
+static long long
+tdrbt_dump_key( void *n )
+{
+	return ( ( ptdrbt )n )->data;
+}
+
+static int
+tdrbt_dump_attr( void *n )
+{
+	return ( ( ptdrbt )n )->rb;
+}
+
+static const tree_dump_ops tdrbt_dump_ops = {
+	tdrbt_dump_lc, tdrbt_dump_rc, tdrbt_dump_key, tdrbt_dump_attr, TDUMP_ATTR_COLOR, sizeof(int)
+};
+
+/**
+ * @brief tdrbt_dump - dump top-down red black tree without recursion.
+ * @param proot pointer to the root of top-down red black tree.
+ * @param d pointer to the writer initialized by tdump_init.
+ * @return 1 for succeed,
+ *	   0 for failure.
+ */
+int
+tdrbt_dump( ptdrbt proot, ptree_dump d )
+{
+	return tdump_tree( d, proot, NULL, &tdrbt_dump_ops );
+}
+
+/**
+ * @brief tdrbt_show - show all node's information of top-down red black tree.
+ * @param proot pointer to the node of red black tree.
+ * @param parent pointer to the parent node of node which pointer proot point to
+ * @return none.
+ *
+ * 通过treedump.h以文本格式写到标准输出，不再递归调用printf。
+ */
+void
+tdrbt_show( ptdrbt proot, ptdrbt parent )
+{
+	char buf[8192];
+	tree_dump d;
+
+	fflush( stdout );
+	tdump_init( &d, STDOUT_FILENO, buf, sizeof(buf), TDUMP_TEXT );
+	tdump_tree( &d, proot, parent, &tdrbt_dump_ops );
+
+	return;
+}
+
+int
+main()
+{
+	int array[INIT_SIZE];
+	int array1[INIT_SIZE] = {87,10,68,69,6,27,24,28,70,62};
+	int i = 0;
+	ptdrbt proot = NULL; /* 此处一定要显式置NULL，否则调用会出错，因为是根 */
+	ptdrbt proot1 = NULL;
+
+	srand( (unsigned int)time(NULL) );
+	for ( i = 0; i < INIT_SIZE; i++ ) {
+		array[i] = rand() % 100;
+		printf("%-4d", array[i]);
+	}
+	printf("\n");
+	/* 创建红黑树 */
+	for ( i = 0; i < INIT_SIZE; i++ ) {
+		tdrbt_insert( &proot, array[i] );
+	}
+	tdrbt_show( proot, NULL );
+	printf("\n");
+	printf("%d %s.\n", array[5], tdrbt_search1( proot, array[5] ) ? "found" : "not exists");
+	for ( i = 0; i < INIT_SIZE; i++ ) {
+		tdrbt_delete( &proot, array[i] );
+	}
+	printf("after delete all: %s.\n", proot ? "not empty" : "empty");
+
+	printf("======================分割线======================\n");
+	for ( i = 0; i < INIT_SIZE; i++ ) {
+		tdrbt_insert( &proot1, array1[i] );
+	}
+	tdrbt_show( proot1, NULL );
+	printf("\n");
+	for ( i = 0; i < INIT_SIZE / 2; i++ ) {
+		printf("%d -- \n", array1[i]);
+		tdrbt_delete( &proot1, array1[i] );
+		tdrbt_show( proot1, NULL );
+		printf("\n");
+	}
+	tdrbt_destroy( &proot1 );
+
+	return 0;
+}
@@ -0,0 +1,39 @@
+/**
+ * @file tdredblacktree.h
+ * @brief describe top-down red black tree's defination and basic oprations.
+ * @author watertiger <darkwkt@gmail.com>
+ * @date 2026-10-19
+ */
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "treedump.h"
+
+/**
+ * @brief define the top-down red black tree node and it's basic oprations
+ *
+ * 自顶向下的红黑树与redblacktree.h中的红黑树满足同样的5条性质，
+ * 但插入和删除在从根向下查找的同一趟中完成变色和旋转：
+ *	插入时，遇到两个孩子都为红色的节点就先做颜色翻转，保证到达叶子时
+ *	可以直接挂上红色新节点，途中出现的连续红色用旋转立即修正；
+ *	删除时，沿途把当前节点"推"成红色，保证最后删除的是红色节点。
+ * 调整只涉及查找路径上的曾祖父、祖父、双亲和当前节点，不需要回溯，
+ * 因此节点中没有双亲指针，每个节点节省8字节。
+ */
+#ifndef RED
+#define RED 0
+#define BLACK 1
+#endif
+
+typedef struct _td_red_black_tree {
+	int data;
+	int rb;
+	struct _td_red_black_tree *lc, *rc;/* left and right child pointer */
+}tdrbt_node, *ptdrbt;
+
+ptdrbt tdrbt_search1( ptdrbt proot, int key );
+int tdrbt_insert( ptdrbt *proot, int e );
+int tdrbt_delete( ptdrbt *proot, int key );
+int tdrbt_destroy( ptdrbt *proot );
+void tdrbt_show( ptdrbt proot, ptdrbt parent );
+int tdrbt_dump( ptdrbt proot, ptree_dump d );
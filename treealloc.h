@@ -0,0 +1,288 @@
+/**
+ * @file treealloc.h
+ * @brief describe the node arena backed by huge pages and NUMA policy.
+ * @author watertiger <darkwkt@gmail.com>
+ * @date 2026-10-19
+ */
+#ifndef _TREEALLOC_H
+#define _TREEALLOC_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+
+/**
+ * @brief define the node arena and it's basic oprations
+ *
+ * 树节点的内存池：
+ *	初始化时一次性保留max_bytes的虚拟地址空间（按2MB对齐，MAP_NORESERVE，
+ *	不占物理内存），节点从中顺序切分，释放的节点进入空闲链表，再分配时
+ *	优先复用。物理页在第一次访问时才分配。
+ *	TARENA_HUGE：对整个区域调用madvise(MADV_HUGEPAGE)，由透明大页（THP）
+ *	以2MB页提供内存，一个TLB表项覆盖的节点数是4KB页的512倍，随机下降
+ *	时每层几乎都发生的TLB缺失大为减少。
+ *	TARENA_BIND、TARENA_INTERLEAVE：在访问前对区域调用mbind，把节点
+ *	绑定到nodemask指定的NUMA节点，或在这些节点间按页交错分布。
+ *	tarena_stats统计大页覆盖的字节数、覆盖树需要的TLB表项数，并用
+ *	move_pages抽样查询页所在的NUMA节点，给出远端访问的比例。
+ * mbind、madvise失败时（内核不支持或没有权限）只打印警告，退回普通页
+ * 和默认策略。直接使用系统调用，不依赖libnuma。
+ *
+ * 节点大小在初始化时确定，不超过该大小的分配都可以由内存池满足。
+ * 内存池不加锁，只能由修改树的线程使用。
+ * 本文件只包含静态函数，可以被多个模块直接包含。
+ */
+#define TARENA_DEFAULT		0	/* 默认NUMA策略：分配线程所在节点 */
+#define TARENA_BIND		1
+#define TARENA_INTERLEAVE	2
+#define TARENA_POLICY		3	/* 取策略的掩码 */
+#define TARENA_HUGE		4	/* 使用透明大页 */
+
+#define TARENA_PAGE		4096UL
+#define TARENA_HUGE_PAGE	( 2UL << 20 )
+#define TARENA_MAX_NODES	64
+#define TARENA_SAMPLE		4096	/* tarena_stats最多抽样的页数 */
+
+#ifndef MPOL_BIND
+#define MPOL_BIND		2
+#define MPOL_INTERLEAVE		3
+#endif
+
+typedef struct _tree_arena {
+	char *base;
+	size_t reserved;	/* 保留的地址空间 */
+	size_t used;		/* 已切分的字节数 */
+	size_t size;		/* 节点大小 */
+	void *free;		/* 空闲节点链表 */
+	long nodes;		/* 正在使用的节点数 */
+	int flags;		/* 实际生效的标志 */
+	unsigned long nodemask;
+}tree_arena, *ptree_arena;
+
+typedef struct _tree_arena_stats {
+	size_t used;
+	size_t resident;	/* 已分配物理页的字节数 */
+	size_t huge;		/* 其中由2MB大页提供的字节数 */
+	long tlb_pages;		/* 覆盖全部节点需要的TLB表项数 */
+	int local_node;		/* 调用线程所在的NUMA节点 */
+	long sampled;		/* 抽样查询的页数 */
+	long remote;		/* 其中不在local_node上的页数 */
+	long pages[TARENA_MAX_NODES];	/* 各NUMA节点上抽样到的页数 */
+}tree_arena_stats, *ptree_arena_stats;
+
+/**
+ * @brief tarena_init - reserve address space for the arena.
+ * @param a pointer to the arena.
+ * @param size the size of node.
+ * @param max_bytes the most bytes of nodes the arena can hold.
+ * @param flags TARENA_HUGE or'ed with one of TARENA_DEFAULT, TARENA_BIND,
+ *	  TARENA_INTERLEAVE.
+ * @param nodemask bit i set for NUMA node i, used by bind and interleave.
+ * @return 1 for succeed,
+ *	   0 for failure.
+ */
+static inline int
+tarena_init( ptree_arena a, size_t size, size_t max_bytes, int flags, unsigned long nodemask )
+{
+	char *p = NULL;
+	size_t len = 0;
+	size_t head = 0;
+	long mode = 0;
+
+	size = ( size + sizeof(void *) - 1 ) & ~( sizeof(void *) - 1 );
+	max_bytes = ( max_bytes + TARENA_HUGE_PAGE - 1 ) & ~( TARENA_HUGE_PAGE - 1 );
+	len = max_bytes + TARENA_HUGE_PAGE;
+	p = ( char * )mmap( NULL, len, PROT_READ | PROT_WRITE,
+			    MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0 );
+	if ( MAP_FAILED == p ) {
+		printf("No Memory!!\n");
+		return 0;
+	}
+	/* 对齐到2MB，大页才能覆盖整个区域 */
+	head = ( TARENA_HUGE_PAGE - (unsigned long)p % TARENA_HUGE_PAGE ) % TARENA_HUGE_PAGE;
+	if ( head )
+		munmap( p, head );
+	if ( len - head > max_bytes )
+		munmap( p + head + max_bytes, len - head - max_bytes );
+
+	a->base = p + head;
+	a->reserved = max_bytes;
+	a->used = 0;
+	a->size = size;
+	a->free = NULL;
+	a->nodes = 0;
+	a->flags = flags;
+	a->nodemask = nodemask;
+	if ( ( flags & TARENA_HUGE ) && madvise( a->base, max_bytes, MADV_HUGEPAGE ) ) {
+		printf("madvise(MADV_HUGEPAGE) failed, use normal pages.\n");
+		a->flags &= ~TARENA_HUGE;
+	}
+	mode = ( TARENA_BIND == ( flags & TARENA_POLICY ) ) ? MPOL_BIND : MPOL_INTERLEAVE;
+	if ( ( flags & TARENA_POLICY ) && syscall( SYS_mbind, a->base, max_bytes, mode,
+	     &a->nodemask, sizeof(a->nodemask) * 8, 0 ) ) {
+		printf("mbind failed, use the default policy.\n");
+		a->flags &= ~TARENA_POLICY;
+	}
+
+	return 1;
+}
+
+/**
+ * @brief tarena_alloc - allocate a node from the arena.
+ * @param a pointer to the arena.
+ * @return pointer to the node,
+ *	   NULL pointer if the address space reserved is used up.
+ */
+static inline void *
+tarena_alloc( ptree_arena a )
+{
+	void *p = a->free;
+
+	if ( p ) {
+		a->free = *( void ** )p;
+	} else {
+		if ( a->used + a->size > a->reserved )
+			return NULL;
+		p = a->base + a->used;
+		a->used += a->size;
+	}
+	a->nodes++;
+
+	return p;
+}
+
+/**
+ * @brief tarena_alloc_many - allocate count contiguous nodes from the arena.
+ * @param a pointer to the arena.
+ * @param count count of nodes.
+ * @return pointer to the first node, the others follow every size bytes,
+ *	   NULL pointer if the address space reserved is used up.
+ *
+ * 不使用空闲链表，直接从未切分的部分取一段连续的空间，可以分给多个线程
+ * 各自初始化；这些节点之后仍可以逐个用tarena_free释放。
+ */
+static inline void *
+tarena_alloc_many( ptree_arena a, long count )
+{
+	void *p = NULL;
+
+	if ( count <= 0 || a->used + count * a->size > a->reserved )
+		return NULL;
+	p = a->base + a->used;
+	a->used += count * a->size;
+	a->nodes += count;
+
+	return p;
+}
+
+/**
+ * @brief tarena_owns - test whether the node comes from the arena.
+ * @param a pointer to the arena.
+ * @param p pointer to the node.
+ * @return 1 for yes,
+ *	   0 for no.
+ */
+static inline int
+tarena_owns( ptree_arena a, void *p )
+{
+	return ( char * )p >= a->base && ( char * )p < a->base + a->reserved;
+}
+
+/**
+ * @brief tarena_free - return a node to the arena.
+ * @param a pointer to the arena.
+ * @param p pointer to the node.
+ */
+static inline void
+tarena_free( ptree_arena a, void *p )
+{
+	*( void ** )p = a->free;
+	a->free = p;
+	a->nodes--;
+}
+
+/**
+ * @brief tarena_stats - collect page size and NUMA placement of the arena.
+ * @param a pointer to the arena.
+ * @param st pointer to store the statistics.
+ * @return 1 for succeed,
+ *	   0 for failure.
+ *
+ * 常驻和大页字节数来自/proc/self/smaps中与区域重叠的各段（mbind、
+ * madvise可能把区域拆成几段）。所在节点由move_pages在已使用的范围内
+ * 均匀抽样查询。
+ */
+static inline int
+tarena_stats( ptree_arena a, ptree_arena_stats st )
+{
+	char line[256];
+	FILE *fp = NULL;
+	unsigned long lo = 0;
+	unsigned long hi = 0;
+	unsigned long kb = 0;
+	unsigned int cpu = 0;
+	unsigned int node = 0;
+	int in = 0;
+	void *pages[TARENA_SAMPLE];
+	int status[TARENA_SAMPLE];
+	size_t span = ( a->used + TARENA_PAGE - 1 ) / TARENA_PAGE;
+	size_t step = span / TARENA_SAMPLE + 1;
+	long n = 0;
+	long i = 0;
+
+	memset( st, 0, sizeof(*st) );
+	st->used = a->used;
+	fp = fopen( "/proc/self/smaps", "r" );
+	if ( !fp )
+		return 0;
+	for ( ; fgets( line, sizeof(line), fp ); ) {
+		if ( 2 == sscanf( line, "%lx-%lx ", &lo, &hi ) ) {
+			in = lo < (unsigned long)a->base + a->reserved && hi > (unsigned long)a->base;
+		} else if ( in && 1 == sscanf( line, "Rss: %lu kB", &kb ) ) {
+			st->resident += kb << 10;
+		} else if ( in && 1 == sscanf( line, "AnonHugePages: %lu kB", &kb ) ) {
+			st->huge += kb << 10;
+		}
+	}
+	fclose( fp );
+	st->tlb_pages = st->huge / TARENA_HUGE_PAGE +
+			( st->resident - st->huge ) / TARENA_PAGE;
+
+	syscall( SYS_getcpu, &cpu, &node, NULL );
+	st->local_node = node;
+	for ( i = 0; i < (long)span && n < TARENA_SAMPLE; i += step )
+		pages[n++] = a->base + i * TARENA_PAGE;
+	if ( n && !syscall( SYS_move_pages, 0, n, pages, NULL, status, 0 ) ) {
+		for ( i = 0; i < n; i++ ) {
+			if ( status[i] < 0 || status[i] >= TARENA_MAX_NODES )
+				continue;	/* 未分配物理页 */
+			st->sampled++;
+			st->pages[status[i]]++;
+			if ( status[i] != (int)node )
+				st->remote++;
+		}
+	}
+
+	return 1;
+}
+
+/**
+ * @brief tarena_destroy - release all memory of the arena.
+ * @param a pointer to the arena.
+ */
+static inline void
+tarena_destroy( ptree_arena a )
+{
+	if ( a->base )
+		munmap( a->base, a->reserved );
+	a->base = NULL;
+	a->reserved = 0;
+	a->used = 0;
+	a->free = NULL;
+	a->nodes = 0;
+}
+
+#endif
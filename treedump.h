@@ -0,0 +1,402 @@
+/**
+ * @file treedump.h
+ * @brief describe buffered tree dump in text, DOT, JSON and binary format.
+ * @author watertiger <darkwkt@gmail.com>
+ * @date 2026-10-19
+ */
+#ifndef _TREEDUMP_H
+#define _TREEDUMP_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+
+/**
+ * @brief define the tree dump writer and it's basic oprations
+ *
+ * 树的导出：
+ *	输出先写入一块大缓冲区，缓冲区满时一次write写入文件描述符；
+ *	没有文件描述符时（fd为-1）只写入用户提供的缓冲区，写满即失败。
+ *	整数用两位一组的查表法直接格式化到缓冲区中，不经过printf。
+ *	遍历不使用递归，用堆上可增长的栈，退化成链表的树也不会栈溢出。
+ * 支持4种格式：
+ *	TDUMP_TEXT - 与原来的xxx_show相同的文本，前序；
+ *	TDUMP_DOT  - Graphviz DOT，前序；
+ *	TDUMP_JSON - 节点对象组成的数组，前序；
+ *	TDUMP_BIN  - 按中序输出的原始关键字（本机字节序），即有序的关键字数组。
+ * 各种树通过tree_dump_ops提供孩子、关键字及附加属性（平衡因子或颜色）的
+ * 访问函数，调用tdump_tree导出。
+ *
+ * 本文件只包含静态函数，可以被多个模块直接包含。
+ */
+#define TDUMP_TEXT	0
+#define TDUMP_DOT	1
+#define TDUMP_JSON	2
+#define TDUMP_BIN	3
+
+#define TDUMP_ATTR_NONE		0
+#define TDUMP_ATTR_BF		1	/* 平衡因子 */
+#define TDUMP_ATTR_COLOR	2	/* 0为红色，1为黑色 */
+
+#define TDUMP_MIN_BUF	1024
+#define TDUMP_NODE_MAX	256	/* 一个节点最多输出的字节数 */
+
+typedef struct _tree_dump {
+	char *buf;
+	size_t len;
+	size_t cap;
+	int fd;
+	int fmt;
+	int error;
+	long count;	/* 已输出的节点数 */
+}tree_dump, *ptree_dump;
+
+typedef struct _tree_dump_ops {
+	void *(*lc)( void *n );
+	void *(*rc)( void *n );
+	long long (*key)( void *n );
+	int (*attr)( void *n );	/* 可以为NULL */
+	int attr_kind;
+	int key_bytes;		/* TDUMP_BIN时每个关键字的字节数，4或8 */
+}tree_dump_ops;
+
+static const char tdump_digits[] =
+	"00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+	"40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+	"8081828384858687888990919293949596979899";
+
+/**
+ * @brief tdump_init - initialize the writer.
+ * @param d pointer to the writer.
+ * @param fd file descriptor to write, -1 for writing into buf only.
+ * @param buf the buffer, at least TDUMP_MIN_BUF bytes.
+ * @param cap size of the buffer.
+ * @param fmt the format.
+ * @return 1 for succeed,
+ *	   0 for buffer too small.
+ */
+static int
+tdump_init( ptree_dump d, int fd, char *buf, size_t cap, int fmt )
+{
+	d->buf = buf;
+	d->len = 0;
+	d->cap = cap;
+	d->fd = fd;
+	d->fmt = fmt;
+	d->error = ( cap < TDUMP_MIN_BUF );
+	d->count = 0;
+
+	return !d->error;
+}
+
+/**
+ * @brief tdump_flush - write the buffer to the file descriptor.
+ * @param d pointer to the writer.
+ * @return 1 for succeed,
+ *	   0 for failure.
+ */
+static int
+tdump_flush( ptree_dump d )
+{
+	size_t off = 0;
+	ssize_t w = 0;
+
+	if ( d->fd < 0 || d->error )
+		return !d->error;
+	for ( ; off < d->len; ) {
+		w = write( d->fd, d->buf + off, d->len - off );
+		if ( w < 0 && EINTR == errno )
+			continue;
+		if ( w <= 0 ) {
+			d->error = 1;
+			return 0;
+		}
+		off += w;
+	}
+	d->len = 0;
+
+	return 1;
+}
+
+/**
+ * @brief tdump_reserve - make sure n bytes can be written into the buffer.
+ */
+static int
+tdump_reserve( ptree_dump d, size_t n )
+{
+	if ( d->error )
+		return 0;
+	if ( d->len + n > d->cap ) {
+		if ( d->fd < 0 ) {
+			d->error = 1;	/* 用户缓冲区已满 */
+			return 0;
+		}
+		return tdump_flush( d );
+	}
+
+	return 1;
+}
+
+/**
+ * @brief tdump_str - append a string, space must be reserved.
+ */
+static inline void
+tdump_str( ptree_dump d, const char *s )
+{
+	for ( ; *s; s++ )
+		d->buf[d->len++] = *s;
+}
+
+/**
+ * @brief tdump_int - append an integer, space must be reserved.
+ * @param d pointer to the writer.
+ * @param v the integer.
+ * @param width left justified width, like %-4d.
+ * @return none.
+ */
+static inline void
+tdump_int( ptree_dump d, long long v, int width )
+{
+	char tmp[24];
+	int pos = 24;
+	int n = 0;
+	unsigned long long u = v < 0 ? 0ULL - (unsigned long long)v : (unsigned long long)v;
+
+	for ( ; u >= 100; u /= 100 ) {
+		pos -= 2;
+		memcpy( tmp + pos, tdump_digits + ( u % 100 ) * 2, 2 );
+	}
+	if ( u >= 10 ) {
+		pos -= 2;
+		memcpy( tmp + pos, tdump_digits + u * 2, 2 );
+	} else {
+		tmp[--pos] = '0' + u;
+	}
+	if ( v < 0 )
+		tmp[--pos] = '-';
+	n = 24 - pos;
+	memcpy( d->buf + d->len, tmp + pos, n );
+	d->len += n;
+	for ( ; n < width; n++ )
+		d->buf[d->len++] = ' ';
+}
+
+/**
+ * @brief tdump_begin - write the header of the format.
+ */
+static void
+tdump_begin( ptree_dump d )
+{
+	if ( !tdump_reserve( d, TDUMP_NODE_MAX ) )
+		return;
+	if ( TDUMP_DOT == d->fmt )
+		tdump_str( d, "digraph tree {\n\tnode [shape=circle];\n" );
+	else if ( TDUMP_JSON == d->fmt )
+		tdump_str( d, "[" );
+}
+
+/**
+ * @brief tdump_end - write the tail of the format and flush.
+ * @return 1 for succeed,
+ *	   0 for failure.
+ */
+static int
+tdump_end( ptree_dump d )
+{
+	if ( tdump_reserve( d, TDUMP_NODE_MAX ) ) {
+		if ( TDUMP_DOT == d->fmt )
+			tdump_str( d, "}\n" );
+		else if ( TDUMP_JSON == d->fmt )
+			tdump_str( d, "\n]\n" );
+	}
+
+	return tdump_flush( d );
+}
+
+/**
+ * @brief tdump_link - write "XX:key" or "XX:$   " in text format.
+ */
+static inline void
+tdump_link( ptree_dump d, const char *name, void *n, const tree_dump_ops *ops, const char *nil )
+{
+	tdump_str( d, name );
+	if ( n )
+		tdump_int( d, ops->key( n ), 4 );
+	else
+		tdump_str( d, nil );
+}
+
+/**
+ * @brief tdump_json_link - write ,"name":key or ,"name":null in JSON format.
+ */
+static inline void
+tdump_json_link( ptree_dump d, const char *name, void *n, const tree_dump_ops *ops )
+{
+	tdump_str( d, name );
+	if ( n )
+		tdump_int( d, ops->key( n ), 0 );
+	else
+		tdump_str( d, "null" );
+}
+
+/**
+ * @brief tdump_node - write one node.
+ * @param d pointer to the writer.
+ * @param n pointer to the node.
+ * @param parent pointer to the node's parent, may be NULL.
+ * @param ops the access functions.
+ * @return none.
+ */
+static void
+tdump_node( ptree_dump d, void *n, void *parent, const tree_dump_ops *ops )
+{
+	long long key = ops->key( n );
+	int attr = ops->attr ? ops->attr( n ) : 0;
+	int k32 = 0;
+
+	if ( !tdump_reserve( d, TDUMP_NODE_MAX ) )
+		return;
+	d->count++;
+	switch ( d->fmt ) {
+	case TDUMP_TEXT:
+		tdump_str( d, "Current:" );
+		tdump_int( d, key, 4 );
+		if ( TDUMP_ATTR_BF == ops->attr_kind ) {
+			d->buf[d->len++] = '(';
+			d->buf[d->len++] = attr < 0 ? '-' : '+';
+			tdump_int( d, attr < 0 ? -attr : attr, 0 );
+			tdump_str( d, "). " );
+		} else if ( TDUMP_ATTR_COLOR == ops->attr_kind ) {
+			tdump_str( d, attr ? " color:BLACK. " : " color:RED. " );
+		}
+		tdump_link( d, "LC:", ops->lc( n ), ops, "$   " );
+		tdump_link( d, "RC:", ops->rc( n ), ops, "$   " );
+		tdump_link( d, "P:", parent, ops, "$   " );
+		d->buf[d->len++] = '\n';
+		break;
+	case TDUMP_DOT:
+		d->buf[d->len++] = '\t';
+		tdump_int( d, key, 0 );
+		tdump_str( d, " [label=\"" );
+		tdump_int( d, key, 0 );
+		if ( TDUMP_ATTR_BF == ops->attr_kind ) {
+			tdump_str( d, attr < 0 ? "\\n-" : "\\n+" );
+			tdump_int( d, attr < 0 ? -attr : attr, 0 );
+		}
+		d->buf[d->len++] = '"';
+		if ( TDUMP_ATTR_COLOR == ops->attr_kind )
+			tdump_str( d, attr ? ", style=filled, fillcolor=black, fontcolor=white"
+				       : ", style=filled, fillcolor=red, fontcolor=white" );
+		tdump_str( d, "];\n" );
+		if ( parent ) {
+			d->buf[d->len++] = '\t';
+			tdump_int( d, ops->key( parent ), 0 );
+			tdump_str( d, " -> " );
+			tdump_int( d, key, 0 );
+			tdump_str( d, ";\n" );
+		}
+		break;
+	case TDUMP_JSON:
+		tdump_str( d, d->count > 1 ? ",\n{\"key\":" : "\n{\"key\":" );
+		tdump_int( d, key, 0 );
+		tdump_json_link( d, ",\"lc\":", ops->lc( n ), ops );
+		tdump_json_link( d, ",\"rc\":", ops->rc( n ), ops );
+		tdump_json_link( d, ",\"parent\":", parent, ops );
+		if ( TDUMP_ATTR_BF == ops->attr_kind ) {
+			tdump_str( d, ",\"bf\":" );
+			tdump_int( d, attr, 0 );
+		} else if ( TDUMP_ATTR_COLOR == ops->attr_kind ) {
+			tdump_str( d, attr ? ",\"color\":\"black\"" : ",\"color\":\"red\"" );
+		}
+		d->buf[d->len++] = '}';
+		break;
+	case TDUMP_BIN:
+		if ( 4 == ops->key_bytes ) {
+			k32 = (int)key;
+			memcpy( d->buf + d->len, &k32, 4 );
+			d->len += 4;
+		} else {
+			memcpy( d->buf + d->len, &key, 8 );
+			d->len += 8;
+		}
+		break;
+	}
+}
+
+/**
+ * @brief tdump_tree - dump the whole tree without recursion.
+ * @param d pointer to the writer.
+ * @param root pointer to the root of the tree.
+ * @param parent pointer to the root's parent, usually NULL.
+ * @param ops the access functions.
+ * @return 1 for succeed,
+ *	   0 for failure.
+ *
+ * 栈中成对保存节点及其双亲。TDUMP_BIN按中序，其余格式按前序
+ * （先压右孩子再压左孩子）。
+ */
+static int
+tdump_tree( ptree_dump d, void *root, void *parent, const tree_dump_ops *ops )
+{
+	void **stack = NULL;
+	void **tmp = NULL;
+	long top = 0;
+	long cap = 256;
+	void *n = root;
+
+	stack = ( void ** )malloc( cap * sizeof(void *) );
+	if ( !stack ) {
+		printf("No Memory!!\n");
+		return 0;
+	}
+	tdump_begin( d );
+	if ( TDUMP_BIN != d->fmt && n ) {
+		stack[top++] = n;
+		stack[top++] = parent;
+	}
+	for ( ; !d->error; ) {
+		if ( top + 4 > cap ) {
+			tmp = ( void ** )realloc( stack, cap * 2 * sizeof(void *) );
+			if ( !tmp ) {
+				printf("No Memory!!\n");
+				d->error = 1;
+				break;
+			}
+			stack = tmp;
+			cap *= 2;
+		}
+		if ( TDUMP_BIN == d->fmt ) {
+			if ( n ) {	/* 一直向左，沿途入栈 */
+				stack[top++] = n;
+				n = ops->lc( n );
+				continue;
+			}
+			if ( !top )
+				break;
+			n = stack[--top];
+			tdump_node( d, n, NULL, ops );
+			n = ops->rc( n );
+			continue;
+		}
+		if ( !top )
+			break;
+		parent = stack[--top];
+		n = stack[--top];
+		tdump_node( d, n, parent, ops );
+		if ( ops->rc( n ) ) {
+			stack[top++] = ops->rc( n );
+			stack[top++] = n;
+		}
+		if ( ops->lc( n ) ) {
+			stack[top++] = ops->lc( n );
+			stack[top++] = n;
+		}
+	}
+	free( stack );
+
+	return tdump_end( d );
+}
+
+#endif
@@ -0,0 +1,154 @@
+/**
+ * @file treetmpl.c
+ * @brief show how to specialise the tree templates in treetmpl.h.
+ * @author watertiger <darkwkt@gmail.com>
+ * @date 2026-10-19
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/* int集合，红黑树，与prbt相同的比较方式 */
+#define TREE_PREFIX iset
+#define TREE_KEY_TYPE int
+#define TREE_ENGINE TREE_RBT
+#include "treetmpl.h"
+
+/* 字符串到int的映射，AVL树，比较函数strcmp在查找路径中直接展开 */
+#define TREE_PREFIX strmap
+#define TREE_KEY_TYPE const char *
+#define TREE_VALUE_TYPE int
+#define TREE_KEY_LESS(a, b) ( strcmp( (a), (b) ) < 0 )
+#define TREE_ENGINE TREE_AVL
+#include "treetmpl.h"
+
+/* 64位关键字到定长结构体的映射，二叉排序树，降序排列 */
+typedef struct _payload {
+	int id;
+	char tag[12];
+}payload;
+
+#define TREE_PREFIX descmap
+#define TREE_KEY_TYPE long long
+#define TREE_VALUE_TYPE payload
+#define TREE_KEY_LESS(a, b) ( (a) > (b) )
+#define TREE_ENGINE TREE_BST
+#include "treetmpl.h"
+
+/* 带子树散列的int集合，AVL树，用于比较两个副本 */
+static inline unsigned long long
+mix64( unsigned long long x )
+{
+	x ^= x >> 33;
+	x *= 0xff51afd7ed558ccdULL;
+	x ^= x >> 33;
+	x *= 0xc4ceb9fe1a85ec53ULL;
+	x ^= x >> 33;
+
+	return x;
+}
+
+#define TREE_PREFIX hset
+#define TREE_KEY_TYPE int
+#define TREE_ENGINE TREE_AVL
+#define TREE_HASH(n) mix64( (unsigned int)(n)->key )
+#include "treetmpl.h"
+
+#define INIT_SIZE 10
+#define REPLICA_SIZE ( 1 << 16 )
+
+/**
+ * @brief hset_report - print one difference between two replicas.
+ */
+static void
+hset_report( phset pa, phset pb, void *arg )
+{
+	printf("%d only in %s.\n", pa ? pa->key : pb->key, pa ? "a" : "b");
+	(void)arg;
+}
+
+/**
+ * @brief iset_show - in order show all keys of the int set.
+ * @param proot pointer to the node of int set.
+ * @return none.
+ */
+void
+iset_show( piset proot )
+{
+	if ( proot ) {
+		iset_show( proot->lc );
+		printf("%-4d", proot->key);
+		iset_show( proot->rc );
+	}
+
+	return;
+}
+
+int
+main()
+{
+	int array[INIT_SIZE];
+	const char *words[] = {"pear", "apple", "fig", "kiwi", "plum", "lime"};
+	int i = 0;
+	int value = 0;
+	piset pset = NULL;
+	pstrmap pmap = NULL;
+	pdescmap pdesc = NULL;
+	pdescmap pfind = NULL;
+	phset pa = NULL;
+	phset pb = NULL;
+	payload pl;
+
+	srand( (unsigned int)time(NULL) );
+	for ( i = 0; i < INIT_SIZE; i++ ) {
+		array[i] = rand() % 100;
+		printf("%-4d", array[i]);
+		iset_insert( &pset, array[i] );
+	}
+	printf("\n");
+	iset_show( pset );
+	printf("\n");
+	iset_delete( &pset, array[5] );
+	printf("%d %s.\n", array[5], iset_search( pset, array[5] ) ? "found" : "not exists");
+	iset_destroy( &pset );
+
+	for ( i = 0; i < 6; i++ )
+		strmap_insert( &pmap, words[i], (int)strlen( words[i] ) );
+	strmap_delete( &pmap, "fig" );
+	for ( i = 0; i < 6; i++ ) {
+		if ( strmap_get( pmap, words[i], &value ) )
+			printf("%s -> %d\n", words[i], value);
+		else
+			printf("%s not exists.\n", words[i]);
+	}
+	strmap_destroy( &pmap );
+
+	for ( i = 0; i < INIT_SIZE; i++ ) {
+		pl.id = i;
+		sprintf( pl.tag, "n%d", array[i] );
+		descmap_insert( &pdesc, (long long)array[i] << 32, pl );
+	}
+	pfind = descmap_search( pdesc, (long long)array[3] << 32 );
+	if ( pfind )
+		printf("Key found. id:%d tag:%s, root key:%lld.\n",
+		       pfind->value.id, pfind->value.tag, pdesc->key >> 32);
+	descmap_destroy( &pdesc );
+
+	/* 两个副本以相反的顺序插入，形状不同但散列相同 */
+	for ( i = 0; i < REPLICA_SIZE; i++ ) {
+		hset_insert( &pa, i * 2 );
+		hset_insert( &pb, ( REPLICA_SIZE - 1 - i ) * 2 );
+	}
+	printf("replicas %s, root a:%d b:%d.\n",
+	       hset_hash( pa ) == hset_hash( pb ) ? "equal" : "differ", pa->key, pb->key);
+	for ( i = 0; i < 3; i++ ) {
+		hset_delete( &pa, array[i] * 2 );
+		hset_insert( &pb, array[i] * 2 + 1 );
+	}
+	printf("%ld differences.\n", hset_diff( pa, pb, hset_report, NULL ));
+	hset_destroy( &pa );
+	hset_destroy( &pb );
+
+	return 0;
+}
@@ -0,0 +1,1033 @@
+/**
+ * @file treetmpl.h
+ * @brief compile-time specialised binary search tree, AVL tree and red black tree.
+ * @author watertiger <darkwkt@gmail.com>
+ * @date 2026-10-19
+ *
+ * 这是一个"模板"头文件，没有包含保护，每包含一次就按照当前定义的参数宏
+ * 生成一套独立的节点类型和操作函数，比较操作直接展开在查找路径中，
+ * 不需要函数指针，因此与int版本的速度相同。
+ *
+ * 参数宏（包含后全部被#undef，可以接着生成下一套）：
+ *	TREE_PREFIX		生成的类型与函数名前缀，必须定义
+ *	TREE_KEY_TYPE		关键字类型，必须定义
+ *	TREE_VALUE_TYPE		值域类型，未定义时节点不含值域（集合）
+ *	TREE_KEY_LESS(a, b)	关键字比较，默认 ((a) < (b))
+ *	TREE_ENGINE		TREE_BST / TREE_AVL / TREE_RBT，默认 TREE_RBT
+ *	TREE_ALLOC(size)	节点分配，默认 malloc
+ *	TREE_FREE(p)		节点释放，默认 free
+ *	TREE_HASH(n)		节点n的64位散列值，定义后每个节点增加子树散列，
+ *				仅用于 TREE_AVL 和 TREE_RBT
+ *
+ * 节点布局在编译时按引擎确定：TREE_BST 只有孩子指针，TREE_AVL 增加平衡
+ * 因子，TREE_RBT 增加颜色和双亲指针。关键字和值域均按值内嵌在节点中。
+ *
+ * 子树散列为子树中各节点TREE_HASH之和（模2^64），在插入、删除、旋转中
+ * 维护。求和与树的形状无关，关键字（及值域）集合相同的两棵树，不论插入
+ * 顺序如何，根的散列都相同，比较两个副本是否一致只需O(1)。TREE_HASH
+ * 应该是分布均匀的散列，有值域时应把关键字和值域混合后再散列，不能
+ * 分别散列后相加，否则两个关键字互换值域后和不变。
+ *
+ * 生成的接口（以 TREE_PREFIX 为 xx 为例）：
+ *	xx_node, pxx				节点类型及节点指针类型
+ *	pxx  xx_search( pxx proot, key )		查找，找不到返回NULL
+ *	int  xx_get( pxx proot, key, value * )	取值（仅有值域时）
+ *	int  xx_insert( pxx *proot, key [, value] )	插入，已存在时更新值域并返回0
+ *	int  xx_delete( pxx *proot, key )		删除
+ *	int  xx_destroy( pxx *proot )		销毁
+ *	unsigned long long xx_hash( pxx proot )	整棵树的散列（定义了TREE_HASH时）
+ *	unsigned long long xx_hash_range( pxx proot, lo *, hi * )
+ *						区间(lo, hi)内的散列，NULL表示无界
+ *	long xx_diff( pxx a, pxx b, report, arg )	报告两棵树的差异
+ *
+ * 例：
+ *	#define TREE_PREFIX strmap
+ *	#define TREE_KEY_TYPE const char *
+ *	#define TREE_VALUE_TYPE int
+ *	#define TREE_KEY_LESS(a, b) (strcmp((a), (b)) < 0)
+ *	#include "treetmpl.h"
+ */
+#include <stdio.h>
+#include <stdlib.h>
+
+#ifndef TREE_BST
+#define TREE_BST 1
+#define TREE_AVL 2
+#define TREE_RBT 3
+
+#define TREE_CAT_(a, b) a##_##b
+#define TREE_CAT(a, b) TREE_CAT_(a, b)
+#define TREE_CAT2_(a, b) a##b
+#define TREE_CAT2(a, b) TREE_CAT2_(a, b)
+#endif
+
+#ifndef TREE_PREFIX
+#error "TREE_PREFIX must be defined before including treetmpl.h"
+#endif
+#ifndef TREE_KEY_TYPE
+#error "TREE_KEY_TYPE must be defined before including treetmpl.h"
+#endif
+#ifndef TREE_KEY_LESS
+#define TREE_KEY_LESS(a, b) ((a) < (b))
+#endif
+#ifndef TREE_ENGINE
+#define TREE_ENGINE TREE_RBT
+#endif
+#ifndef TREE_ALLOC
+#define TREE_ALLOC(size) malloc(size)
+#endif
+#ifndef TREE_FREE
+#define TREE_FREE(p) free(p)
+#endif
+
+#define TREE_FN(name) TREE_CAT(TREE_PREFIX, name)
+#define TREE_NODE TREE_CAT(TREE_PREFIX, node)
+#define TREE_PTR TREE_CAT2(p, TREE_PREFIX)
+
+#ifdef TREE_VALUE_TYPE
+#define TREE_VALUE_PARAM , TREE_VALUE_TYPE value
+#define TREE_VALUE_SET(n) ((n)->value = value)
+#else
+#define TREE_VALUE_PARAM
+#define TREE_VALUE_SET(n) ((void)0)
+#endif
+
+#ifdef TREE_HASH
+#if TREE_ENGINE == TREE_BST
+#error "TREE_HASH needs TREE_AVL or TREE_RBT"
+#endif
+#define TREE_SUBHASH(n) ( (n) ? (n)->hash : 0ULL )
+#define TREE_UPDATE(n) TREE_FN(pull)( n )
+#else
+#define TREE_UPDATE(n) ((void)0)
+#endif
+
+typedef struct TREE_CAT2(_, TREE_NODE) {
+	TREE_KEY_TYPE key;
+#ifdef TREE_VALUE_TYPE
+	TREE_VALUE_TYPE value;
+#endif
+	struct TREE_CAT2(_, TREE_NODE) *lc, *rc;/* left and right child pointer */
+#if TREE_ENGINE == TREE_AVL
+	int bf;
+#elif TREE_ENGINE == TREE_RBT
+	struct TREE_CAT2(_, TREE_NODE) *p;/* parent pointer */
+	int rb;
+#endif
+#ifdef TREE_HASH
+	unsigned long long hash;	/* 子树中各节点TREE_HASH之和 */
+#endif
+}TREE_NODE, *TREE_PTR;
+
+#ifdef TREE_HASH
+/**
+ * @brief xx_pull - recompute the subtree hash of node n from it's children.
+ */
+static inline void
+TREE_FN(pull)( TREE_PTR n )
+{
+	n->hash = (unsigned long long)TREE_HASH( n ) + TREE_SUBHASH( n->lc ) + TREE_SUBHASH( n->rc );
+}
+#endif
+
+/**
+ * @brief xx_search - searching key in the tree.
+ * @param proot pointer to the root of tree.
+ * @param key the key to search.
+ * @return pointer to the node if found,
+ *	   NULL pointer if key not found.
+ */
+static inline TREE_PTR
+TREE_FN(search)( TREE_PTR proot, TREE_KEY_TYPE key )
+{
+	for ( ; proot; ) {
+		if ( TREE_KEY_LESS( key, proot->key ) )
+			proot = proot->lc;
+		else if ( TREE_KEY_LESS( proot->key, key ) )
+			proot = proot->rc;
+		else
+			break;
+	}
+
+	return proot;
+}
+
+#ifdef TREE_VALUE_TYPE
+/**
+ * @brief xx_get - get the value bound to key.
+ * @param proot pointer to the root of tree.
+ * @param key the key to search.
+ * @param value pointer to store the value found, may be NULL.
+ * @return 1 for found,
+ *	   0 for not found.
+ */
+static inline int
+TREE_FN(get)( TREE_PTR proot, TREE_KEY_TYPE key, TREE_VALUE_TYPE *value )
+{
+	TREE_PTR p = TREE_FN(search)( proot, key );
+
+	if ( !p )
+		return 0;
+	if ( value )
+		*value = p->value;
+
+	return 1;
+}
+#endif
+
+/**
+ * @brief xx_new_node - allocate and initialize a node.
+ * @return pointer to the new node, NULL for no memory.
+ */
+static inline TREE_PTR
+TREE_FN(new_node)( TREE_KEY_TYPE key TREE_VALUE_PARAM )
+{
+	TREE_PTR pe = ( TREE_PTR )TREE_ALLOC( sizeof( TREE_NODE ) );
+
+	if ( !pe ) {
+		printf("No Memory!!\n");
+		return NULL;
+	}
+	pe->key = key;
+	TREE_VALUE_SET( pe );
+	pe->lc = NULL;
+	pe->rc = NULL;
+#if TREE_ENGINE == TREE_AVL
+	pe->bf = 0;
+#elif TREE_ENGINE == TREE_RBT
+	pe->p = NULL;
+	pe->rb = 0;	/* RED */
+#endif
+	TREE_UPDATE( pe );
+
+	return pe;
+}
+
+/**
+ * @brief xx_destroy - destroy the tree, free it's space.
+ * @param proot pointer to the pointer to the root of tree.
+ * @return 0 for success.
+ */
+static inline int
+TREE_FN(destroy)( TREE_PTR *proot )
+{
+	if ( *proot ) {
+		TREE_FN(destroy)( &(*proot)->lc );
+		TREE_FN(destroy)( &(*proot)->rc );
+		TREE_FREE( *proot );
+		(*proot) = NULL;
+	}
+
+	return 0;
+}
+
+#if TREE_ENGINE == TREE_BST
+
+/**
+ * @brief xx_insert - insert a key into binary search tree.
+ * @return 1 for new node inserted,
+ *	   0 for key already exists (value is updated) or failure.
+ */
+static inline int
+TREE_FN(insert)( TREE_PTR *proot, TREE_KEY_TYPE key TREE_VALUE_PARAM )
+{
+	TREE_PTR *pp = proot;
+
+	for ( ; *pp; ) {
+		if ( TREE_KEY_LESS( key, (*pp)->key ) ) {
+			pp = &(*pp)->lc;
+		} else if ( TREE_KEY_LESS( (*pp)->key, key ) ) {
+			pp = &(*pp)->rc;
+		} else {
+			TREE_VALUE_SET( *pp );
+			return 0;
+		}
+	}
+	(*pp) = TREE_FN(new_node)( key
+#ifdef TREE_VALUE_TYPE
+				   , value
+#endif
+				   );
+
+	return (*pp) ? 1 : 0;
+}
+
+/**
+ * @brief xx_delete - delete a key from binary search tree.
+ * @return 1 for succeed,
+ *	   0 for failure.
+ *
+ * 左右子树均存在时用直接前驱替换被删节点。
+ */
+static inline int
+TREE_FN(delete)( TREE_PTR *proot, TREE_KEY_TYPE key )
+{
+	TREE_PTR *pp = proot;
+	TREE_PTR *ps = NULL;
+	TREE_PTR q = NULL;
+
+	for ( ; *pp; ) {
+		if ( TREE_KEY_LESS( key, (*pp)->key ) )
+			pp = &(*pp)->lc;
+		else if ( TREE_KEY_LESS( (*pp)->key, key ) )
+			pp = &(*pp)->rc;
+		else
+			break;
+	}
+	if ( !(*pp) )
+		return 0;
+
+	q = *pp;
+	if ( !q->rc ) {
+		(*pp) = q->lc;
+	} else if ( !q->lc ) {
+		(*pp) = q->rc;
+	} else {
+		ps = &q->lc;
+		for ( ; (*ps)->rc; )
+			ps = &(*ps)->rc;
+		q->key = (*ps)->key;
+#ifdef TREE_VALUE_TYPE
+		q->value = (*ps)->value;
+#endif
+		q = *ps;
+		(*ps) = q->lc;
+	}
+	TREE_FREE( q );
+
+	return 1;
+}
+
+#elif TREE_ENGINE == TREE_AVL
+
+/**
+ * @brief xx_r_rotate / xx_l_rotate - rotate the AVL subtree.
+ * @param p pointer to the pointer to the root of subtree.
+ */
+static inline void
+TREE_FN(r_rotate)( TREE_PTR *p )
+{
+	TREE_PTR plc = (*p)->lc;
+
+	(*p)->lc = plc->rc;
+	plc->rc = (*p);
+	(*p) = plc;
+	TREE_UPDATE( plc->rc );
+	TREE_UPDATE( plc );
+}
+
+static inline void
+TREE_FN(l_rotate)( TREE_PTR *p )
+{
+	TREE_PTR prc = (*p)->rc;
+
+	(*p)->rc = prc->lc;
+	prc->lc = (*p);
+	(*p) = prc;
+	TREE_UPDATE( prc->lc );
+	TREE_UPDATE( prc );
+}
+
+/**
+ * @brief xx_left_balance - handle left subtree to keep balance (LL and LR).
+ * @param p pointer to the pointer to the root of subtree.
+ */
+static inline void
+TREE_FN(left_balance)( TREE_PTR *p )
+{
+	TREE_PTR plc = (*p)->lc;
+	TREE_PTR plcrc = NULL;
+
+	switch ( plc->bf ) {
+		case 1:(*p)->bf = 0;
+			plc->bf = 0;
+			TREE_FN(r_rotate)( p );
+			break;
+		case 0:(*p)->bf = 1;
+			plc->bf = -1;
+			TREE_FN(r_rotate)( p );
+			break;
+		case -1:plcrc = plc->rc;
+			switch ( plcrc->bf ) {
+				case 1:(*p)->bf = -1;plc->bf = 0;break;
+				case 0:(*p)->bf = 0;plc->bf = 0;break;
+				case -1:(*p)->bf = 0;plc->bf = 1;break;
+			}
+			plcrc->bf = 0;
+			TREE_FN(l_rotate)( &(*p)->lc );
+			TREE_FN(r_rotate)( p );
+			break;
+	}
+}
+
+/**
+ * @brief xx_right_balance - handle right subtree to keep balance (RR and RL).
+ * @param p pointer to the pointer to the root of subtree.
+ */
+static inline void
+TREE_FN(right_balance)( TREE_PTR *p )
+{
+	TREE_PTR prc = (*p)->rc;
+	TREE_PTR prclc = NULL;
+
+	switch ( prc->bf ) {
+		case -1:(*p)->bf = 0;
+			prc->bf = 0;
+			TREE_FN(l_rotate)( p );
+			break;
+		case 0:(*p)->bf = -1;
+			prc->bf = 1;
+			TREE_FN(l_rotate)( p );
+			break;
+		case 1:prclc = prc->lc;
+			switch ( prclc->bf ) {
+				case -1:(*p)->bf = 1;prc->bf = 0;break;
+				case 0:(*p)->bf = 0;prc->bf = 0;break;
+				case 1:(*p)->bf = 0;prc->bf = -1;break;
+			}
+			prclc->bf = 0;
+			TREE_FN(r_rotate)( &(*p)->rc );
+			TREE_FN(l_rotate)( p );
+			break;
+	}
+}
+
+/**
+ * @brief xx_insert_avl - recursive AVL insertion.
+ * @param tf flag to record whether tree is growing taller.
+ * @return 1 for new node inserted,
+ *	   0 for key already exists (value is updated) or failure.
+ */
+static inline int
+TREE_FN(insert_avl)( TREE_PTR *proot, TREE_KEY_TYPE key TREE_VALUE_PARAM, int *tf )
+{
+	if ( !(*proot) ) {
+		(*proot) = TREE_FN(new_node)( key
+#ifdef TREE_VALUE_TYPE
+					      , value
+#endif
+					      );
+		*tf = ( NULL != *proot );
+		return *tf;
+	}
+	if ( TREE_KEY_LESS( key, (*proot)->key ) ) {
+		if ( !TREE_FN(insert_avl)( &(*proot)->lc, key
+#ifdef TREE_VALUE_TYPE
+					   , value
+#endif
+					   , tf ) ) {
+			TREE_UPDATE( *proot );	/* 值域可能已被更新 */
+			return 0;
+		}
+		if ( *tf ) {
+			switch ( (*proot)->bf ) {
+				case 1:TREE_FN(left_balance)( proot );
+					*tf = 0;
+					break;
+				case 0:(*proot)->bf = 1;
+					break;
+				case -1:(*proot)->bf = 0;
+					*tf = 0;
+					break;
+			}
+		}
+	} else if ( TREE_KEY_LESS( (*proot)->key, key ) ) {
+		if ( !TREE_FN(insert_avl)( &(*proot)->rc, key
+#ifdef TREE_VALUE_TYPE
+					   , value
+#endif
+					   , tf ) ) {
+			TREE_UPDATE( *proot );	/* 值域可能已被更新 */
+			return 0;
+		}
+		if ( *tf ) {
+			switch ( (*proot)->bf ) {
+				case 1:(*proot)->bf = 0;
+					*tf = 0;
+					break;
+				case 0:(*proot)->bf = -1;
+					break;
+				case -1:TREE_FN(right_balance)( proot );
+					*tf = 0;
+					break;
+			}
+		}
+	} else {
+		TREE_VALUE_SET( *proot );
+		TREE_UPDATE( *proot );
+		*tf = 0;
+		return 0;
+	}
+	TREE_UPDATE( *proot );
+
+	return 1;
+}
+
+static inline int
+TREE_FN(insert)( TREE_PTR *proot, TREE_KEY_TYPE key TREE_VALUE_PARAM )
+{
+	int tf = 0;
+
+	return TREE_FN(insert_avl)( proot, key
+#ifdef TREE_VALUE_TYPE
+				    , value
+#endif
+				    , &tf );
+}
+
+/**
+ * @brief xx_left_shorter / xx_right_shorter - rebalance after a subtree shrank.
+ * @param sf the shorter flag, updated for the parent.
+ */
+static inline void
+TREE_FN(left_shorter)( TREE_PTR *proot, int *sf )
+{
+	switch ( (*proot)->bf ) {
+		case 1:(*proot)->bf = 0;
+			break;
+		case 0:(*proot)->bf = -1;
+			*sf = 0;
+			break;
+		case -1:*sf = ( 0 != (*proot)->rc->bf );
+			TREE_FN(right_balance)( proot );
+			break;
+	}
+}
+
+static inline void
+TREE_FN(right_shorter)( TREE_PTR *proot, int *sf )
+{
+	switch ( (*proot)->bf ) {
+		case 1:*sf = ( 0 != (*proot)->lc->bf );
+			TREE_FN(left_balance)( proot );
+			break;
+		case 0:(*proot)->bf = 1;
+			*sf = 0;
+			break;
+		case -1:(*proot)->bf = 0;
+			break;
+	}
+}
+
+/**
+ * @brief xx_delete_avl - recursive AVL deletion.
+ * @param sf the shorter flag to record the tree's height changing.
+ * @return 1 for succeed,
+ *	   0 for failure.
+ *
+ * 左右子树均存在时，按平衡因子选择前驱或后继，交换内容后在子树中删除。
+ */
+static inline int
+TREE_FN(delete_avl)( TREE_PTR *proot, TREE_KEY_TYPE key, int *sf )
+{
+	TREE_PTR pfind = NULL;
+	TREE_NODE tmp;
+
+	if ( !(*proot) )
+		return 0;
+	if ( TREE_KEY_LESS( key, (*proot)->key ) ) {
+		if ( !TREE_FN(delete_avl)( &(*proot)->lc, key, sf ) )
+			return 0;
+		if ( *sf )
+			TREE_FN(left_shorter)( proot, sf );
+	} else if ( TREE_KEY_LESS( (*proot)->key, key ) ) {
+		if ( !TREE_FN(delete_avl)( &(*proot)->rc, key, sf ) )
+			return 0;
+		if ( *sf )
+			TREE_FN(right_shorter)( proot, sf );
+	} else if ( !(*proot)->lc || !(*proot)->rc ) {
+		pfind = *proot;
+		*proot = (*proot)->lc ? (*proot)->lc : (*proot)->rc;
+		TREE_FREE( pfind );
+		*sf = 1;
+	} else if ( -1 == (*proot)->bf ) {
+		for ( pfind = (*proot)->rc; pfind->lc; )
+			pfind = pfind->lc;
+		tmp = *pfind;
+		pfind->key = (*proot)->key;
+		(*proot)->key = tmp.key;
+#ifdef TREE_VALUE_TYPE
+		(*proot)->value = tmp.value;
+#endif
+		TREE_FN(delete_avl)( &(*proot)->rc, key, sf );
+		if ( *sf )
+			TREE_FN(right_shorter)( proot, sf );
+	} else {
+		for ( pfind = (*proot)->lc; pfind->rc; )
+			pfind = pfind->rc;
+		tmp = *pfind;
+		pfind->key = (*proot)->key;
+		(*proot)->key = tmp.key;
+#ifdef TREE_VALUE_TYPE
+		(*proot)->value = tmp.value;
+#endif
+		TREE_FN(delete_avl)( &(*proot)->lc, key, sf );
+		if ( *sf )
+			TREE_FN(left_shorter)( proot, sf );
+	}
+	if ( *proot )
+		TREE_UPDATE( *proot );
+
+	return 1;
+}
+
+/**
+ * @brief xx_delete - delete a key from AVL tree.
+ * @return 1 for succeed,
+ *	   0 for failure.
+ *
+ * 交换内容时被删节点的关键字会暂时位于前驱/后继处，此处只需保证
+ * 递归时沿原路径找到它即可：前驱交换后它是左子树的最大值，后继交换
+ * 后它是右子树的最小值，比较结果不受影响。
+ */
+static inline int
+TREE_FN(delete)( TREE_PTR *proot, TREE_KEY_TYPE key )
+{
+	int sf = 0;
+
+	return TREE_FN(delete_avl)( proot, key, &sf );
+}
+
+#elif TREE_ENGINE == TREE_RBT
+
+#define TREE_IS_RED(n) ( (n) && 0 == (n)->rb )
+#define TREE_IS_BLACK(n) ( !(n) || 1 == (n)->rb )
+
+#ifdef TREE_HASH
+/**
+ * @brief xx_pull_path - recompute the subtree hash from pn up to the root.
+ */
+static inline void
+TREE_FN(pull_path)( TREE_PTR pn )
+{
+	for ( ; pn; pn = pn->p )
+		TREE_FN(pull)( pn );
+}
+#define TREE_UPDATE_PATH(n) TREE_FN(pull_path)( n )
+#else
+#define TREE_UPDATE_PATH(n) ((void)0)
+#endif
+
+/**
+ * @brief xx_left_rotate / xx_right_rotate - rotate the red black tree.
+ * @param proot pointer to the pointer to the root of red black tree.
+ * @param pn pointer to the root of red black subtree.
+ */
+static inline void
+TREE_FN(left_rotate)( TREE_PTR *proot, TREE_PTR pn )
+{
+	TREE_PTR prc = pn->rc;
+
+	pn->rc = prc->lc;
+	if ( prc->lc )
+		prc->lc->p = pn;
+	prc->p = pn->p;
+	if ( !pn->p )
+		(*proot) = prc;
+	else if ( pn == pn->p->lc )
+		pn->p->lc = prc;
+	else
+		pn->p->rc = prc;
+	prc->lc = pn;
+	pn->p = prc;
+	TREE_UPDATE( pn );
+	TREE_UPDATE( prc );
+}
+
+static inline void
+TREE_FN(right_rotate)( TREE_PTR *proot, TREE_PTR pn )
+{
+	TREE_PTR plc = pn->lc;
+
+	pn->lc = plc->rc;
+	if ( plc->rc )
+		plc->rc->p = pn;
+	plc->p = pn->p;
+	if ( !pn->p )
+		(*proot) = plc;
+	else if ( pn == pn->p->rc )
+		pn->p->rc = plc;
+	else
+		pn->p->lc = plc;
+	plc->rc = pn;
+	pn->p = plc;
+	TREE_UPDATE( pn );
+	TREE_UPDATE( plc );
+}
+
+/**
+ * @brief xx_insert - insert a key into red black tree.
+ * @return 1 for new node inserted,
+ *	   0 for key already exists (value is updated) or failure.
+ *
+ * 插入修复与rbt_insert_fixup相同，只是没有调试输出。
+ */
+static inline int
+TREE_FN(insert)( TREE_PTR *proot, TREE_KEY_TYPE key TREE_VALUE_PARAM )
+{
+	TREE_PTR parent = NULL;
+	TREE_PTR *pp = proot;
+	TREE_PTR pe = NULL;
+	TREE_PTR pu = NULL;
+	TREE_PTR pg = NULL;
+
+	for ( ; *pp; ) {
+		parent = *pp;
+		if ( TREE_KEY_LESS( key, parent->key ) ) {
+			pp = &parent->lc;
+		} else if ( TREE_KEY_LESS( parent->key, key ) ) {
+			pp = &parent->rc;
+		} else {
+			TREE_VALUE_SET( parent );
+			TREE_UPDATE_PATH( parent );
+			return 0;
+		}
+	}
+	pe = TREE_FN(new_node)( key
+#ifdef TREE_VALUE_TYPE
+				, value
+#endif
+				);
+	if ( !pe )
+		return 0;
+	pe->p = parent;
+	(*pp) = pe;
+	TREE_UPDATE_PATH( parent );
+
+	for ( ; TREE_IS_RED( pe->p ); ) {
+		pg = pe->p->p;	/* 双亲为红色，必然不是根，祖父节点存在 */
+		if ( pe->p == pg->lc ) {
+			pu = pg->rc;
+			if ( TREE_IS_RED( pu ) ) {
+				pe->p->rb = 1;
+				pu->rb = 1;
+				pg->rb = 0;
+				pe = pg;
+				continue;
+			}
+			if ( pe == pe->p->rc ) {
+				pe = pe->p;
+				TREE_FN(left_rotate)( proot, pe );
+			}
+			pe->p->rb = 1;
+			pg->rb = 0;
+			TREE_FN(right_rotate)( proot, pg );
+		} else {
+			pu = pg->lc;
+			if ( TREE_IS_RED( pu ) ) {
+				pe->p->rb = 1;
+				pu->rb = 1;
+				pg->rb = 0;
+				pe = pg;
+				continue;
+			}
+			if ( pe == pe->p->lc ) {
+				pe = pe->p;
+				TREE_FN(right_rotate)( proot, pe );
+			}
+			pe->p->rb = 1;
+			pg->rb = 0;
+			TREE_FN(left_rotate)( proot, pg );
+		}
+	}
+	(*proot)->rb = 1;
+
+	return 1;
+}
+
+/**
+ * @brief xx_transplant - link node pc to pn's parent in place of pn.
+ */
+static inline void
+TREE_FN(transplant)( TREE_PTR *proot, TREE_PTR pn, TREE_PTR pc )
+{
+	if ( !pn->p )
+		*proot = pc;
+	else if ( pn == pn->p->lc )
+		pn->p->lc = pc;
+	else
+		pn->p->rc = pc;
+	if ( pc )
+		pc->p = pn->p;
+}
+
+/**
+ * @brief xx_delete - delete a key from red black tree.
+ * @return 1 for succeed,
+ *	   0 for failure.
+ *
+ * 删除修复与rbt_delete_fixup相同，但单独记录替代节点的双亲pcp，
+ * 不需要临时分配哨兵节点。
+ */
+static inline int
+TREE_FN(delete)( TREE_PTR *proot, TREE_KEY_TYPE key )
+{
+	TREE_PTR pn = TREE_FN(search)( *proot, key );
+	TREE_PTR ps = NULL;
+	TREE_PTR pc = NULL;
+	TREE_PTR pcp = NULL;
+	TREE_PTR pw = NULL;
+	int ps_rb = 0;
+
+	if ( !pn )
+		return 0;
+	ps_rb = pn->rb;
+	if ( !pn->lc ) {
+		pc = pn->rc;
+		pcp = pn->p;
+		TREE_FN(transplant)( proot, pn, pn->rc );
+	} else if ( !pn->rc ) {
+		pc = pn->lc;
+		pcp = pn->p;
+		TREE_FN(transplant)( proot, pn, pn->lc );
+	} else {
+		for ( ps = pn->rc; ps->lc; )
+			ps = ps->lc;
+		ps_rb = ps->rb;
+		pc = ps->rc;
+		if ( ps->p == pn ) {
+			pcp = ps;
+		} else {
+			pcp = ps->p;
+			TREE_FN(transplant)( proot, ps, ps->rc );
+			ps->rc = pn->rc;
+			ps->rc->p = ps;
+		}
+		TREE_FN(transplant)( proot, pn, ps );
+		ps->lc = pn->lc;
+		ps->lc->p = ps;
+		ps->rb = pn->rb;
+	}
+	TREE_FREE( pn );
+	TREE_UPDATE_PATH( pcp );	/* pcp及其祖先的子树发生了变化 */
+
+	if ( 0 == ps_rb )
+		return 1;
+	for ( ; pc != *proot && TREE_IS_BLACK( pc ); ) {
+		if ( pc == pcp->lc ) {
+			pw = pcp->rc;
+			if ( TREE_IS_RED( pw ) ) {
+				pw->rb = 1;
+				pcp->rb = 0;
+				TREE_FN(left_rotate)( proot, pcp );
+				pw = pcp->rc;
+			}
+			if ( TREE_IS_BLACK( pw->lc ) && TREE_IS_BLACK( pw->rc ) ) {
+				pw->rb = 0;
+				pc = pcp;
+				pcp = pc->p;
+			} else {
+				if ( TREE_IS_BLACK( pw->rc ) ) {
+					pw->lc->rb = 1;
+					pw->rb = 0;
+					TREE_FN(right_rotate)( proot, pw );
+					pw = pcp->rc;
+				}
+				pw->rb = pcp->rb;
+				pcp->rb = 1;
+				pw->rc->rb = 1;
+				TREE_FN(left_rotate)( proot, pcp );
+				pc = *proot;
+			}
+		} else {
+			pw = pcp->lc;
+			if ( TREE_IS_RED( pw ) ) {
+				pw->rb = 1;
+				pcp->rb = 0;
+				TREE_FN(right_rotate)( proot, pcp );
+				pw = pcp->lc;
+			}
+			if ( TREE_IS_BLACK( pw->lc ) && TREE_IS_BLACK( pw->rc ) ) {
+				pw->rb = 0;
+				pc = pcp;
+				pcp = pc->p;
+			} else {
+				if ( TREE_IS_BLACK( pw->lc ) ) {
+					pw->rc->rb = 1;
+					pw->rb = 0;
+					TREE_FN(left_rotate)( proot, pw );
+					pw = pcp->lc;
+				}
+				pw->rb = pcp->rb;
+				pcp->rb = 1;
+				pw->lc->rb = 1;
+				TREE_FN(right_rotate)( proot, pcp );
+				pc = *proot;
+			}
+		}
+	}
+	if ( pc )
+		pc->rb = 1;
+
+	return 1;
+}
+
+#undef TREE_IS_RED
+#undef TREE_IS_BLACK
+#undef TREE_UPDATE_PATH
+
+#else
+#error "TREE_ENGINE must be TREE_BST, TREE_AVL or TREE_RBT"
+#endif
+
+#ifdef TREE_HASH
+/**
+ * @brief xx_hash - get the hash of the whole tree.
+ * @param proot pointer to the root of tree.
+ * @return sum of TREE_HASH of all nodes, 0 for empty tree.
+ */
+static inline unsigned long long
+TREE_FN(hash)( TREE_PTR proot )
+{
+	return TREE_SUBHASH( proot );
+}
+
+/**
+ * @brief xx_hash_range - get the hash of keys in open interval (lo, hi).
+ * @param proot pointer to the root of tree.
+ * @param lo pointer to the lower bound, NULL for no bound.
+ * @param hi pointer to the upper bound, NULL for no bound.
+ * @return sum of TREE_HASH of nodes in the interval.
+ *
+ * 先找到第一个落在区间内的节点（分叉点），区间内的节点都在它的子树中；
+ * 再沿左边界和右边界各走一条路径，路径上落在区间内的节点加上自身和
+ * 靠内一侧的整棵子树。节点自身的散列为子树散列减去两个孩子的子树散列。
+ * 时间为O(log n)。
+ */
+static inline unsigned long long
+TREE_FN(hash_range)( TREE_PTR proot, const TREE_KEY_TYPE *lo, const TREE_KEY_TYPE *hi )
+{
+	TREE_PTR q = NULL;
+	unsigned long long h = 0;
+
+	for ( ; proot; ) {
+		if ( lo && !TREE_KEY_LESS( *lo, proot->key ) )
+			proot = proot->rc;
+		else if ( hi && !TREE_KEY_LESS( proot->key, *hi ) )
+			proot = proot->lc;
+		else
+			break;
+	}
+	if ( !proot )
+		return 0;
+	h = proot->hash - TREE_SUBHASH( proot->lc ) - TREE_SUBHASH( proot->rc );
+
+	if ( !lo ) {
+		h += TREE_SUBHASH( proot->lc );
+	} else {
+		for ( q = proot->lc; q; ) {
+			if ( TREE_KEY_LESS( *lo, q->key ) ) {
+				h += q->hash - TREE_SUBHASH( q->lc );
+				q = q->lc;
+			} else {
+				q = q->rc;
+			}
+		}
+	}
+	if ( !hi ) {
+		h += TREE_SUBHASH( proot->rc );
+	} else {
+		for ( q = proot->rc; q; ) {
+			if ( TREE_KEY_LESS( q->key, *hi ) ) {
+				h += q->hash - TREE_SUBHASH( q->rc );
+				q = q->rc;
+			} else {
+				q = q->lc;
+			}
+		}
+	}
+
+	return h;
+}
+
+/**
+ * @brief xx_diff_rest - report nodes of b in (lo, hi) as missing from a.
+ */
+static inline long
+TREE_FN(diff_rest)( TREE_PTR b, const TREE_KEY_TYPE *lo, const TREE_KEY_TYPE *hi,
+		    void (*report)( TREE_PTR pa, TREE_PTR pb, void *arg ), void *arg )
+{
+	long count = 0;
+
+	if ( !b )
+		return 0;
+	if ( !lo || TREE_KEY_LESS( *lo, b->key ) )
+		count += TREE_FN(diff_rest)( b->lc, lo, hi, report, arg );
+	if ( ( !lo || TREE_KEY_LESS( *lo, b->key ) ) && ( !hi || TREE_KEY_LESS( b->key, *hi ) ) ) {
+		report( NULL, b, arg );
+		count++;
+	}
+	if ( !hi || TREE_KEY_LESS( b->key, *hi ) )
+		count += TREE_FN(diff_rest)( b->rc, lo, hi, report, arg );
+
+	return count;
+}
+
+/**
+ * @brief xx_diff_sub - compare subtree pa of a with keys of b in (lo, hi).
+ *
+ * pa的子树恰好是a中落在(lo, hi)内的全部节点，与b在同一区间的散列相同
+ * 时整棵子树跳过，否则检查pa自身，再分别比较左右子树。
+ */
+static inline long
+TREE_FN(diff_sub)( TREE_PTR pa, TREE_PTR b, const TREE_KEY_TYPE *lo, const TREE_KEY_TYPE *hi,
+		   void (*report)( TREE_PTR pa, TREE_PTR pb, void *arg ), void *arg )
+{
+	TREE_PTR pb = NULL;
+	long count = 0;
+
+	if ( !pa )
+		return TREE_FN(diff_rest)( b, lo, hi, report, arg );
+	if ( pa->hash == TREE_FN(hash_range)( b, lo, hi ) )
+		return 0;
+	pb = TREE_FN(search)( b, pa->key );
+	if ( !pb || (unsigned long long)TREE_HASH( pa ) != (unsigned long long)TREE_HASH( pb ) ) {
+		report( pa, pb, arg );
+		count++;
+	}
+	count += TREE_FN(diff_sub)( pa->lc, b, lo, &pa->key, report, arg );
+	count += TREE_FN(diff_sub)( pa->rc, b, &pa->key, hi, report, arg );
+
+	return count;
+}
+
+/**
+ * @brief xx_diff - report the differences between tree a and tree b.
+ * @param a pointer to the root of tree a.
+ * @param b pointer to the root of tree b.
+ * @param report called once for each difference:
+ *	   pb is NULL if the key is only in a, pa is NULL if the key is only
+ *	   in b, neither is NULL if the key is in both but TREE_HASH differs
+ *	   (e.g. different values).
+ * @param arg passed to report.
+ * @return count of differences.
+ *
+ * 两棵树的形状可以不同，沿a的结构向下，只进入散列与b中对应区间不同的
+ * 子树。d个差异时访问a中O(d log n)个节点，每个节点在b中求一次区间散列，
+ * 共O(d log^2 n)；散列相同（副本一致）时O(1)返回。
+ */
+static inline long
+TREE_FN(diff)( TREE_PTR a, TREE_PTR b, void (*report)( TREE_PTR pa, TREE_PTR pb, void *arg ), void *arg )
+{
+	if ( TREE_SUBHASH( a ) == TREE_SUBHASH( b ) )
+		return 0;
+
+	return TREE_FN(diff_sub)( a, b, NULL, NULL, report, arg );
+}
+#endif
+
+#undef TREE_FN
+#undef TREE_NODE
+#undef TREE_PTR
+#undef TREE_VALUE_PARAM
+#undef TREE_VALUE_SET
+#undef TREE_SUBHASH
+#undef TREE_UPDATE
+#undef TREE_PREFIX
+#undef TREE_KEY_TYPE
+#undef TREE_VALUE_TYPE
+#undef TREE_KEY_LESS
+#undef TREE_ENGINE
+#undef TREE_ALLOC
+#undef TREE_FREE
+#undef TREE_HASH
@@ -0,0 +1,527 @@
+/**
+ * @file vbbstree.c
+ * @brief realize persistent balance binary search tree's basic oprations.
+ * @author watertiger <darkwkt@gmail.com>
+ * @date 2026-10-19
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "vbbstree.h"
+
+#define INIT_SIZE 10
+
+#define VBBST_REF_GET(n) __atomic_load_n( &(n)->ref, __ATOMIC_ACQUIRE )
+#define VBBST_REF_INC(n) __atomic_add_fetch( &(n)->ref, 1, __ATOMIC_RELAXED )
+#define VBBST_REF_DEC(n) __atomic_sub_fetch( &(n)->ref, 1, __ATOMIC_ACQ_REL )
+
+/**
+ * @brief vbbst_search1 - searching key in one version of persistent tree.
+ * @param proot pointer to the root of the version.
+ * @param key the enum to search.
+ * @return pvbbst pointer to the node if found,
+ *	   NULL pointer if key not found.
+ */
+pvbbst
+vbbst_search1( pvbbst proot, int key )
+{
+	for ( ; proot && key != proot->data; )
+		proot = ( key < proot->data ) ? proot->lc : proot->rc;
+
+	return proot;
+}
+
+/**
+ * @brief vbbst_own - make the node pointed by *p only belong to current version.
+ * @param p pointer to the pointer to the node, the pointer must belong to current version.
+ * @return pointer to the node can be modified,
+ *	   NULL pointer if no memory.
+ *
+ * 节点被多个版本共享时复制一份，副本的孩子引用计数加1，原节点引用计数减1，
+ * 并把*p指向副本。
+ */
+static pvbbst
+vbbst_own( pvbbst *p )
+{
+	pvbbst pn = NULL;
+
+	if ( 1 == VBBST_REF_GET( *p ) )
+		return *p;
+	pn = ( pvbbst )malloc( sizeof(vbbst_node) );
+	if ( !pn ) {
+		printf("No Memory!!\n");
+		return NULL;
+	}
+	memcpy( pn, *p, sizeof(vbbst_node) );
+	pn->ref = 1;
+	if ( pn->lc )
+		VBBST_REF_INC( pn->lc );
+	if ( pn->rc )
+		VBBST_REF_INC( pn->rc );
+	vbbst_release( p );	/* 其他版本仍引用，不会被释放 */
+	(*p) = pn;
+
+	return pn;
+}
+
+/**
+ * @brief vbbst_r_rotate - rotate the subtree to the right.
+ * @param p pointer to the pointer to the root of subtree, must be owned.
+ * @return none.
+ */
+static void
+vbbst_r_rotate( pvbbst *p )
+{
+	pvbbst plc = vbbst_own( &(*p)->lc );
+
+	if ( !plc )
+		return;
+	(*p)->lc = plc->rc;
+	plc->rc = (*p);
+	(*p) = plc;
+
+	return;
+}
+
+/**
+ * @brief vbbst_l_rotate - rotate the subtree to the left.
+ * @param p pointer to the pointer to the root of subtree, must be owned.
+ * @return none.
+ */
+static void
+vbbst_l_rotate( pvbbst *p )
+{
+	pvbbst prc = vbbst_own( &(*p)->rc );
+
+	if ( !prc )
+		return;
+	(*p)->rc = prc->lc;
+	prc->lc = (*p);
+	(*p) = prc;
+
+	return;
+}
+
+/**
+ * @brief vbbst_left_balance - handle left subtree to keep balance.
+ * @param p pointer to the pointer to the root of subtree, must be owned.
+ * @return none.
+ *
+ * 与balancebstree.c中的left_balance相同，修改平衡因子之前先复制共享的节点。
+ */
+static void
+vbbst_left_balance( pvbbst *p )
+{
+	pvbbst plc = vbbst_own( &(*p)->lc );
+	pvbbst plcrc = NULL;
+
+	if ( !plc )
+		return;
+	switch( plc->bf ) {
+		case LH:(*p)->bf = EH;
+			plc->bf = EH;
+			vbbst_r_rotate( p );
+			break;
+		/* 删除节点才会出现EH的情况 */
+		case EH:(*p)->bf = LH;
+			plc->bf = RH;
+			vbbst_r_rotate( p );
+			break;
+		case RH:plcrc = vbbst_own( &plc->rc );
+			if ( !plcrc )
+				return;
+			switch ( plcrc->bf ) {
+				case LH:(*p)->bf = RH;plc->bf = EH;break;
+				case EH:(*p)->bf = EH;plc->bf = EH;break;
+				case RH:(*p)->bf = EH;plc->bf = LH;break;
+			}
+			plcrc->bf = EH;
+			vbbst_l_rotate( &(*p)->lc );
+			vbbst_r_rotate( p );
+			break;
+		default:printf("Error happenned.\n");
+	}
+
+	return;
+}
+
+/**
+ * @brief vbbst_right_balance - handle right subtree to keep balance.
+ * @param p pointer to the pointer to the root of subtree, must be owned.
+ * @return none.
+ */
+static void
+vbbst_right_balance( pvbbst *p )
+{
+	pvbbst prc = vbbst_own( &(*p)->rc );
+	pvbbst prclc = NULL;
+
+	if ( !prc )
+		return;
+	switch( prc->bf ) {
+		case RH:(*p)->bf = EH;
+			prc->bf = EH;
+			vbbst_l_rotate( p );
+			break;
+		/* 删除的时候才会出现EH的情况 */
+		case EH:(*p)->bf = RH;
+			prc->bf = LH;
+			vbbst_l_rotate( p );
+			break;
+		case LH:prclc = vbbst_own( &prc->lc );
+			if ( !prclc )
+				return;
+			switch ( prclc->bf ) {
+				case RH:(*p)->bf = LH;prc->bf = EH;break;
+				case EH:(*p)->bf = EH;prc->bf = EH;break;
+				case LH:(*p)->bf = EH;prc->bf = RH;break;
+			}
+			prclc->bf = EH;
+			vbbst_r_rotate( &(*p)->rc );
+			vbbst_l_rotate( p );
+			break;
+		default:printf("Error happenned.\n");
+	}
+
+	return;
+}
+
+/**
+ * @brief vbbst_insert_avl - insert an enum, copying shared nodes on the path.
+ * @param p pointer to the pointer to the root of subtree, the pointer must be owned.
+ * @param e the enum to insert, must not exist.
+ * @param tf flag to record whether tree is growing taller.
+ * @return 1 for succeed,
+ *	   0 for failure.
+ */
+static int
+vbbst_insert_avl( pvbbst *p, int e, int *tf )
+{
+	pvbbst pn = NULL;
+
+	if ( !(*p) ) {
+		pn = ( pvbbst )malloc( sizeof(vbbst_node) );
+		if ( !pn ) {
+			printf("No Memory!!\n");
+			return 0;
+		}
+		pn->data = e;
+		pn->bf = EH;
+		pn->ref = 1;
+		pn->lc = NULL;
+		pn->rc = NULL;
+		(*p) = pn;
+		*tf = 1;
+		return 1;
+	}
+	pn = vbbst_own( p );
+	if ( !pn )
+		return 0;
+	if ( e < pn->data ) {
+		if ( !vbbst_insert_avl( &pn->lc, e, tf ) )
+			return 0;
+		if ( *tf ) {
+			switch ( pn->bf ) {
+				case LH:vbbst_left_balance( p );
+					*tf = 0;
+					break;
+				case EH:pn->bf = LH;
+					*tf = 1;
+					break;
+				case RH:pn->bf = EH;
+					*tf = 0;
+					break;
+			}
+		}
+	} else {
+		if ( !vbbst_insert_avl( &pn->rc, e, tf ) )
+			return 0;
+		if ( *tf ) {
+			switch ( pn->bf ) {
+				case LH:pn->bf = EH;
+					*tf = 0;
+					break;
+				case EH:pn->bf = RH;
+					*tf = 1;
+					break;
+				case RH:vbbst_right_balance( p );
+					*tf = 0;
+					break;
+			}
+		}
+	}
+
+	return 1;
+}
+
+/**
+ * @brief vbbst_insert - insert an enum into current version.
+ * @param proot pointer to the pointer to the root of current version.
+ * @param e the enum to insert.
+ * @return 1 for succeed,
+ *	   0 for failure or already exists.
+ *
+ * 先查找，关键字已存在时不复制任何节点。
+ */
+int
+vbbst_insert( pvbbst *proot, int e )
+{
+	int tf = 0;
+
+	if ( vbbst_search1( *proot, e ) )
+		return 0;
+
+	return vbbst_insert_avl( proot, e, &tf );
+}
+
+/**
+ * @brief vbbst_delete_avl - delete an enum, copying shared nodes on the path.
+ * @param p pointer to the pointer to the root of subtree, the pointer must be owned.
+ * @param key the enum to delete, must exist.
+ * @param sf the shorter flag to record the tree's height changing.
+ * @return 1 for succeed,
+ *	   0 for failure.
+ *
+ * 左右子树均存在时，把前驱（或后继）的值复制到当前节点（已属于当前版本），
+ * 再到子树中删除前驱（或后继），不修改共享的节点。
+ */
+static int
+vbbst_delete_avl( pvbbst *p, int key, int *sf )
+{
+	pvbbst pn = vbbst_own( p );
+	pvbbst pfind = NULL;
+
+	if ( !pn )
+		return 0;
+	if ( key == pn->data ) {
+		if ( !pn->lc || !pn->rc ) { /* 叶子节点或仅有一棵子树 */
+			/* pn对孩子的引用转交给*p */
+			(*p) = pn->lc ? pn->lc : pn->rc;
+			free( pn );
+			*sf = 1;
+		} else if ( RH == pn->bf ) {
+			for ( pfind = pn->rc; pfind->lc; )
+				pfind = pfind->lc;
+			pn->data = pfind->data;
+			if ( !vbbst_delete_avl( &pn->rc, pn->data, sf ) )
+				return 0;
+			if ( *sf )
+				pn->bf = EH;
+		} else {
+			for ( pfind = pn->lc; pfind->rc; )
+				pfind = pfind->rc;
+			pn->data = pfind->data;
+			if ( !vbbst_delete_avl( &pn->lc, pn->data, sf ) )
+				return 0;
+			if ( *sf ) {
+				switch ( pn->bf ) {
+					case LH:pn->bf = EH;
+						*sf = 1;
+						break;
+					case EH:pn->bf = RH;
+						*sf = 0;
+						break;
+				}
+			}
+		}
+	} else if ( key < pn->data ) {
+		if ( !vbbst_delete_avl( &pn->lc, key, sf ) )
+			return 0;
+		if ( *sf ) {
+			switch ( pn->bf ) {
+				case LH:pn->bf = EH;
+					*sf = 1;
+					break;
+				case EH:pn->bf = RH;
+					*sf = 0;
+					break;
+				case RH:*sf = ( EH != pn->rc->bf );
+					vbbst_right_balance( p );
+					break;
+			}
+		}
+	} else {
+		if ( !vbbst_delete_avl( &pn->rc, key, sf ) )
+			return 0;
+		if ( *sf ) {
+			switch ( pn->bf ) {
+				case LH:*sf = ( EH != pn->lc->bf );
+					vbbst_left_balance( p );
+					break;
+				case EH:pn->bf = LH;
+					*sf = 0;
+					break;
+				case RH:pn->bf = EH;
+					*sf = 1;
+					break;
+			}
+		}
+	}
+
+	return 1;
+}
+
+/**
+ * @brief vbbst_delete - delete an enum from current version.
+ * @param proot pointer to the pointer to the root of current version.
+ * @param key the enum to delete.
+ * @return 1 for succeed,
+ *	   0 for failure.
+ */
+int
+vbbst_delete( pvbbst *proot, int key )
+{
+	int sf = 0;
+
+	if ( !vbbst_search1( *proot, key ) )
+		return 0;
+
+	return vbbst_delete_avl( proot, key, &sf );
+}
+
+/**
+ * @brief vbbst_snapshot - capture a version, O(1).
+ * @param proot pointer to the root of current version.
+ * @return pointer to the root of the snapshot, must be released by vbbst_release.
+ */
+pvbbst
+vbbst_snapshot( pvbbst proot )
+{
+	if ( proot )
+		VBBST_REF_INC( proot );
+
+	return proot;
+}
+
+/**
+ * @brief vbbst_release - release a version, free nodes no longer referenced.
+ * @param proot pointer to the pointer to the root of the version.
+ * @return 0 for success.
+ */
+int
+vbbst_release( pvbbst *proot )
+{
+	if ( *proot && 0 == VBBST_REF_DEC( *proot ) ) {
+		vbbst_release( &(*proot)->lc );
+		vbbst_release( &(*proot)->rc );
+		free( *proot );
+	}
+	(*proot) = NULL;
+
+	return 0;
+}
+
+/**
+ * @brief vbbst_show - show all node's information of one version.
+ * @param proot pointer to the node of the version.
+ * @param parent pointer to the parent node of node which pointer proot point to
+ * @return none.
+ */
+void
+vbbst_show( pvbbst proot, pvbbst parent )
+{
+	if ( proot ) {
+		printf("Current:%-4d(%+2d) ref:%d. ", proot->data, proot->bf, proot->ref);
+		if ( proot->lc )
+			printf("LC:%-4d", proot->lc->data);
+		else
+			printf("LC:$   ");
+		if ( proot->rc )
+			printf("RC:%-4d", proot->rc->data);
+		else
+			printf("RC:$   ");
+		if ( parent )
+			printf("P:%-4d\n", parent->data);
+		else
+			printf("P:$   \n");
+		vbbst_show( proot->lc, proot );
+		vbbst_show( proot->rc, proot );
+	}
+
+	return;
+}
+
+/**
+ * @brief vbbst_copy - copy the whole version, used to compare with snapshot.
+ */
+static pvbbst
+vbbst_copy( pvbbst proot )
+{
+	pvbbst pn = NULL;
+
+	if ( !proot )
+		return NULL;
+	pn = ( pvbbst )malloc( sizeof(vbbst_node) );
+	if ( !pn ) {
+		printf("No Memory!!\n");
+		return NULL;
+	}
+	pn->data = proot->data;
+	pn->bf = proot->bf;
+	pn->ref = 1;
+	pn->lc = vbbst_copy( proot->lc );
+	pn->rc = vbbst_copy( proot->rc );
+
+	return pn;
+}
+
+#define BENCH_KEYS	( 1 << 20 )
+#define BENCH_SNAPS	1000
+
+int
+main()
+{
+	int array[INIT_SIZE];
+	int i = 0;
+	pvbbst proot = NULL; /* 此处一定要显式置NULL，否则调用会出错，因为是根 */
+	pvbbst psnap = NULL;
+	pvbbst snaps[BENCH_SNAPS];
+	clock_t t0 = 0;
+	double tsnap = 0;
+	double tcopy = 0;
+
+	srand( (unsigned int)time(NULL) );
+	for ( i = 0; i < INIT_SIZE; i++ ) {
+		array[i] = rand() % 100;
+		printf("%-4d", array[i]);
+		vbbst_insert( &proot, array[i] );
+	}
+	printf("\n");
+	psnap = vbbst_snapshot( proot );
+	vbbst_delete( &proot, array[5] );
+	vbbst_insert( &proot, 101 );
+	printf("snapshot:\n");
+	vbbst_show( psnap, NULL );
+	printf("current:\n");
+	vbbst_show( proot, NULL );
+	printf("%d %s in snapshot, %s in current.\n", array[5],
+	       vbbst_search1( psnap, array[5] ) ? "found" : "not exists",
+	       vbbst_search1( proot, array[5] ) ? "found" : "not exists");
+	vbbst_release( &psnap );
+	vbbst_release( &proot );
+
+	/* 每次更新前取一个快照，与复制整棵树比较 */
+	for ( i = 0; i < BENCH_KEYS; i++ )
+		vbbst_insert( &proot, rand() );
+	t0 = clock();
+	for ( i = 0; i < BENCH_SNAPS; i++ ) {
+		snaps[i] = vbbst_snapshot( proot );
+		vbbst_insert( &proot, rand() );
+	}
+	tsnap = (double)( clock() - t0 ) / CLOCKS_PER_SEC;
+	for ( i = 0; i < BENCH_SNAPS; i++ )
+		vbbst_release( &snaps[i] );
+	t0 = clock();
+	for ( i = 0; i < 10; i++ ) {
+		psnap = vbbst_copy( proot );
+		vbbst_release( &psnap );
+	}
+	tcopy = (double)( clock() - t0 ) / CLOCKS_PER_SEC / 10;
+	printf("snapshot + update: %.3f us, full copy: %.3f us.\n",
+	       tsnap / BENCH_SNAPS * 1e6, tcopy * 1e6);
+	vbbst_release( &proot );
+
+	return 0;
+}
@@ -0,0 +1,42 @@
+/**
+ * @file vbbstree.h
+ * @brief describe persistent balance binary search tree's defination and basic oprations.
+ * @author watertiger <darkwkt@gmail.com>
+ * @date 2026-10-19
+ */
+#include <stdio.h>
+#include <stdlib.h>
+
+/**
+ * @brief define the persistent balanced binary search tree node and it's basic oprations
+ *
+ * 可持久化（多版本）的平衡二叉树：
+ *	每个版本由一个树根表示，不同版本之间共享未被修改的子树。
+ *	节点带有引用计数，等于指向它的双亲指针与外部树根的个数之和。
+ *	插入和删除从根向下修改时，若路径上的节点被多个版本共享（ref > 1），
+ *	先复制该节点（路径复制），只修改副本，原节点仍属于旧版本；
+ *	ref为1的节点只属于当前版本，直接原地修改。旋转涉及的路径外节点同样
+ *	先复制。因此每次更新只复制O(log n)个节点。
+ *	快照只是把树根的引用计数加1，时间和空间都为O(1)。
+ *	释放版本时引用计数减为0的节点才被释放，并继续释放其孩子。
+ *
+ * 快照需要由写者（或在与写者互斥的情况下）获取，之后可以交给其他线程
+ * 只读遍历，并在任意线程中释放；引用计数使用原子操作。
+ */
+#define LH +1
+#define EH  0
+#define RH -1
+
+typedef struct _versioned_bbst {
+	int data;
+	int bf;
+	int ref;	/* 引用计数 */
+	struct _versioned_bbst *lc, *rc;/* left and right child pointer */
+}vbbst_node, *pvbbst;
+
+pvbbst vbbst_search1( pvbbst proot, int key );
+int vbbst_insert( pvbbst *proot, int e );
+int vbbst_delete( pvbbst *proot, int key );
+pvbbst vbbst_snapshot( pvbbst proot );
+int vbbst_release( pvbbst *proot );
+void vbbst_show( pvbbst proot, pvbbst parent );